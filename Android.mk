@@ -6,6 +6,7 @@ LOCAL_SRC_FILES := \
     video_codec/VideoEncoderOpenH264.cpp \
     video_codec/VideoEncoderNetint.cpp \
 	common/log/MediaLog.cpp \
+    common/log/MediaLogAsync.cpp \
     common/log/MediaLogManager.cpp \
     common/prop/Property.cpp
 
@@ -14,6 +15,7 @@ LOCAL_C_INCLUDES := \
     system/core/liblog/include \
     $(LOCAL_PATH)/common/log \
     $(LOCAL_PATH)/common/prop \
+    $(LOCAL_PATH)/common/pool \
     $(LOCAL_PATH)/vendor/openh264 \
     $(LOCAL_PATH)/vendor/netint
 
@@ -0,0 +1,538 @@
+/*
+ * 功能说明: H.264/H.265参数集解析，从Annex-B码流的SPS（H.265另有VPS）中取得图像尺寸、裁剪区域、位深与帧率，
+ *           供解码器在打开会话前确定解码参数；只解析到所需字段为止，码流截断、语法不支持或参数超出支持范围时返回失败，
+ *           由调用方使用配置的参数
+ */
+#ifndef SPS_PARSER_H
+#define SPS_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "StartCodeScanner.h"
+
+namespace SpsParser {
+    constexpr uint32_t H264_NAL_TYPE_MASK = 0x1F;
+    constexpr uint32_t H264_NAL_SPS = 7;
+    constexpr uint32_t H265_NAL_TYPE_MASK = 0x3F;
+    constexpr uint32_t H265_NAL_VPS = 32;
+    constexpr uint32_t H265_NAL_SPS = 33;
+    constexpr uint32_t BIT_DEPTH_BASE = 8;
+    constexpr uint32_t H264_MB_SIZE = 16;
+    constexpr uint32_t EXTENDED_SAR = 255;
+    constexpr uint32_t UE_LEADING_ZEROS_MAX = 31;
+    constexpr uint32_t DIMENSION_MAX = 8192;    // 支持的最大宽高
+    constexpr uint32_t BIT_DEPTH_HIGH = 10;     // 支持的位深为8与10
+    constexpr uint32_t FRAME_RATE_MAX = 240;    // 码流帧率超出时视为未携带
+
+    // 码流参数，width/height为裁剪后的显示尺寸，codedWidth/codedHeight为编码尺寸，frameRate为0表示码流未携带
+    struct StreamInfo {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t codedWidth = 0;
+        uint32_t codedHeight = 0;
+        uint32_t bitDepth = BIT_DEPTH_BASE;
+        uint32_t frameRate = 0;
+    };
+
+    // RBSP比特读取，越界后读取结果为0并置位Overrun
+    class BitReader {
+    public:
+        BitReader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+        uint32_t ReadBit()
+        {
+            if (m_pos >= m_size * BITS_PER_BYTE) {
+                m_overrun = true;
+                return 0;
+            }
+            uint32_t bit = (m_data[m_pos / BITS_PER_BYTE] >> (BITS_PER_BYTE - 1 - m_pos % BITS_PER_BYTE)) & 1;
+            ++m_pos;
+            return bit;
+        }
+
+        uint32_t ReadBits(uint32_t count)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                value = (value << 1) | ReadBit();
+            }
+            return value;
+        }
+
+        void SkipBits(size_t count)
+        {
+            m_pos += count;
+            if (m_pos > m_size * BITS_PER_BYTE) {
+                m_overrun = true;
+            }
+        }
+
+        uint32_t ReadUe()
+        {
+            uint32_t zeros = 0;
+            while (ReadBit() == 0) {
+                if (m_overrun || ++zeros > UE_LEADING_ZEROS_MAX) {
+                    m_overrun = true;
+                    return 0;
+                }
+            }
+            return static_cast<uint32_t>((1ULL << zeros) - 1 + ReadBits(zeros));
+        }
+
+        int32_t ReadSe()
+        {
+            uint32_t codeNum = ReadUe();
+            return ((codeNum & 1) != 0) ? static_cast<int32_t>((codeNum + 1) / 2) :
+                -static_cast<int32_t>(codeNum / 2);
+        }
+
+        bool Overrun() const
+        {
+            return m_overrun;
+        }
+
+    private:
+        static constexpr size_t BITS_PER_BYTE = 8;
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_pos = 0;
+        bool m_overrun = false;
+    };
+
+    /**
+     * @功能描述: 去除NAL单元中的防竞争字节，得到RBSP
+     * @参数 [in] data: NAL单元数据，不含起始码
+     * @参数 [in] size: 数据大小
+     * @返回值: RBSP
+     */
+    inline std::vector<uint8_t> ToRbsp(const uint8_t *data, size_t size)
+    {
+        std::vector<uint8_t> rbsp;
+        rbsp.reserve(size);
+        uint32_t zeros = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if (zeros >= 2 && data[i] == 0x03) {    // 2: 0x000003中的0x03为防竞争字节
+                zeros = 0;
+                continue;
+            }
+            rbsp.push_back(data[i]);
+            zeros = (data[i] == 0) ? zeros + 1 : 0;
+        }
+        return rbsp;
+    }
+
+    // 裁剪后的显示尺寸，裁剪量超出编码尺寸时按编码尺寸
+    inline void ApplyCrop(StreamInfo &info, uint64_t cropX, uint64_t cropY)
+    {
+        info.width = (cropX < info.codedWidth) ? info.codedWidth - static_cast<uint32_t>(cropX) : info.codedWidth;
+        info.height = (cropY < info.codedHeight) ? info.codedHeight - static_cast<uint32_t>(cropY) : info.codedHeight;
+    }
+
+    inline void SkipH264ScalingList(BitReader &reader, uint32_t size)
+    {
+        int32_t lastScale = 8;  // 8: 缩放系数初值
+        int32_t nextScale = 8;
+        for (uint32_t i = 0; i < size && nextScale != 0 && !reader.Overrun(); ++i) {
+            nextScale = (lastScale + reader.ReadSe() + 256) % 256;  // 256: 缩放系数取值范围
+            lastScale = (nextScale == 0) ? lastScale : nextScale;
+        }
+    }
+
+    // H.264 VUI中的timing_info，帧率 = time_scale / (2 * num_units_in_tick)
+    inline void ParseH264Vui(BitReader &reader, StreamInfo &info)
+    {
+        if (reader.ReadBit() != 0 && reader.ReadBits(8) == EXTENDED_SAR) {  // 8: aspect_ratio_idc
+            reader.SkipBits(32);        // 32: sar_width, sar_height
+        }
+        if (reader.ReadBit() != 0) {    // overscan_info_present_flag
+            reader.SkipBits(1);
+        }
+        if (reader.ReadBit() != 0) {    // video_signal_type_present_flag
+            reader.SkipBits(4);         // 4: video_format, video_full_range_flag
+            if (reader.ReadBit() != 0) {
+                reader.SkipBits(24);    // 24: colour_primaries, transfer_characteristics, matrix_coefficients
+            }
+        }
+        if (reader.ReadBit() != 0) {    // chroma_loc_info_present_flag
+            (void) reader.ReadUe();
+            (void) reader.ReadUe();
+        }
+        if (reader.ReadBit() != 0) {    // timing_info_present_flag
+            uint32_t unitsInTick = reader.ReadBits(32); // 32: num_units_in_tick
+            uint32_t timeScale = reader.ReadBits(32);   // 32: time_scale
+            if (!reader.Overrun() && unitsInTick != 0) {
+                info.frameRate = static_cast<uint32_t>((static_cast<uint64_t>(timeScale) + unitsInTick) /
+                    (2ULL * unitsInTick));
+            }
+        }
+    }
+
+    /**
+     * @功能描述: 解析H.264 SPS
+     * @参数 [in] rbsp: SPS的RBSP，不含NAL头
+     * @参数 [out] info: 码流参数
+     * @返回值: true 成功；false 码流截断或语法不支持
+     */
+    inline bool ParseH264Sps(const std::vector<uint8_t> &rbsp, StreamInfo &info)
+    {
+        BitReader reader(rbsp.data(), rbsp.size());
+        uint32_t profile = reader.ReadBits(8);  // 8: profile_idc
+        reader.SkipBits(16);                    // 16: constraint_set_flags, level_idc
+        (void) reader.ReadUe();                 // seq_parameter_set_id
+        uint32_t chromaFormat = 1;              // 1: 4:2:0
+        static const uint32_t highProfiles[] = {100, 110, 122, 244, 44, 83, 86, 118, 128, 138, 139, 134, 135};
+        bool high = false;
+        for (uint32_t highProfile : highProfiles) {
+            high = high || profile == highProfile;
+        }
+        if (high) {
+            chromaFormat = reader.ReadUe();
+            if (chromaFormat == 3) {            // 3: 4:4:4
+                reader.SkipBits(1);             // separate_colour_plane_flag
+            }
+            info.bitDepth = BIT_DEPTH_BASE + reader.ReadUe();
+            (void) reader.ReadUe();             // bit_depth_chroma_minus8
+            reader.SkipBits(1);                 // qpprime_y_zero_transform_bypass_flag
+            if (reader.ReadBit() != 0) {        // seq_scaling_matrix_present_flag
+                uint32_t lists = (chromaFormat == 3) ? 12 : 8;  // 12/8: 缩放矩阵个数
+                for (uint32_t i = 0; i < lists; ++i) {
+                    if (reader.ReadBit() != 0) {
+                        SkipH264ScalingList(reader, (i < 6) ? 16 : 64); // 6: 4x4矩阵个数，16/64: 矩阵大小
+                    }
+                }
+            }
+        }
+        (void) reader.ReadUe();                 // log2_max_frame_num_minus4
+        uint32_t pocType = reader.ReadUe();
+        if (pocType == 0) {
+            (void) reader.ReadUe();             // log2_max_pic_order_cnt_lsb_minus4
+        } else if (pocType == 1) {
+            reader.SkipBits(1);                 // delta_pic_order_always_zero_flag
+            (void) reader.ReadSe();             // offset_for_non_ref_pic
+            (void) reader.ReadSe();             // offset_for_top_to_bottom_field
+            uint32_t cycle = reader.ReadUe();
+            for (uint32_t i = 0; i < cycle && !reader.Overrun(); ++i) {
+                (void) reader.ReadSe();
+            }
+        }
+        (void) reader.ReadUe();                 // max_num_ref_frames
+        reader.SkipBits(1);                     // gaps_in_frame_num_value_allowed_flag
+        uint32_t widthInMbs = reader.ReadUe() + 1;
+        uint32_t heightInMapUnits = reader.ReadUe() + 1;
+        uint32_t frameMbsOnly = reader.ReadBit();
+        if (frameMbsOnly == 0) {
+            reader.SkipBits(1);                 // mb_adaptive_frame_field_flag
+        }
+        reader.SkipBits(1);                     // direct_8x8_inference_flag
+        info.codedWidth = widthInMbs * H264_MB_SIZE;
+        info.codedHeight = (2 - frameMbsOnly) * heightInMapUnits * H264_MB_SIZE;   // 2: 场编码时以场对计
+        uint64_t cropX = 0;
+        uint64_t cropY = 0;
+        if (reader.ReadBit() != 0) {            // frame_cropping_flag
+            // 裁剪单位：4:2:0为2x2，4:2:2为2x1，单色与4:4:4为1x1，场编码时纵向加倍
+            uint32_t unitX = (chromaFormat == 1 || chromaFormat == 2) ? 2 : 1;
+            uint32_t unitY = ((chromaFormat == 1) ? 2 : 1) * (2 - frameMbsOnly);
+            uint64_t left = reader.ReadUe();
+            uint64_t right = reader.ReadUe();
+            uint64_t top = reader.ReadUe();
+            uint64_t bottom = reader.ReadUe();
+            cropX = (left + right) * unitX;
+            cropY = (top + bottom) * unitY;
+        }
+        ApplyCrop(info, cropX, cropY);
+        if (reader.ReadBit() != 0) {            // vui_parameters_present_flag
+            ParseH264Vui(reader, info);
+        }
+        return !reader.Overrun() && info.codedWidth > 0 && info.codedHeight > 0;
+    }
+
+    // H.265 profile_tier_level，只跳过不解析
+    inline void SkipH265ProfileTierLevel(BitReader &reader, uint32_t maxSubLayersMinus1)
+    {
+        reader.SkipBits(96);                    // 96: general_profile ... general_level_idc
+        uint32_t profilePresent = 0;
+        uint32_t levelPresent = 0;
+        for (uint32_t i = 0; i < maxSubLayersMinus1; ++i) {
+            profilePresent |= reader.ReadBit() << i;
+            levelPresent |= reader.ReadBit() << i;
+        }
+        if (maxSubLayersMinus1 > 0) {
+            reader.SkipBits(2 * (8 - maxSubLayersMinus1));  // 2: reserved_zero_2bits，8: 最大子层数
+        }
+        for (uint32_t i = 0; i < maxSubLayersMinus1; ++i) {
+            reader.SkipBits((((profilePresent >> i) & 1) != 0) ? 88 : 0);   // 88: sub_layer_profile
+            reader.SkipBits((((levelPresent >> i) & 1) != 0) ? 8 : 0);      // 8: sub_layer_level_idc
+        }
+    }
+
+    inline void SkipH265ScalingListData(BitReader &reader)
+    {
+        for (uint32_t sizeId = 0; sizeId < 4; ++sizeId) {   // 4: 4x4到32x32
+            for (uint32_t matrixId = 0; matrixId < 6; matrixId += (sizeId == 3) ? 3 : 1) {  // 6: 矩阵个数
+                if (reader.ReadBit() == 0) {    // scaling_list_pred_mode_flag
+                    (void) reader.ReadUe();     // scaling_list_pred_matrix_id_delta
+                    continue;
+                }
+                uint32_t coefNum = (sizeId == 0) ? 16 : 64;     // 16/64: 系数个数上限
+                if (sizeId > 1) {
+                    (void) reader.ReadSe();     // scaling_list_dc_coef_minus8
+                }
+                for (uint32_t i = 0; i < coefNum && !reader.Overrun(); ++i) {
+                    (void) reader.ReadSe();
+                }
+            }
+        }
+    }
+
+    // 跳过SPS中的st_ref_pic_set，numDeltaPocs记录各参考图像集的参考帧数，供帧间预测的参考图像集使用
+    inline bool SkipH265ShortTermRefPicSets(BitReader &reader, uint32_t count)
+    {
+        constexpr uint32_t maxSets = 64;        // 64: num_short_term_ref_pic_sets上限
+        constexpr uint32_t maxPics = 16;        // 16: 单个参考图像集的参考帧数上限
+        if (count > maxSets) {
+            return false;
+        }
+        std::vector<uint32_t> numDeltaPocs(count, 0);
+        for (uint32_t idx = 0; idx < count && !reader.Overrun(); ++idx) {
+            if (idx != 0 && reader.ReadBit() != 0) {    // inter_ref_pic_set_prediction_flag
+                reader.SkipBits(1);                     // delta_rps_sign
+                (void) reader.ReadUe();                 // abs_delta_rps_minus1
+                uint32_t used = 0;
+                for (uint32_t j = 0; j <= numDeltaPocs[idx - 1] && !reader.Overrun(); ++j) {
+                    // used_by_curr_pic_flag为0时读取use_delta_flag
+                    used += (reader.ReadBit() != 0 || reader.ReadBit() != 0) ? 1 : 0;
+                }
+                numDeltaPocs[idx] = used;
+                continue;
+            }
+            uint32_t negative = reader.ReadUe();
+            uint32_t positive = reader.ReadUe();
+            if (negative > maxPics || positive > maxPics) {
+                return false;
+            }
+            for (uint32_t i = 0; i < negative + positive; ++i) {
+                (void) reader.ReadUe();                 // delta_poc_minus1
+                reader.SkipBits(1);                     // used_by_curr_pic_flag
+            }
+            numDeltaPocs[idx] = negative + positive;
+        }
+        return true;
+    }
+
+    // H.265 VUI中的vui_timing_info，帧率 = time_scale / num_units_in_tick
+    inline void ParseH265Vui(BitReader &reader, StreamInfo &info)
+    {
+        if (reader.ReadBit() != 0 && reader.ReadBits(8) == EXTENDED_SAR) {  // 8: aspect_ratio_idc
+            reader.SkipBits(32);        // 32: sar_width, sar_height
+        }
+        if (reader.ReadBit() != 0) {    // overscan_info_present_flag
+            reader.SkipBits(1);
+        }
+        if (reader.ReadBit() != 0) {    // video_signal_type_present_flag
+            reader.SkipBits(4);         // 4: video_format, video_full_range_flag
+            if (reader.ReadBit() != 0) {
+                reader.SkipBits(24);    // 24: colour_primaries, transfer_characteristics, matrix_coeffs
+            }
+        }
+        if (reader.ReadBit() != 0) {    // chroma_loc_info_present_flag
+            (void) reader.ReadUe();
+            (void) reader.ReadUe();
+        }
+        reader.SkipBits(3);             // 3: neutral_chroma_indication, field_seq, frame_field_info_present_flag
+        if (reader.ReadBit() != 0) {    // default_display_window_flag
+            for (uint32_t i = 0; i < 4; ++i) {  // 4: 左右上下偏移
+                (void) reader.ReadUe();
+            }
+        }
+        if (reader.ReadBit() != 0) {    // vui_timing_info_present_flag
+            uint32_t unitsInTick = reader.ReadBits(32); // 32: vui_num_units_in_tick
+            uint32_t timeScale = reader.ReadBits(32);   // 32: vui_time_scale
+            if (!reader.Overrun() && unitsInTick != 0) {
+                info.frameRate = static_cast<uint32_t>((static_cast<uint64_t>(timeScale) + unitsInTick / 2) /
+                    unitsInTick);
+            }
+        }
+    }
+
+    /**
+     * @功能描述: 解析H.265 VPS中的帧率
+     * @参数 [in] rbsp: VPS的RBSP，不含NAL头
+     * @参数 [out] info: 码流参数，仅更新frameRate
+     * @返回值: true 成功；false 码流截断
+     */
+    inline bool ParseH265Vps(const std::vector<uint8_t> &rbsp, StreamInfo &info)
+    {
+        BitReader reader(rbsp.data(), rbsp.size());
+        reader.SkipBits(12);                    // 12: vps_video_parameter_set_id ... vps_max_layers_minus1
+        uint32_t maxSubLayersMinus1 = reader.ReadBits(3);   // 3: vps_max_sub_layers_minus1
+        reader.SkipBits(17);                    // 17: vps_temporal_id_nesting_flag, vps_reserved_0xffff_16bits
+        SkipH265ProfileTierLevel(reader, maxSubLayersMinus1);
+        uint32_t first = (reader.ReadBit() != 0) ? 0 : maxSubLayersMinus1;
+        for (uint32_t i = first; i <= maxSubLayersMinus1; ++i) {
+            (void) reader.ReadUe();             // vps_max_dec_pic_buffering_minus1
+            (void) reader.ReadUe();             // vps_max_num_reorder_pics
+            (void) reader.ReadUe();             // vps_max_latency_increase_plus1
+        }
+        uint32_t maxLayerId = reader.ReadBits(6);   // 6: vps_max_layer_id
+        uint32_t layerSets = reader.ReadUe();
+        if (layerSets > 1023) {                 // 1023: vps_num_layer_sets_minus1上限
+            return false;
+        }
+        reader.SkipBits(static_cast<size_t>(layerSets) * (maxLayerId + 1));  // layer_id_included_flag
+        if (reader.ReadBit() != 0) {            // vps_timing_info_present_flag
+            uint32_t unitsInTick = reader.ReadBits(32); // 32: vps_num_units_in_tick
+            uint32_t timeScale = reader.ReadBits(32);   // 32: vps_time_scale
+            if (!reader.Overrun() && unitsInTick != 0) {
+                info.frameRate = static_cast<uint32_t>((static_cast<uint64_t>(timeScale) + unitsInTick / 2) /
+                    unitsInTick);
+            }
+        }
+        return !reader.Overrun();
+    }
+
+    /**
+     * @功能描述: 解析H.265 SPS
+     * @参数 [in] rbsp: SPS的RBSP，不含NAL头
+     * @参数 [out] info: 码流参数，VUI未携带帧率时保留VPS中的帧率
+     * @返回值: true 成功；false 码流截断或语法不支持
+     */
+    inline bool ParseH265Sps(const std::vector<uint8_t> &rbsp, StreamInfo &info)
+    {
+        BitReader reader(rbsp.data(), rbsp.size());
+        reader.SkipBits(4);                     // 4: sps_video_parameter_set_id
+        uint32_t maxSubLayersMinus1 = reader.ReadBits(3);   // 3: sps_max_sub_layers_minus1
+        reader.SkipBits(1);                     // sps_temporal_id_nesting_flag
+        SkipH265ProfileTierLevel(reader, maxSubLayersMinus1);
+        (void) reader.ReadUe();                 // sps_seq_parameter_set_id
+        uint32_t chromaFormat = reader.ReadUe();
+        if (chromaFormat == 3) {                // 3: 4:4:4
+            reader.SkipBits(1);                 // separate_colour_plane_flag
+        }
+        info.codedWidth = reader.ReadUe();
+        info.codedHeight = reader.ReadUe();
+        uint64_t cropX = 0;
+        uint64_t cropY = 0;
+        if (reader.ReadBit() != 0) {            // conformance_window_flag
+            // 裁剪单位：4:2:0为2x2，4:2:2为2x1，单色与4:4:4为1x1
+            uint32_t unitX = (chromaFormat == 1 || chromaFormat == 2) ? 2 : 1;
+            uint32_t unitY = (chromaFormat == 1) ? 2 : 1;
+            uint64_t left = reader.ReadUe();
+            uint64_t right = reader.ReadUe();
+            uint64_t top = reader.ReadUe();
+            uint64_t bottom = reader.ReadUe();
+            cropX = (left + right) * unitX;
+            cropY = (top + bottom) * unitY;
+        }
+        ApplyCrop(info, cropX, cropY);
+        info.bitDepth = BIT_DEPTH_BASE + reader.ReadUe();
+        (void) reader.ReadUe();                 // bit_depth_chroma_minus8
+        uint32_t pocLsbBits = reader.ReadUe() + 4;  // 4: log2_max_pic_order_cnt_lsb_minus4
+        uint32_t first = (reader.ReadBit() != 0) ? 0 : maxSubLayersMinus1;
+        for (uint32_t i = first; i <= maxSubLayersMinus1; ++i) {
+            (void) reader.ReadUe();             // sps_max_dec_pic_buffering_minus1
+            (void) reader.ReadUe();             // sps_max_num_reorder_pics
+            (void) reader.ReadUe();             // sps_max_latency_increase_plus1
+        }
+        for (uint32_t i = 0; i < 6; ++i) {      // 6: 编码块与变换块大小、变换层级
+            (void) reader.ReadUe();
+        }
+        bool sizeValid = !reader.Overrun() && info.codedWidth > 0 && info.codedHeight > 0;
+        // 以下字段仅为定位VUI中的帧率，解析失败时保留已取得的尺寸与位深
+        if (reader.ReadBit() != 0 && reader.ReadBit() != 0) {   // scaling_list_enabled, sps_scaling_list_data_present
+            SkipH265ScalingListData(reader);
+        }
+        reader.SkipBits(2);                     // 2: amp_enabled_flag, sample_adaptive_offset_enabled_flag
+        if (reader.ReadBit() != 0) {            // pcm_enabled_flag
+            reader.SkipBits(8);                 // 8: pcm_sample_bit_depth_luma/chroma_minus1
+            (void) reader.ReadUe();             // log2_min_pcm_luma_coding_block_size_minus3
+            (void) reader.ReadUe();             // log2_diff_max_min_pcm_luma_coding_block_size
+            reader.SkipBits(1);                 // pcm_loop_filter_disabled_flag
+        }
+        if (!SkipH265ShortTermRefPicSets(reader, reader.ReadUe())) {
+            return sizeValid;
+        }
+        if (reader.ReadBit() != 0) {            // long_term_ref_pics_present_flag
+            uint32_t longTermPics = reader.ReadUe();
+            if (longTermPics > 32) {            // 32: num_long_term_ref_pics_sps上限
+                return sizeValid;
+            }
+            reader.SkipBits(static_cast<size_t>(longTermPics) * (pocLsbBits + 1));
+        }
+        reader.SkipBits(2);                     // 2: sps_temporal_mvp_enabled, strong_intra_smoothing_enabled
+        if (reader.ReadBit() != 0) {            // vui_parameters_present_flag
+            StreamInfo vui = info;
+            ParseH265Vui(reader, vui);
+            if (!reader.Overrun()) {
+                info.frameRate = vui.frameRate;
+            }
+        }
+        return sizeValid;
+    }
+
+    /**
+     * @功能描述: 检查码流参数是否在支持范围内，帧率超出范围时置0，由调用方使用配置的帧率
+     * @参数 [in/out] info: 码流参数
+     * @返回值: true 尺寸与位深可用；false 尺寸超过DIMENSION_MAX或位深不是8/10
+     */
+    inline bool Validate(StreamInfo &info)
+    {
+        if (info.frameRate > FRAME_RATE_MAX) {
+            info.frameRate = 0;
+        }
+        return info.width > 0 && info.height > 0 && info.codedWidth <= DIMENSION_MAX &&
+            info.codedHeight <= DIMENSION_MAX && (info.bitDepth == BIT_DEPTH_BASE || info.bitDepth == BIT_DEPTH_HIGH);
+    }
+
+    /**
+     * @功能描述: 从码流中查找参数集并解析码流参数，H.265同时使用VPS与SPS中的帧率，SPS优先
+     * @参数 [in] data: Annex-B码流
+     * @参数 [in] size: 码流大小
+     * @参数 [in] h264: true H.264；false H.265
+     * @参数 [out] info: 码流参数
+     * @返回值: true 找到并解析了SPS；false 码流中没有可解析的SPS，或其参数超出支持范围
+     */
+    inline bool Parse(const uint8_t *data, size_t size, bool h264, StreamInfo &info)
+    {
+        const size_t headerLen = h264 ? 1 : 2;  // 2: H.265 NAL头长度
+        StreamInfo parsed;
+        size_t pos = 0;
+        while (pos < size) {
+            size_t codeLen = 0;
+            size_t start = StartCodeScanner::FindStartCode(data, size, pos, codeLen);
+            size_t nal = start + codeLen;
+            if (start >= size || nal + headerLen >= size) {
+                return false;
+            }
+            size_t end = StartCodeScanner::FindNalEnd(data, size, nal);
+            pos = end;
+            uint32_t type = h264 ? (data[nal] & H264_NAL_TYPE_MASK) : ((data[nal] >> 1) & H265_NAL_TYPE_MASK);
+            std::vector<uint8_t> rbsp;
+            if (h264 && type == H264_NAL_SPS) {
+                rbsp = ToRbsp(data + nal + headerLen, end - nal - headerLen);
+                if (ParseH264Sps(rbsp, parsed)) {
+                    if (!Validate(parsed)) {
+                        return false;
+                    }
+                    info = parsed;
+                    return true;
+                }
+            } else if (!h264 && type == H265_NAL_VPS) {
+                rbsp = ToRbsp(data + nal + headerLen, end - nal - headerLen);
+                (void) ParseH265Vps(rbsp, parsed);
+            } else if (!h264 && type == H265_NAL_SPS) {
+                rbsp = ToRbsp(data + nal + headerLen, end - nal - headerLen);
+                if (ParseH265Sps(rbsp, parsed)) {
+                    if (!Validate(parsed)) {
+                        return false;
+                    }
+                    info = parsed;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+#endif  // SPS_PARSER_H
@@ -0,0 +1,117 @@
+/*
+ * 功能说明: Annex-B码流起始码查找，按16字节一组用SSE2/NEON比较得到连续两个0x00的候选位置，再逐个校验第三字节，
+ *           压缩数据中0x0000仅出现在起始码与防竞争字节之前，候选很少，不支持SIMD的平台按字节查找；
+ *           SIMD与逐字节查找的结果须逐位置一致，由start_code_bench在各目标平台上核对
+ */
+#ifndef START_CODE_SCANNER_H
+#define START_CODE_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace StartCodeScanner {
+    constexpr size_t START_CODE_LEN = 3;        // 0x000001
+    constexpr size_t START_CODE_LONG_LEN = 4;   // 0x00000001
+    constexpr size_t SIMD_WIDTH = 16;
+
+    /**
+     * @功能描述: 查找第一个0x000000或0x000001的位置
+     * @参数 [in] data: 码流数据
+     * @参数 [in] size: 码流大小
+     * @参数 [in] from: 起始查找位置
+     * @返回值: 找到的位置，未找到时返回size
+     */
+    inline size_t FindZeroPair(const uint8_t *data, size_t size, size_t from)
+    {
+        if (size < START_CODE_LEN || from > size - START_CODE_LEN) {
+            return size;
+        }
+        const size_t last = size - START_CODE_LEN;  // 最后一个可完整比较的位置
+        size_t i = from;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+        // 每组比较位置i..i+15，需读取到i+16，第三字节在组外时由校验读取，保证i+17 <= size
+        for (; i + SIMD_WIDTH + 1 <= last; i += SIMD_WIDTH) {
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            __m128i first = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), zero);
+            __m128i second = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1)), zero);
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(first, second)));
+            while (mask != 0) {
+                size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+                if (data[pos + 2] <= 1) {    // 2: 第三字节
+                    return pos;
+                }
+                mask &= mask - 1;
+            }
+#else
+            const uint8x16_t zero = vdupq_n_u8(0);
+            uint8x16_t pair = vandq_u8(vceqq_u8(vld1q_u8(data + i), zero), vceqq_u8(vld1q_u8(data + i + 1), zero));
+            // 每字节压缩为4位，得到64位掩码
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(pair), 4)), 0);
+            while (mask != 0) {
+                size_t pos = i + static_cast<size_t>(__builtin_ctzll(mask)) / 4;    // 4: 每字节4位
+                if (data[pos + 2] <= 1) {    // 2: 第三字节
+                    return pos;
+                }
+                mask &= ~(0xFULL << ((pos - i) * 4));   // 4: 每字节4位
+            }
+#endif
+        }
+#endif
+        for (; i <= last; ++i) {
+            if (data[i + 2] > 1) {  // 2: 第三字节大于1时i与i+1均不可能是候选，跳过
+                ++i;
+                continue;
+            }
+            if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] <= 1) {
+                return i;
+            }
+        }
+        return size;
+    }
+
+    /**
+     * @功能描述: 查找起始码，四字节起始码返回其首字节位置
+     * @参数 [in] data: 码流数据
+     * @参数 [in] size: 码流大小
+     * @参数 [in] from: 起始查找位置
+     * @参数 [out] codeLen: 起始码长度，3或4
+     * @返回值: 起始码位置，未找到时返回size
+     */
+    inline size_t FindStartCode(const uint8_t *data, size_t size, size_t from, size_t &codeLen)
+    {
+        size_t pos = FindZeroPair(data, size, from);
+        // 0x000000不是起始码，跳过其首字节继续查找
+        while (pos < size && data[pos + 2] != 1) {  // 2: 第三字节
+            pos = FindZeroPair(data, size, pos + 1);
+        }
+        if (pos >= size) {
+            return size;
+        }
+        codeLen = START_CODE_LEN;
+        if (pos > from && data[pos - 1] == 0) {
+            codeLen = START_CODE_LONG_LEN;
+            return pos - 1;
+        }
+        return pos;
+    }
+
+    /**
+     * @功能描述: 查找NAL单元结束位置，即下一个0x000000或0x000001
+     * @参数 [in] data: 码流数据
+     * @参数 [in] size: 码流大小
+     * @参数 [in] from: NAL单元头位置
+     * @返回值: 结束位置，到达码流末尾时返回size
+     */
+    inline size_t FindNalEnd(const uint8_t *data, size_t size, size_t from)
+    {
+        return FindZeroPair(data, size, from);
+    }
+}
+
+#endif  // START_CODE_SCANNER_H
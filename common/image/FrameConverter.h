@@ -0,0 +1,275 @@
+/*
+ * 功能说明: 解码输出格式转换，将设备输出的I420平面在拷出设备缓冲的同时转换为NV12、NV21或RGBA，
+ *           按16像素一组用SSE2/NEON处理，不支持SIMD的平台及行尾按像素处理，两者结果逐字节一致
+ */
+#ifndef FRAME_CONVERTER_H
+#define FRAME_CONVERTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace FrameConverter {
+    constexpr uint32_t PLANE_NUM = 3;           // Y、U、V
+    constexpr uint32_t RGBA_BYTES_PER_PIXEL = 4;
+    constexpr uint32_t SIMD_WIDTH = 16;
+
+    // BT.601有限范围YUV转RGB，系数放大64倍，保证16位运算不溢出：
+    // R = (74 * (Y - 16) + 102 * (V - 128) + 32) >> 6
+    // G = (74 * (Y - 16) - 25 * (U - 128) - 52 * (V - 128) + 32) >> 6
+    // B = (74 * (Y - 16) + 129 * (U - 128) + 32) >> 6
+    constexpr int Y_OFFSET = 16;
+    constexpr int UV_OFFSET = 128;
+    constexpr int Y_COEF = 74;
+    constexpr int RV_COEF = 102;
+    constexpr int GU_COEF = 25;
+    constexpr int GV_COEF = 52;
+    constexpr int BU_COEF = 129;
+    constexpr int ROUND = 32;
+    constexpr int SHIFT = 6;
+
+    // I420源图像，各平面跨距单位为字节
+    struct SourceFrame {
+        const uint8_t *planes[PLANE_NUM] = {nullptr, nullptr, nullptr};
+        uint32_t strides[PLANE_NUM] = {0, 0, 0};
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    inline uint8_t Clamp(int value)
+    {
+        return static_cast<uint8_t>(std::min(std::max(value, 0), 255));   // 255: uint8_t最大值
+    }
+
+    /**
+     * @功能描述: 将两个平面的一行交织为半平面格式，逐像素处理
+     * @参数 [in] first: 交织后位于偶数位置的平面数据
+     * @参数 [in] second: 交织后位于奇数位置的平面数据
+     * @参数 [out] dst: 输出行
+     * @参数 [in] count: 每个平面的采样数
+     */
+    inline void InterleaveRowScalar(const uint8_t *first, const uint8_t *second, uint8_t *dst, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i) {
+            dst[2 * i] = first[i];          // 2: 每组两个采样
+            dst[2 * i + 1] = second[i];
+        }
+    }
+
+    /**
+     * @功能描述: 将两个平面的一行交织为半平面格式
+     * @参数 [in] first: 交织后位于偶数位置的平面数据
+     * @参数 [in] second: 交织后位于奇数位置的平面数据
+     * @参数 [out] dst: 输出行
+     * @参数 [in] count: 每个平面的采样数
+     */
+    inline void InterleaveRow(const uint8_t *first, const uint8_t *second, uint8_t *dst, uint32_t count)
+    {
+        uint32_t i = 0;
+#if defined(__SSE2__)
+        for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(second + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), _mm_unpacklo_epi8(a, b));    // 2: 每组两个采样
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i + SIMD_WIDTH), _mm_unpackhi_epi8(a, b));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+            uint8x16x2_t pair = {{vld1q_u8(first + i), vld1q_u8(second + i)}};
+            vst2q_u8(dst + 2 * i, pair);    // 2: 每组两个采样
+        }
+#endif
+        InterleaveRowScalar(first + i, second + i, dst + 2 * i, count - i); // 2: 每组两个采样
+    }
+
+    /**
+     * @功能描述: 将I420的一行转换为RGBA，色度按最近邻上采样，逐像素处理
+     * @参数 [in] y: 亮度行
+     * @参数 [in] u: 对应的U行
+     * @参数 [in] v: 对应的V行
+     * @参数 [out] dst: 输出行
+     * @参数 [in] width: 像素数
+     */
+    inline void YuvToRgbaRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; ++x) {
+            int yy = Y_COEF * (y[x] - Y_OFFSET) + ROUND;
+            int uu = u[x / 2] - UV_OFFSET;  // 2: 色度水平下采样
+            int vv = v[x / 2] - UV_OFFSET;
+            uint8_t *pixel = dst + x * RGBA_BYTES_PER_PIXEL;
+            pixel[0] = Clamp((yy + RV_COEF * vv) >> SHIFT);
+            pixel[1] = Clamp((yy - GU_COEF * uu - GV_COEF * vv) >> SHIFT);
+            pixel[2] = Clamp((yy + BU_COEF * uu) >> SHIFT);     // 2: B
+            pixel[3] = 255;                                      // 3: A; 255: 不透明
+        }
+    }
+
+#if defined(__SSE2__)
+    // 8个像素的16位运算，B分量可能超出int16范围，饱和后移位再截断与标量结果一致
+    inline void YuvToRgb8(__m128i y, __m128i u, __m128i v, __m128i &r, __m128i &g, __m128i &b)
+    {
+        __m128i yy = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(Y_OFFSET)),
+            _mm_set1_epi16(Y_COEF)), _mm_set1_epi16(ROUND));
+        __m128i uu = _mm_sub_epi16(u, _mm_set1_epi16(UV_OFFSET));
+        __m128i vv = _mm_sub_epi16(v, _mm_set1_epi16(UV_OFFSET));
+        r = _mm_srai_epi16(_mm_add_epi16(yy, _mm_mullo_epi16(vv, _mm_set1_epi16(RV_COEF))), SHIFT);
+        g = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(yy, _mm_mullo_epi16(uu, _mm_set1_epi16(GU_COEF))),
+            _mm_mullo_epi16(vv, _mm_set1_epi16(GV_COEF))), SHIFT);
+        b = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(uu, _mm_set1_epi16(BU_COEF))), SHIFT);
+    }
+#elif defined(__ARM_NEON)
+    // 8个像素的16位运算，B分量可能超出int16范围，饱和后移位再截断与标量结果一致
+    inline void YuvToRgb8(int16x8_t y, int16x8_t u, int16x8_t v, int16x8_t &r, int16x8_t &g, int16x8_t &b)
+    {
+        int16x8_t yy = vaddq_s16(vmulq_n_s16(vsubq_s16(y, vdupq_n_s16(Y_OFFSET)), Y_COEF), vdupq_n_s16(ROUND));
+        int16x8_t uu = vsubq_s16(u, vdupq_n_s16(UV_OFFSET));
+        int16x8_t vv = vsubq_s16(v, vdupq_n_s16(UV_OFFSET));
+        r = vshrq_n_s16(vmlaq_n_s16(yy, vv, RV_COEF), SHIFT);
+        g = vshrq_n_s16(vmlsq_n_s16(vmlsq_n_s16(yy, uu, GU_COEF), vv, GV_COEF), SHIFT);
+        b = vshrq_n_s16(vqaddq_s16(yy, vmulq_n_s16(uu, BU_COEF)), SHIFT);
+    }
+
+    inline int16x8_t Widen(uint8x8_t value)
+    {
+        return vreinterpretq_s16_u16(vmovl_u8(value));
+    }
+#endif
+
+    /**
+     * @功能描述: 将I420的一行转换为RGBA，色度按最近邻上采样
+     * @参数 [in] y: 亮度行
+     * @参数 [in] u: 对应的U行
+     * @参数 [in] v: 对应的V行
+     * @参数 [out] dst: 输出行
+     * @参数 [in] width: 像素数
+     */
+    inline void YuvToRgbaRow(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, uint32_t width)
+    {
+        uint32_t x = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+        for (; x + SIMD_WIDTH <= width; x += SIMD_WIDTH) {
+            __m128i yv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+            __m128i uv = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2));    // 2: 色度水平下采样
+            __m128i vv = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2));
+            uv = _mm_unpacklo_epi8(uv, uv);
+            vv = _mm_unpacklo_epi8(vv, vv);
+            __m128i rLo;
+            __m128i gLo;
+            __m128i bLo;
+            __m128i rHi;
+            __m128i gHi;
+            __m128i bHi;
+            YuvToRgb8(_mm_unpacklo_epi8(yv, zero), _mm_unpacklo_epi8(uv, zero), _mm_unpacklo_epi8(vv, zero),
+                rLo, gLo, bLo);
+            YuvToRgb8(_mm_unpackhi_epi8(yv, zero), _mm_unpackhi_epi8(uv, zero), _mm_unpackhi_epi8(vv, zero),
+                rHi, gHi, bHi);
+            __m128i r = _mm_packus_epi16(rLo, rHi);
+            __m128i g = _mm_packus_epi16(gLo, gHi);
+            __m128i b = _mm_packus_epi16(bLo, bHi);
+            __m128i rgLo = _mm_unpacklo_epi8(r, g);
+            __m128i rgHi = _mm_unpackhi_epi8(r, g);
+            __m128i baLo = _mm_unpacklo_epi8(b, alpha);
+            __m128i baHi = _mm_unpackhi_epi8(b, alpha);
+            __m128i *out = reinterpret_cast<__m128i *>(dst + x * RGBA_BYTES_PER_PIXEL);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(rgLo, baLo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rgLo, baLo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rgHi, baHi));  // 2: 第3组4个像素
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rgHi, baHi));  // 3: 第4组4个像素
+        }
+#elif defined(__ARM_NEON)
+        for (; x + SIMD_WIDTH <= width; x += SIMD_WIDTH) {
+            uint8x16_t yv = vld1q_u8(y + x);
+            uint8x8_t uv = vld1_u8(u + x / 2);  // 2: 色度水平下采样
+            uint8x8_t vv = vld1_u8(v + x / 2);
+            uint8x8x2_t uDup = vzip_u8(uv, uv);
+            uint8x8x2_t vDup = vzip_u8(vv, vv);
+            int16x8_t rLo;
+            int16x8_t gLo;
+            int16x8_t bLo;
+            int16x8_t rHi;
+            int16x8_t gHi;
+            int16x8_t bHi;
+            YuvToRgb8(Widen(vget_low_u8(yv)), Widen(uDup.val[0]), Widen(vDup.val[0]), rLo, gLo, bLo);
+            YuvToRgb8(Widen(vget_high_u8(yv)), Widen(uDup.val[1]), Widen(vDup.val[1]), rHi, gHi, bHi);
+            uint8x16x4_t rgba;
+            rgba.val[0] = vcombine_u8(vqmovun_s16(rLo), vqmovun_s16(rHi));
+            rgba.val[1] = vcombine_u8(vqmovun_s16(gLo), vqmovun_s16(gHi));
+            rgba.val[2] = vcombine_u8(vqmovun_s16(bLo), vqmovun_s16(bHi));     // 2: B
+            rgba.val[3] = vdupq_n_u8(0xFF);                                     // 3: A
+            vst4q_u8(dst + x * RGBA_BYTES_PER_PIXEL, rgba);
+        }
+#endif
+        YuvToRgbaRowScalar(y + x, u + x / 2, v + x / 2, dst + x * RGBA_BYTES_PER_PIXEL, width - x);    // 2: 色度下采样
+    }
+
+    /**
+     * @功能描述: I420转换为NV12或NV21，亮度平面在前，交织的色度平面从dstStride * dstScanLines处开始
+     * @参数 [in] src: 源图像
+     * @参数 [out] dst: 输出缓冲
+     * @参数 [in] dstStride: 输出跨距(Byte)
+     * @参数 [in] dstScanLines: 输出亮度平面行数
+     * @参数 [in] maxLen: 输出缓冲大小
+     * @参数 [in] vFirst: true 输出NV21；false 输出NV12
+     * @返回值: 输出数据大小，参数非法或输出缓冲不足时返回0
+     */
+    inline uint32_t ToSemiPlanar(const SourceFrame &src, uint8_t *dst, uint32_t dstStride, uint32_t dstScanLines,
+        uint32_t maxLen, bool vFirst)
+    {
+        uint32_t chromaWidth = (src.width + 1) / 2;     // 2: 色度下采样
+        uint32_t chromaHeight = (src.height + 1) / 2;
+        size_t lumaSize = static_cast<size_t>(dstStride) * dstScanLines;
+        size_t size = lumaSize + static_cast<size_t>(dstStride) * chromaHeight;
+        if (dst == nullptr || dstStride < chromaWidth * 2 || dstStride < src.width || dstScanLines < src.height ||
+            size > maxLen) {
+            return 0;
+        }
+        for (uint32_t row = 0; row < src.height; ++row) {
+            (void) memcpy(dst + static_cast<size_t>(row) * dstStride,
+                src.planes[0] + static_cast<size_t>(row) * src.strides[0], src.width);
+        }
+        const uint8_t *first = src.planes[vFirst ? 2 : 1];  // 1: U; 2: V
+        const uint8_t *second = src.planes[vFirst ? 1 : 2];
+        uint32_t firstStride = src.strides[vFirst ? 2 : 1];
+        uint32_t secondStride = src.strides[vFirst ? 1 : 2];
+        for (uint32_t row = 0; row < chromaHeight; ++row) {
+            InterleaveRow(first + static_cast<size_t>(row) * firstStride,
+                second + static_cast<size_t>(row) * secondStride,
+                dst + lumaSize + static_cast<size_t>(row) * dstStride, chromaWidth);
+        }
+        return static_cast<uint32_t>(size);
+    }
+
+    /**
+     * @功能描述: I420转换为RGBA
+     * @参数 [in] src: 源图像
+     * @参数 [out] dst: 输出缓冲
+     * @参数 [in] dstStride: 输出跨距(像素)
+     * @参数 [in] maxLen: 输出缓冲大小
+     * @返回值: 输出数据大小，参数非法或输出缓冲不足时返回0
+     */
+    inline uint32_t ToRgba(const SourceFrame &src, uint8_t *dst, uint32_t dstStride, uint32_t maxLen)
+    {
+        size_t rowBytes = static_cast<size_t>(dstStride) * RGBA_BYTES_PER_PIXEL;
+        size_t size = rowBytes * src.height;
+        if (dst == nullptr || dstStride < src.width || size > maxLen) {
+            return 0;
+        }
+        for (uint32_t row = 0; row < src.height; ++row) {
+            YuvToRgbaRow(src.planes[0] + static_cast<size_t>(row) * src.strides[0],
+                src.planes[1] + static_cast<size_t>(row / 2) * src.strides[1],     // 2: 色度垂直下采样
+                src.planes[2] + static_cast<size_t>(row / 2) * src.strides[2],     // 2: V
+                dst + row * rowBytes, src.width);
+        }
+        return static_cast<uint32_t>(size);
+    }
+}
+
+#endif  // FRAME_CONVERTER_H
@@ -0,0 +1,125 @@
+/*
+ * 功能说明: 日志限频，按调用点统计，每个周期内超出条数的日志被抑制，下一条输出的日志附带被抑制的条数；
+ *           调用点之后不再触发时，被抑制的条数由FlushSuppressed（异步日志后台线程周期调用）或进程退出时输出，
+ *           适用于MediaLog与ALOG*日志宏
+ */
+#ifndef LOG_RATE_LIMITER_H
+#define LOG_RATE_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+class LogRateLimiter {
+public:
+    static constexpr int64_t INTERVAL_MS = 1000;    // 统计周期
+    static constexpr uint32_t BURST = 5;            // 每个周期最多输出条数
+
+    // 输出调用点被抑制的条数，site为调用点的格式字符串
+    using ReportFunc = void (*)(const char *site, uint32_t suppressed);
+
+    constexpr LogRateLimiter() = default;
+
+    constexpr LogRateLimiter(const char *site, ReportFunc report) : m_site(site), m_report(report) {}
+
+    /**
+     * @功能描述: 判断本次日志是否输出
+     * @参数 [out] suppressed: 允许输出时返回上次输出后被抑制的条数
+     * @返回值: true 输出；false 抑制
+     */
+    bool Allow(uint32_t &suppressed)
+    {
+        int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t windowStart = m_windowStart.load(std::memory_order_relaxed);
+        if (nowMs - windowStart >= INTERVAL_MS &&
+            m_windowStart.compare_exchange_strong(windowStart, nowMs, std::memory_order_relaxed)) {
+            m_count.store(0, std::memory_order_relaxed);
+        }
+        if (m_count.fetch_add(1, std::memory_order_relaxed) >= BURST) {
+            (void) m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            Register();
+            return false;
+        }
+        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @功能描述: 输出各调用点尚未随日志输出的被抑制条数
+     * @参数 [in] force: true 输出全部，用于进程退出；false 仅输出统计周期已结束的调用点，
+     *                   仍在持续触发的调用点由其下一条日志附带
+     */
+    static void FlushSuppressed(bool force)
+    {
+        int64_t nowMs = NowMs();
+        for (LogRateLimiter *limiter = Head().load(std::memory_order_acquire); limiter != nullptr;
+            limiter = limiter->m_next) {
+            if (limiter->m_suppressed.load(std::memory_order_relaxed) == 0 ||
+                (!force && nowMs - limiter->m_windowStart.load(std::memory_order_relaxed) < INTERVAL_MS)) {
+                continue;
+            }
+            uint32_t suppressed = limiter->m_suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0 && limiter->m_report != nullptr) {
+                limiter->m_report(limiter->m_site, suppressed);
+            }
+        }
+    }
+
+private:
+    static int64_t NowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 首次抑制日志的调用点加入链表，链表节点为静态对象，只增不减；所在动态库卸载或进程退出时输出剩余条数
+    static std::atomic<LogRateLimiter *> &Head()
+    {
+        static std::atomic<LogRateLimiter *> head {nullptr};
+        return head;
+    }
+
+    void Register()
+    {
+        if (m_report == nullptr || m_registered.exchange(true, std::memory_order_relaxed)) {
+            return;
+        }
+        static const int atExit = std::atexit([]() { FlushSuppressed(true); });
+        (void) atExit;
+        LogRateLimiter *head = Head().load(std::memory_order_relaxed);
+        do {
+            m_next = head;
+        } while (!Head().compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    std::atomic<int64_t> m_windowStart {INT64_MIN / 2};    // 保证首次调用开启新周期
+    std::atomic<uint32_t> m_count {0};
+    std::atomic<uint32_t> m_suppressed {0};
+    const char *m_site = nullptr;
+    ReportFunc m_report = nullptr;
+    std::atomic<bool> m_registered {false};
+    LogRateLimiter *m_next = nullptr;
+};
+
+// 以指定日志宏限频输出，fmt需为字符串字面量；每个调用点独立计数
+#define LOG_RATE_LIMITED(logMacro, fmt, ...)                                                    \
+    do {                                                                                        \
+        static LogRateLimiter logRateLimiter(fmt, [](const char *site, uint32_t suppressed) {   \
+            logMacro("suppressed %u similar messages: %s", suppressed, site);                   \
+        });                                                                                     \
+        uint32_t logSuppressed = 0;                                                             \
+        if (logRateLimiter.Allow(logSuppressed)) {                                              \
+            if (logSuppressed > 0) {                                                            \
+                logMacro(fmt " (suppressed %u similar messages)", ##__VA_ARGS__, logSuppressed); \
+            } else {                                                                            \
+                logMacro(fmt, ##__VA_ARGS__);                                                   \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+#define ALOGW_LIMITED(fmt, ...) LOG_RATE_LIMITED(ALOGW, fmt, ##__VA_ARGS__)
+#define ALOGE_LIMITED(fmt, ...) LOG_RATE_LIMITED(ALOGE, fmt, ##__VA_ARGS__)
+
+#endif  // LOG_RATE_LIMITER_H
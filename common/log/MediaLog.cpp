@@ -6,21 +6,54 @@
 #include <cstring>
 #include <string>
 #include <cstdarg>
+#include "MediaLogAsync.h"
 #include "MediaLogManager.h"
 
+std::atomic<int> g_mediaLogGateLevel {LOG_LEVEL_INFO};
+
 void SetMediaLogCallback(MediaLogCallbackFunc logCallback)
 {
     MediaLogManager::GetInstance().SetLogCallback(logCallback);
 }
 
+void SetMediaLogLevel(int level)
+{
+    MediaLogManager::GetInstance().SetLogLevel(level);
+}
+
+void SetMediaLogTagLevel(const char *tag, int level)
+{
+    MediaLogManager::GetInstance().SetTagLogLevel(tag, level);
+}
+
+void SetMediaLogAsync(bool enable)
+{
+    MediaLogAsync::GetInstance().SetEnable(enable);
+}
+
+uint64_t GetMediaLogDroppedCount()
+{
+    return MediaLogAsync::GetInstance().GetDroppedCount();
+}
+
 void MediaLogPrint(int level, const char *tag, const char *fmt, ...)
 {
     MediaLogManager &logManager = MediaLogManager::GetInstance();
-    if (logManager.IsLogCallbackNull() || level < logManager.GetLogLevel() ||
-        level > LOG_LEVEL_FATAL || fmt == nullptr) {
+    if (logManager.IsLogCallbackNull() || level > LOG_LEVEL_FATAL || fmt == nullptr) {
+        return;
+    }
+    int tagId = logManager.GetTagId(tag);
+    if (level < logManager.GetTagLogLevel(tagId)) {
+        return;
+    }
+    MediaLogAsync &logAsync = MediaLogAsync::GetInstance();
+    if (tagId >= 0 && logAsync.IsEnabled()) {
+        va_list ap;
+        va_start(ap, fmt);
+        logAsync.Push(level, tagId, fmt, ap);
+        va_end(ap);
         return;
     }
-    std::string fullTag = ((tag == nullptr) ? "Media" : ("Media_" + std::string(tag)));
 
     constexpr int logBufSize = 512;
     char logBuf[logBufSize] = {0};
@@ -36,7 +69,11 @@ void MediaLogPrint(int level, const char *tag, const char *fmt, ...)
     if (static_cast<int64_t>(ret) < static_cast<int64_t>(logBufSize)) {
         logBuf[ret] = '\0';
     }
-    if (!logManager.IsLogCallbackNull()) {
-        logManager.Callback(level, fullTag, logBuf);
+    if (tagId >= 0) {
+        logManager.Callback(level, logManager.GetFullTag(tagId), logBuf);
+        return;
     }
+    // 标签登记已满时按原方式拼接完整标签
+    std::string fullTag = ((tag == nullptr) ? "Media" : ("Media_" + std::string(tag)));
+    logManager.Callback(level, fullTag.c_str(), logBuf);
 }
@@ -4,7 +4,15 @@
 #ifndef MEDIA_LOG_H
 #define MEDIA_LOG_H
 
+#include <atomic>
+#include <cstdint>
 #include "MediaLogDefs.h"
+#include "LogRateLimiter.h"
+
+// 编译期最低日志级别（MediaLogLevel取值），低于该级别的日志宏不生成代码
+#ifndef MEDIA_LOG_MIN_LEVEL
+#define MEDIA_LOG_MIN_LEVEL 0
+#endif
 
 #ifndef LOG_TAG
 #define LOG_TAG "Media"
@@ -26,11 +34,52 @@
 #endif
 
 /**
- * @功能描述: 设置日志回调函数，注意该接口不支持多线程调用
+ * @功能描述: 设置日志回调函数，注意该接口不支持多线程调用；开启异步日志时回调在异步日志的后台线程中执行
  * @参数 [in] logCallback: 日志回调函数
  */
 void SetMediaLogCallback(MediaLogCallbackFunc logCallback);
 
+// 运行期日志门限：全局级别与各标签级别中的最低值，未设置回调时高于FATAL，由MediaLogManager维护
+extern std::atomic<int> g_mediaLogGateLevel;
+
+/**
+ * @功能描述: 判断日志级别是否可能输出，日志宏在求值参数前调用
+ * @参数 [in] level: 日志级别
+ * @返回值: true 可能输出，需进一步按标签判断；false 不输出
+ */
+inline bool IsMediaLogLevelEnabled(int level)
+{
+    return level >= g_mediaLogGateLevel.load(std::memory_order_relaxed);
+}
+
+/**
+ * @功能描述: 设置全局日志级别，未单独设置级别的标签按该级别过滤
+ * @参数 [in] level: 日志级别
+ */
+void SetMediaLogLevel(int level);
+
+/**
+ * @功能描述: 设置指定标签的日志级别，优先于全局日志级别
+ * @参数 [in] tag: 日志标签，与LOG_TAG一致，不含Media_前缀；标签内容另存一份，可传入临时字符串
+ * @参数 [in] level: 日志级别，小于0时恢复按全局级别过滤
+ */
+void SetMediaLogTagLevel(const char *tag, int level);
+
+/**
+ * @功能描述: 开启或关闭异步日志。开启后日志写入调用线程的环形缓冲，由后台线程调用日志回调，
+ *           缓冲满时丢弃日志，调用线程不阻塞；关闭时输出已缓冲的日志后返回，进程退出时同样输出。
+ *           开启期间日志回调在后台线程中执行，不能依赖打印日志线程的线程局部状态；
+ *           回调阻塞时各线程的缓冲随之填满，之后的日志被丢弃并计数
+ * @参数 [in] enable: true 开启；false 关闭
+ */
+void SetMediaLogAsync(bool enable);
+
+/**
+ * @功能描述: 获取异步日志累计丢弃的条数
+ * @返回值: 丢弃条数
+ */
+uint64_t GetMediaLogDroppedCount();
+
 /**
  * @功能描述: 日志打印公共实现接口，供宏函数DBG/INFO/WARN/ERR/FATAL调用
  * @参数 [in] level: 日志级别
@@ -40,10 +89,29 @@ void SetMediaLogCallback(MediaLogCallbackFunc logCallback);
  */
 void MediaLogPrint(int level, const char *tag, const char *fmt, ...) __attribute__((format (printf, 3, 4)));
 
-#define DBG(fmt, ...) MediaLogPrint(LOG_LEVEL_DEBUG, LOG_TAG, fmt, ##__VA_ARGS__)
-#define INFO(fmt, ...) MediaLogPrint(LOG_LEVEL_INFO, LOG_TAG, fmt, ##__VA_ARGS__)
-#define WARN(fmt, ...) MediaLogPrint(LOG_LEVEL_WARN, LOG_TAG, fmt, ##__VA_ARGS__)
-#define ERR(fmt, ...) MediaLogPrint(LOG_LEVEL_ERROR, LOG_TAG, fmt, ##__VA_ARGS__)
-#define FATAL(fmt, ...) MediaLogPrint(LOG_LEVEL_FATAL, LOG_TAG, fmt, ##__VA_ARGS__)
+#define MEDIA_LOG_PRINT(level, fmt, ...)                                                \
+    do {                                                                                \
+        if ((level) >= MEDIA_LOG_MIN_LEVEL && IsMediaLogLevelEnabled(level)) {          \
+            MediaLogPrint(level, LOG_TAG, fmt, ##__VA_ARGS__);                          \
+        }                                                                               \
+    } while (0)
+
+#define DBG(fmt, ...) MEDIA_LOG_PRINT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define INFO(fmt, ...) MEDIA_LOG_PRINT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define WARN(fmt, ...) MEDIA_LOG_PRINT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define ERR(fmt, ...) MEDIA_LOG_PRINT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define FATAL(fmt, ...) MEDIA_LOG_PRINT(LOG_LEVEL_FATAL, fmt, ##__VA_ARGS__)
+
+// 限频版本，用于逐帧路径上可能持续触发的日志，见LogRateLimiter.h
+#define MEDIA_LOG_LIMITED(level, logMacro, fmt, ...)                                    \
+    do {                                                                                \
+        if ((level) >= MEDIA_LOG_MIN_LEVEL && IsMediaLogLevelEnabled(level)) {          \
+            LOG_RATE_LIMITED(logMacro, fmt, ##__VA_ARGS__);                             \
+        }                                                                               \
+    } while (0)
+
+#define INFO_LIMITED(fmt, ...) MEDIA_LOG_LIMITED(LOG_LEVEL_INFO, INFO, fmt, ##__VA_ARGS__)
+#define WARN_LIMITED(fmt, ...) MEDIA_LOG_LIMITED(LOG_LEVEL_WARN, WARN, fmt, ##__VA_ARGS__)
+#define ERR_LIMITED(fmt, ...) MEDIA_LOG_LIMITED(LOG_LEVEL_ERROR, ERR, fmt, ##__VA_ARGS__)
 
 #endif  // MEDIA_LOG_H
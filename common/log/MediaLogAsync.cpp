@@ -0,0 +1,196 @@
+/*
+ * 功能说明: 媒体日志异步输出模块
+ */
+
+#include "MediaLogAsync.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "LogRateLimiter.h"
+#include "MediaLogManager.h"
+
+namespace {
+    constexpr std::chrono::milliseconds WRITER_INTERVAL(5);
+    const char *const ASYNC_LOG_TAG = "MediaLogAsync";
+
+    long CurrentTid()
+    {
+#ifdef SYS_gettid
+        return syscall(SYS_gettid);
+#else
+        return 0;
+#endif
+    }
+}
+
+MediaLogAsync& MediaLogAsync::GetInstance()
+{
+    static MediaLogAsync logAsync;
+    return logAsync;
+}
+
+MediaLogAsync::MediaLogAsync()
+{
+    // 先于本对象构造日志管理对象，使其在进程退出时晚于本对象析构，析构时输出的剩余日志仍可交给日志回调
+    (void) MediaLogManager::GetInstance();
+}
+
+MediaLogAsync::~MediaLogAsync()
+{
+    SetEnable(false);
+}
+
+MediaLogAsync::ThreadRing::~ThreadRing()
+{
+    if (ring != nullptr) {
+        ring->closed.store(true, std::memory_order_release);
+    }
+}
+
+void MediaLogAsync::SetEnable(bool enable)
+{
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    if (enable == m_writerRunning) {
+        return;
+    }
+    if (enable) {
+        m_writerRunning = true;
+        m_writer = std::thread(&MediaLogAsync::WriterLoop, this);
+        m_enabled.store(true, std::memory_order_release);
+        return;
+    }
+    m_enabled.store(false, std::memory_order_release);
+    m_writerRunning = false;
+    lock.unlock();
+    m_writerCond.notify_all();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+bool MediaLogAsync::IsEnabled() const
+{
+    return m_enabled.load(std::memory_order_acquire);
+}
+
+MediaLogAsync::Ring *MediaLogAsync::GetThreadRing()
+{
+    thread_local ThreadRing threadRing;
+    if (threadRing.ring != nullptr) {
+        return threadRing.ring.get();
+    }
+    // 缓冲数达到上限后不再每条日志加锁重试，直到有线程退出、缓冲被回收
+    uint64_t generation = m_ringGeneration.load(std::memory_order_acquire);
+    if (threadRing.denied && threadRing.deniedGeneration == generation) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_ringMutex);
+    if (m_rings.size() >= RING_NUM_MAX) {
+        threadRing.denied = true;
+        threadRing.deniedGeneration = generation;
+        return nullptr;
+    }
+    auto ring = std::make_shared<Ring>();
+    ring->tid = CurrentTid();
+    m_rings.push_back(ring);
+    threadRing.ring = ring;
+    threadRing.denied = false;
+    return ring.get();
+}
+
+void MediaLogAsync::Push(int level, int tagId, const char *fmt, va_list ap)
+{
+    Ring *ring = GetThreadRing();
+    if (ring == nullptr) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= RING_SLOT_NUM) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record &record = ring->records[head % RING_SLOT_NUM];
+    int ret = vsnprintf(record.logData, LOG_BUF_SIZE, fmt, ap);
+    if (ret <= 0) {
+        return;
+    }
+    record.level = level;
+    record.tagId = tagId;
+    record.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t MediaLogAsync::GetDroppedCount() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+bool MediaLogAsync::DrainRings()
+{
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(m_ringMutex);
+        rings = m_rings;
+    }
+    MediaLogManager &logManager = MediaLogManager::GetInstance();
+    bool drained = false;
+    for (auto &ring : rings) {
+        // 先读取关闭标志，保证关闭前写入的日志均已可见
+        bool closed = ring->closed.load(std::memory_order_acquire);
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Record &record = ring->records[tail % RING_SLOT_NUM];
+            logManager.Output(record.level, record.tagId, record.logData, ring->tid, record.timeUs);
+            ring->tail.store(tail + 1, std::memory_order_release);
+            drained = true;
+        }
+        if (closed) {
+            std::lock_guard<std::mutex> lock(m_ringMutex);
+            m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), ring), m_rings.end());
+            m_ringGeneration.fetch_add(1, std::memory_order_release);
+        }
+    }
+    return drained;
+}
+
+void MediaLogAsync::ReportDropped()
+{
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped == m_droppedReported) {
+        return;
+    }
+    constexpr int reportBufSize = 64;
+    char reportBuf[reportBufSize] = {0};
+    (void) snprintf(reportBuf, reportBufSize, "%llu logs dropped, total %llu",
+        static_cast<unsigned long long>(dropped - m_droppedReported), static_cast<unsigned long long>(dropped));
+    m_droppedReported = dropped;
+    MediaLogManager &logManager = MediaLogManager::GetInstance();
+    int tagId = logManager.GetTagId(ASYNC_LOG_TAG);
+    int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    logManager.Output(LOG_LEVEL_WARN, tagId, reportBuf, CurrentTid(), nowUs);
+}
+
+void MediaLogAsync::WriterLoop()
+{
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    while (m_writerRunning) {
+        lock.unlock();
+        bool drained = DrainRings();
+        ReportDropped();
+        // 限频日志调用点不再触发时，由后台线程输出其被抑制的条数
+        LogRateLimiter::FlushSuppressed(false);
+        lock.lock();
+        if (!drained) {
+            (void) m_writerCond.wait_for(lock, WRITER_INTERVAL);
+        }
+    }
+    lock.unlock();
+    (void) DrainRings();
+    ReportDropped();
+}
@@ -0,0 +1,105 @@
+/*
+ * 功能说明: 媒体日志异步输出模块，日志线程各自写入无锁环形缓冲，后台线程统一格式化时间戳并调用日志回调，
+ *           缓冲满时丢弃日志并计数，日志线程不因输出而阻塞
+ */
+#ifndef MEDIA_LOG_ASYNC_H
+#define MEDIA_LOG_ASYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MediaLogAsync {
+public:
+    static constexpr uint32_t LOG_BUF_SIZE = 512;   // 单条日志最大长度，与同步输出一致
+    static constexpr uint32_t RING_SLOT_NUM = 128;  // 每个线程的缓冲条数
+    static constexpr uint32_t RING_NUM_MAX = 32;    // 最多同时缓冲日志的线程数
+
+    /**
+     * @功能描述: 获取MediaLogAsync单例对象
+     * @返回值: 返回值MediaLogAsync单例对象引用
+     */
+    static MediaLogAsync& GetInstance();
+
+    /**
+     * @功能描述: 开启或关闭异步输出，关闭时等待后台线程输出已缓冲的日志
+     * @参数 [in] enable: true 开启；false 关闭
+     */
+    void SetEnable(bool enable);
+
+    /**
+     * @功能描述: 判断是否开启异步输出
+     * @返回值: true 已开启；false 未开启
+     */
+    bool IsEnabled() const;
+
+    /**
+     * @功能描述: 格式化一条日志写入当前线程的缓冲，缓冲满或线程数超限时丢弃
+     * @参数 [in] level: 日志级别
+     * @参数 [in] tagId: 日志标签编号，见MediaLogManager::GetTagId
+     * @参数 [in] fmt: 格式化字符串
+     * @参数 [in] ap: 附加参数
+     */
+    void Push(int level, int tagId, const char *fmt, va_list ap);
+
+    /**
+     * @功能描述: 获取累计丢弃的日志条数
+     * @返回值: 丢弃条数
+     */
+    uint64_t GetDroppedCount() const;
+
+private:
+    struct Record {
+        int level = 0;
+        int tagId = 0;
+        int64_t timeUs = 0;
+        char logData[LOG_BUF_SIZE] = {0};
+    };
+
+    // 单生产者单消费者环形缓冲，生产者为日志线程，消费者为后台线程
+    struct Ring {
+        alignas(64) std::atomic<uint32_t> head {0};     // 64: 缓存行大小，生产者写入位置
+        alignas(64) std::atomic<uint32_t> tail {0};     // 消费者读取位置
+        std::atomic<bool> closed {false};               // 日志线程已退出
+        long tid = 0;
+        Record records[RING_SLOT_NUM];
+    };
+
+    // 线程退出时标记缓冲关闭，由后台线程输出剩余日志后回收
+    struct ThreadRing {
+        std::shared_ptr<Ring> ring = nullptr;
+        bool denied = false;            // 缓冲数已达上限，未分配缓冲
+        uint64_t deniedGeneration = 0;  // 未分配缓冲时的回收代数，有缓冲被回收后才重新申请
+        ~ThreadRing();
+    };
+
+    MediaLogAsync();
+    ~MediaLogAsync();
+    MediaLogAsync(const MediaLogAsync&) = delete;
+    MediaLogAsync& operator=(const MediaLogAsync&) = delete;
+    MediaLogAsync(MediaLogAsync &&) = delete;
+    MediaLogAsync& operator=(MediaLogAsync &&) = delete;
+
+    Ring *GetThreadRing();
+    void WriterLoop();
+    bool DrainRings();
+    void ReportDropped();
+
+    std::atomic<bool> m_enabled {false};
+    std::atomic<uint64_t> m_dropped {0};
+    std::atomic<uint64_t> m_ringGeneration {0};    // 已回收的缓冲数
+    uint64_t m_droppedReported = 0;
+    std::mutex m_ringMutex;
+    std::vector<std::shared_ptr<Ring>> m_rings {};
+    std::mutex m_writerMutex;
+    std::condition_variable m_writerCond;
+    bool m_writerRunning = false;
+    std::thread m_writer;
+};
+
+#endif  // MEDIA_LOG_ASYNC_H
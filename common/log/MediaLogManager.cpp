@@ -3,7 +3,11 @@
  */
 
 #include "MediaLogManager.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <unordered_map>
+#include "MediaLog.h"
 #ifdef __ANDROID__
 #include <android/log.h>
 #else
@@ -38,32 +42,50 @@ namespace {
         { LOG_LEVEL_FATAL, "F" },
     };
     constexpr uint32_t TIME_LENGTH = 128;
+    constexpr int64_t US_PER_MS = 1000;
+    constexpr int64_t MS_PER_SECOND = 1000;
 }
 #endif
 
+namespace {
+    const char *const DEFAULT_TAG = "Media";
+    const char *const TAG_PREFIX = "Media_";
+
+    void WriteDefaultLog(int level, const char *tag, const char *fmt, long tid, int64_t timeUs)
+    {
+#ifdef __ANDROID__
+        (void) tid;
+        (void) timeUs;
+        (void) __android_log_write(g_logLevelMap[level], tag, fmt);
+#else
+        time_t nowTime = static_cast<time_t>(timeUs / US_PER_MS / MS_PER_SECOND);
+        struct tm localTime = {};
+        if (localtime_r(&nowTime, &localTime) == nullptr) {
+            printf("localtime get failed");
+            return;
+        }
+        char timeStampBuf[TIME_LENGTH] = {0};
+        int err = snprintf(timeStampBuf, TIME_LENGTH, "[%02d-%02d %02d:%02d:%02d.%03ld]",
+            localTime.tm_mon + 1, localTime.tm_mday, localTime.tm_hour, localTime.tm_min, localTime.tm_sec,
+            static_cast<long>(timeUs / US_PER_MS % MS_PER_SECOND));
+        if (err < 0) {
+            printf("sprintf failed: %d", err);
+            return;
+        }
+        printf("%s %d %ld %s %s: %s\n",
+            timeStampBuf, getpid(), tid, g_logLevelMap[level].c_str(), tag, fmt);
+#endif
+    }
+}
+
 void DefaultLogCallback(int level, const char *tag, const char *fmt)
 {
 #ifdef __ANDROID__
-    (void) __android_log_write(g_logLevelMap[level], tag, fmt);
+    WriteDefaultLog(level, tag, fmt, 0, 0);
 #else
-    auto nowTimePoint = std::chrono::system_clock::now();
-    auto nowTimeMs = std::chrono::time_point_cast<std::chrono::microseconds>(nowTimePoint);
-    time_t nowTime = std::chrono::system_clock::to_time_t(nowTimePoint);
-    struct tm *time = localtime(&nowTime);
-    if (time == nullptr) {
-        printf("localtime get failed");
-        return;
-    }
-    char timeStampBuf[TIME_LENGTH] = {0};
-    int err = sprintf(timeStampBuf, "[%02d-%02d %02d:%02d:%02d.%03ld]",
-        ++(time->tm_mon), time->tm_mday, time->tm_hour, time->tm_min, time->tm_sec,
-        nowTimeMs.time_since_epoch().count() % 1000);
-    if (err < 0) {
-        printf("sprintf failed: %d", err);
-        return;
-    }
-    printf("%s %d %ld %s %s: %s\n",
-        timeStampBuf, getpid(), GetTid(), g_logLevelMap[level].c_str(), tag, fmt);
+    int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    WriteDefaultLog(level, tag, fmt, GetTid(), nowUs);
 #endif
 }
 
@@ -78,7 +100,9 @@ MediaLogManager::MediaLogManager() : m_logCallback(DefaultLogCallback) {}
 void MediaLogManager::SetLogCallback(MediaLogCallbackFunc logCallback)
 {
     m_logCallback = logCallback;
-    m_logLevel = LOG_LEVEL_DEBUG;
+    m_logLevel.store(LOG_LEVEL_DEBUG, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_tagMutex);
+    UpdateGateLevel();
 }
 
 bool MediaLogManager::IsLogCallbackNull() const
@@ -86,14 +110,122 @@ bool MediaLogManager::IsLogCallbackNull() const
     return m_logCallback == nullptr;
 }
 
-void MediaLogManager::Callback(int level, const std::string &tag, const std::string &logData) const
+int MediaLogManager::FindTagId(const char *tag) const
+{
+    int tagNum = m_tagNum.load(std::memory_order_acquire);
+    for (int i = 0; i < tagNum; ++i) {
+        const TagEntry &entry = m_tags[i];
+        bool same = (tag == nullptr) ? entry.isDefault : (entry.key.load(std::memory_order_acquire) == tag);
+        if (same) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int MediaLogManager::GetTagId(const char *tag, bool stableKey)
+{
+    // 已登记的标签按地址匹配，不加锁
+    int tagId = FindTagId(tag);
+    if (tagId >= 0) {
+        return tagId;
+    }
+    std::lock_guard<std::mutex> lock(m_tagMutex);
+    int tagNum = m_tagNum.load(std::memory_order_relaxed);
+    for (int i = 0; i < tagNum; ++i) {
+        TagEntry &entry = m_tags[i];
+        bool same = (tag == nullptr) ? entry.isDefault : (!entry.isDefault && strcmp(entry.tag, tag) == 0);
+        if (!same) {
+            continue;
+        }
+        // 按属性设置级别时登记的标签没有长期有效的地址，由之后首个LOG_TAG地址填入
+        if (stableKey && tag != nullptr && entry.key.load(std::memory_order_relaxed) == nullptr) {
+            entry.key.store(tag, std::memory_order_release);
+        }
+        return i;
+    }
+    if (tagNum >= TAG_NUM_MAX || (tag != nullptr && strlen(TAG_PREFIX) + strlen(tag) >= TAG_LEN_MAX)) {
+        return -1;
+    }
+    TagEntry &entry = m_tags[tagNum];
+    entry.key.store(stableKey ? tag : nullptr, std::memory_order_relaxed);
+    entry.isDefault = (tag == nullptr);
+    if (tag == nullptr) {
+        (void) snprintf(entry.fullTag, TAG_LEN_MAX, "%s", DEFAULT_TAG);
+    } else {
+        (void) snprintf(entry.tag, TAG_LEN_MAX, "%s", tag);
+        (void) snprintf(entry.fullTag, TAG_LEN_MAX, "%s%s", TAG_PREFIX, tag);
+    }
+    m_tagNum.store(tagNum + 1, std::memory_order_release);
+    return tagNum;
+}
+
+void MediaLogManager::Callback(int level, const char *tag, const char *logData) const
 {
     if (m_logCallback != nullptr) {
-        m_logCallback(level, tag.c_str(), logData.c_str());
+        m_logCallback(level, tag, logData);
+    }
+}
+
+const char *MediaLogManager::GetFullTag(int tagId) const
+{
+    return (tagId >= 0 && tagId < m_tagNum.load(std::memory_order_acquire)) ? m_tags[tagId].fullTag : DEFAULT_TAG;
+}
+
+void MediaLogManager::Output(int level, int tagId, const char *logData, long tid, int64_t timeUs) const
+{
+    const char *tag = GetFullTag(tagId);
+    if (m_logCallback == DefaultLogCallback) {
+        WriteDefaultLog(level, tag, logData, tid, timeUs);
+    } else if (m_logCallback != nullptr) {
+        m_logCallback(level, tag, logData);
     }
 }
 
 MediaLogLevel MediaLogManager::GetLogLevel() const
 {
-    return m_logLevel;
+    return static_cast<MediaLogLevel>(m_logLevel.load(std::memory_order_relaxed));
+}
+
+void MediaLogManager::SetLogLevel(int level)
+{
+    m_logLevel.store(std::min(std::max(level, static_cast<int>(LOG_LEVEL_DEBUG)), static_cast<int>(LOG_LEVEL_FATAL)),
+        std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_tagMutex);
+    UpdateGateLevel();
+}
+
+void MediaLogManager::SetTagLogLevel(const char *tag, int level)
+{
+    // 标签常来自解析属性得到的临时字符串，不记录其地址
+    int tagId = GetTagId(tag, false);
+    if (tagId < 0) {
+        return;
+    }
+    m_tags[tagId].level.store((level < 0) ? -1 : std::min(level, static_cast<int>(LOG_LEVEL_FATAL)),
+        std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_tagMutex);
+    UpdateGateLevel();
+}
+
+int MediaLogManager::GetTagLogLevel(int tagId) const
+{
+    int level = (tagId >= 0 && tagId < m_tagNum.load(std::memory_order_acquire)) ?
+        m_tags[tagId].level.load(std::memory_order_relaxed) : -1;
+    return (level >= 0) ? level : m_logLevel.load(std::memory_order_relaxed);
+}
+
+void MediaLogManager::UpdateGateLevel()
+{
+    // 日志宏按全局级别与各标签级别的最低值预先过滤，其余由MediaLogPrint按标签过滤
+    int gateLevel = m_logLevel.load(std::memory_order_relaxed);
+    int tagNum = m_tagNum.load(std::memory_order_relaxed);
+    for (int i = 0; i < tagNum; ++i) {
+        int level = m_tags[i].level.load(std::memory_order_relaxed);
+        gateLevel = (level >= 0) ? std::min(gateLevel, level) : gateLevel;
+    }
+    if (m_logCallback == nullptr) {
+        gateLevel = LOG_LEVEL_FATAL + 1;
+    }
+    g_mediaLogGateLevel.store(gateLevel, std::memory_order_relaxed);
 }
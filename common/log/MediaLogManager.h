@@ -4,6 +4,10 @@
 #ifndef MEDIA_LOG_MANAGER_H
 #define MEDIA_LOG_MANAGER_H
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include "MediaLogDefs.h"
 
@@ -28,13 +32,46 @@ public:
      */
     bool IsLogCallbackNull() const;
 
+    /**
+     * @功能描述: 获取日志标签编号，首次使用的标签登记完整标签（Media_前缀），之后不再构造字符串
+     * @参数 [in] tag: 日志标签，为空时使用Media
+     * @参数 [in] stableKey: 标签地址在进程内长期有效（如LOG_TAG常量）时为true，记录该地址用于快速匹配；
+     *                       临时字符串为false，标签内容另存一份，由之后首个长期有效的地址填入快速匹配
+     * @返回值: 标签编号，登记数量已满时返回-1
+     */
+    int GetTagId(const char *tag, bool stableKey = true);
+
+    /**
+     * @功能描述: 按标签地址查找已登记的标签编号，不加锁
+     * @参数 [in] tag: 日志标签
+     * @返回值: 标签编号，该地址未用于快速匹配时返回-1
+     */
+    int FindTagId(const char *tag) const;
+
+    /**
+     * @功能描述: 获取标签编号对应的完整标签
+     * @参数 [in] tagId: 标签编号
+     * @返回值: 完整标签，编号无效时返回Media
+     */
+    const char *GetFullTag(int tagId) const;
+
     /**
      * @功能描述: 调用回调函数
      * @参数 [in] level: 日志级别
-     * @参数 [in] tag: 日志标签
+     * @参数 [in] tag: 完整日志标签
      * @参数 [in] logData: 格式化输出数据
      */
-    void Callback(int level, const std::string &tag, const std::string &logData) const;
+    void Callback(int level, const char *tag, const char *logData) const;
+
+    /**
+     * @功能描述: 输出一条异步缓冲的日志，使用默认回调时按日志线程号与记录时间输出
+     * @参数 [in] level: 日志级别
+     * @参数 [in] tagId: 日志标签编号
+     * @参数 [in] logData: 格式化输出数据
+     * @参数 [in] tid: 记录日志的线程号
+     * @参数 [in] timeUs: 记录日志的系统时间(us)
+     */
+    void Output(int level, int tagId, const char *logData, long tid, int64_t timeUs) const;
 
     /**
      * @功能描述: 获取日志级别
@@ -42,6 +79,26 @@ public:
      */
     MediaLogLevel GetLogLevel() const;
 
+    /**
+     * @功能描述: 设置全局日志级别
+     * @参数 [in] level: 日志级别，超出范围时取最近的有效级别
+     */
+    void SetLogLevel(int level);
+
+    /**
+     * @功能描述: 设置指定标签的日志级别
+     * @参数 [in] tag: 日志标签
+     * @参数 [in] level: 日志级别，小于0时恢复按全局级别过滤
+     */
+    void SetTagLogLevel(const char *tag, int level);
+
+    /**
+     * @功能描述: 获取标签生效的日志级别
+     * @参数 [in] tagId: 标签编号，无效时返回全局日志级别
+     * @返回值: 日志级别
+     */
+    int GetTagLogLevel(int tagId) const;
+
 private:
     MediaLogManager();
     ~MediaLogManager() = default;
@@ -50,8 +107,24 @@ private:
     MediaLogManager(MediaLogManager &&) = delete;
     MediaLogManager& operator=(MediaLogManager &&) = delete;
 
+    static constexpr int TAG_NUM_MAX = 64;
+    static constexpr uint32_t TAG_LEN_MAX = 64;
+
+    struct TagEntry {
+        std::atomic<const char *> key {nullptr};    // 长期有效的标签地址，用于快速匹配
+        bool isDefault = false;                 // 标签为空时使用的Media标签
+        char tag[TAG_LEN_MAX] = {0};            // 原始标签
+        char fullTag[TAG_LEN_MAX] = {0};        // 完整标签
+        std::atomic<int> level {-1};            // 标签日志级别，小于0表示按全局级别
+    };
+
+    void UpdateGateLevel();
+
     MediaLogCallbackFunc m_logCallback = nullptr;
-    MediaLogLevel m_logLevel = LOG_LEVEL_INFO;
+    std::atomic<int> m_logLevel {LOG_LEVEL_INFO};
+    std::array<TagEntry, TAG_NUM_MAX> m_tags {};
+    std::atomic<int> m_tagNum {0};
+    std::mutex m_tagMutex;
 };
 
 #endif  // MEDIA_LOG_MANAGER_H
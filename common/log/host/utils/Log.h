@@ -0,0 +1,22 @@
+/*
+ * 功能说明: 主机Linux构建使用的ALOG日志宏，与Android <utils/Log.h>保持一致，输出到标准错误
+ */
+#ifndef HOST_UTILS_LOG_H
+#define HOST_UTILS_LOG_H
+
+#include <cstdio>
+
+#ifndef LOG_TAG
+#define LOG_TAG ""
+#endif
+
+#define HOST_ALOG(level, fmt, ...) \
+    fprintf(stderr, "%s %s: " fmt "\n", level, LOG_TAG, ##__VA_ARGS__)
+
+#define ALOGV(fmt, ...) HOST_ALOG("V", fmt, ##__VA_ARGS__)
+#define ALOGD(fmt, ...) HOST_ALOG("D", fmt, ##__VA_ARGS__)
+#define ALOGI(fmt, ...) HOST_ALOG("I", fmt, ##__VA_ARGS__)
+#define ALOGW(fmt, ...) HOST_ALOG("W", fmt, ##__VA_ARGS__)
+#define ALOGE(fmt, ...) HOST_ALOG("E", fmt, ##__VA_ARGS__)
+
+#endif  // HOST_UTILS_LOG_H
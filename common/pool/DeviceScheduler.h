@@ -0,0 +1,161 @@
+/*
+ * 功能说明: 多卡设备调度策略，按帧率 × 分辨率估算各卡负载，为新会话选卡并判断已有会话是否需要迁移，
+ *           设备信息的采集与负载发布由各编解码器通过对应的NETINT资源接口完成
+ */
+#ifndef DEVICE_SCHEDULER_H
+#define DEVICE_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// 单卡负载信息
+struct DeviceLoad {
+    int guid = -1;
+    uint32_t loadPercent = 0;   // 当前负载(%)，取设备上报负载与模型负载的较大值
+    int instances = 0;          // 当前实例数
+    int maxInstances = 0;       // 最大实例数，0表示不限制
+    uint64_t capacity = 0;      // 处理能力(像素/秒)
+};
+
+enum class PlacementPolicy {
+    LEAST_LOAD,      // 选择加入会话后负载最低的卡
+    LEAST_INSTANCE,  // 选择实例数最少的卡
+    PACK             // 优先填满负载较高但仍可容纳的卡，空出其他卡
+};
+
+namespace DeviceScheduler {
+    constexpr uint32_t LOAD_FULL = 100;
+    constexpr uint64_t PIXELS_1080P = 1920 * 1080;
+
+    /**
+     * @功能描述: 解析调度策略配置
+     * @参数 [in] value: 配置值，least_load/least_instance/pack
+     * @参数 [in] defaultPolicy: 未配置或配置非法时使用的策略
+     * @返回值: 调度策略
+     */
+    inline PlacementPolicy ParsePolicy(const std::string &value,
+        PlacementPolicy defaultPolicy = PlacementPolicy::LEAST_LOAD)
+    {
+        if (value == "least_load") {
+            return PlacementPolicy::LEAST_LOAD;
+        }
+        if (value == "least_instance") {
+            return PlacementPolicy::LEAST_INSTANCE;
+        }
+        if (value == "pack") {
+            return PlacementPolicy::PACK;
+        }
+        return defaultPolicy;
+    }
+
+    /**
+     * @功能描述: 根据1080p最大帧率计算设备处理能力
+     * @参数 [in] maxFps1080p: 设备1080p最大帧率
+     * @返回值: 处理能力(像素/秒)
+     */
+    inline uint64_t Capacity(int maxFps1080p)
+    {
+        return (maxFps1080p > 0) ? PIXELS_1080P * static_cast<uint64_t>(maxFps1080p) : 0;
+    }
+
+    /**
+     * @功能描述: 计算会话在设备上产生的负载
+     * @参数 [in] device: 设备
+     * @参数 [in] pixelRate: 会话像素率(宽 × 高 × 帧率)
+     * @返回值: 会话负载(%)，设备处理能力未知时为0
+     */
+    inline uint32_t SessionLoad(const DeviceLoad &device, uint64_t pixelRate)
+    {
+        if (device.capacity == 0) {
+            return 0;
+        }
+        uint64_t load = (pixelRate * LOAD_FULL + device.capacity - 1) / device.capacity;
+        return static_cast<uint32_t>(std::min<uint64_t>(load, LOAD_FULL));
+    }
+
+    /**
+     * @功能描述: 判断设备能否容纳会话
+     */
+    inline bool Fits(const DeviceLoad &device, uint64_t pixelRate)
+    {
+        bool instanceFits = (device.maxInstances <= 0) || (device.instances < device.maxInstances);
+        return instanceFits && device.loadPercent + SessionLoad(device, pixelRate) <= LOAD_FULL;
+    }
+
+    /**
+     * @功能描述: 按调度策略为会话选卡
+     * @参数 [in] devices: 各卡负载
+     * @参数 [in] pixelRate: 会话像素率
+     * @参数 [in] policy: 调度策略
+     * @返回值: 选中设备的guid，无可用设备时返回-1；所有设备均已满载时选择负载最低的设备
+     */
+    inline int Select(const std::vector<DeviceLoad> &devices, uint64_t pixelRate, PlacementPolicy policy)
+    {
+        const DeviceLoad *best = nullptr;
+        const DeviceLoad *leastLoaded = nullptr;
+        for (const auto &device : devices) {
+            uint32_t after = device.loadPercent + SessionLoad(device, pixelRate);
+            if (leastLoaded == nullptr || after < leastLoaded->loadPercent + SessionLoad(*leastLoaded, pixelRate)) {
+                leastLoaded = &device;
+            }
+            if (!Fits(device, pixelRate)) {
+                continue;
+            }
+            bool better = (best == nullptr);
+            if (!better && policy == PlacementPolicy::LEAST_INSTANCE) {
+                better = device.instances < best->instances;
+            } else if (!better && policy == PlacementPolicy::PACK) {
+                better = device.loadPercent > best->loadPercent;
+            } else if (!better) {
+                better = after < best->loadPercent + SessionLoad(*best, pixelRate);
+            }
+            if (better) {
+                best = &device;
+            }
+        }
+        if (best == nullptr) {
+            best = leastLoaded;
+        }
+        return (best != nullptr) ? best->guid : -1;
+    }
+
+    /**
+     * @功能描述: 判断会话是否应从当前设备迁出：当前设备与负载最低设备的负载差超过阈值，
+     *            且迁移后目标设备负载仍低于当前设备
+     * @参数 [in] devices: 各卡负载，当前设备负载中已包含该会话
+     * @参数 [in] currentGuid: 会话所在设备
+     * @参数 [in] pixelRate: 会话像素率
+     * @参数 [in] thresholdPercent: 负载差阈值(%)，为0时不迁移
+     * @返回值: 目标设备guid，无需迁移时返回-1
+     */
+    inline int MigrationTarget(const std::vector<DeviceLoad> &devices, int currentGuid, uint64_t pixelRate,
+        uint32_t thresholdPercent)
+    {
+        if (thresholdPercent == 0) {
+            return -1;
+        }
+        auto current = std::find_if(devices.begin(), devices.end(),
+            [currentGuid](const DeviceLoad &device) { return device.guid == currentGuid; });
+        if (current == devices.end()) {
+            return -1;
+        }
+        const DeviceLoad *target = nullptr;
+        for (const auto &device : devices) {
+            if (device.guid == currentGuid || !Fits(device, pixelRate)) {
+                continue;
+            }
+            if (target == nullptr || device.loadPercent < target->loadPercent) {
+                target = &device;
+            }
+        }
+        if (target == nullptr || current->loadPercent < target->loadPercent + thresholdPercent ||
+            target->loadPercent + SessionLoad(*target, pixelRate) >= current->loadPercent) {
+            return -1;
+        }
+        return target->guid;
+    }
+}
+
+#endif  // DEVICE_SCHEDULER_H
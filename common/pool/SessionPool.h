@@ -0,0 +1,228 @@
+/*
+ * 功能说明: 进程级硬件编解码会话池，缓存已打开的设备句柄与会话，按键（编解码类型与分辨率档位等）取用，
+ *           并可在后台线程中预热会话，减少会话初始化与重置时的打开耗时
+ */
+#ifndef SESSION_POOL_H
+#define SESSION_POOL_H
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <utility>
+#include <cstdint>
+
+template <typename Session>
+class SessionPool {
+public:
+    using SessionPtr = std::unique_ptr<Session>;
+    using Opener = std::function<SessionPtr()>;
+    using Closer = std::function<void(Session &)>;
+
+    /**
+     * @功能描述: 构造函数
+     * @参数 [in] closer: 关闭会话的函数，淘汰或清空会话池时调用
+     */
+    explicit SessionPool(Closer closer) : m_closer(std::move(closer)) {}
+
+    /**
+     * @功能描述: 析构函数，停止预热线程并关闭所有空闲会话
+     */
+    ~SessionPool()
+    {
+        Drain();
+    }
+
+    SessionPool(const SessionPool &) = delete;
+    SessionPool &operator=(const SessionPool &) = delete;
+
+    /**
+     * @功能描述: 设置空闲会话数量上限，为0时不缓存会话，超出上限的空闲会话被关闭
+     * @参数 [in] capacity: 空闲会话数量上限
+     */
+    void SetCapacity(uint32_t capacity)
+    {
+        std::deque<std::pair<std::string, SessionPtr>> evicted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_capacity = capacity;
+            while (m_idle.size() > m_capacity) {
+                evicted.push_back(std::move(m_idle.front()));
+                m_idle.pop_front();
+            }
+        }
+        CloseAll(evicted);
+    }
+
+    /**
+     * @功能描述: 获取空闲会话数量上限
+     */
+    uint32_t GetCapacity()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_capacity;
+    }
+
+    /**
+     * @功能描述: 取出与键匹配的空闲会话
+     * @参数 [in] key: 会话键
+     * @返回值: 空闲会话，无匹配会话时返回nullptr
+     */
+    SessionPtr Acquire(const std::string &key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_idle.begin(); it != m_idle.end(); ++it) {
+            if (it->first == key) {
+                SessionPtr session = std::move(it->second);
+                m_idle.erase(it);
+                return session;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @功能描述: 归还会话，会话池已满时淘汰最早归还的会话，上限为0时直接关闭
+     * @参数 [in] key: 会话键
+     * @参数 [in] session: 会话，调用者需保证其处于可复用状态
+     */
+    void Release(const std::string &key, SessionPtr session)
+    {
+        if (session == nullptr) {
+            return;
+        }
+        std::deque<std::pair<std::string, SessionPtr>> evicted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_capacity == 0) {
+                evicted.emplace_back(key, std::move(session));
+            } else {
+                m_idle.emplace_back(key, std::move(session));
+                while (m_idle.size() > m_capacity) {
+                    evicted.push_back(std::move(m_idle.front()));
+                    m_idle.pop_front();
+                }
+            }
+        }
+        CloseAll(evicted);
+    }
+
+    /**
+     * @功能描述: 在后台线程中预热一个会话并放入会话池，键已有空闲或预热中的会话、或空闲与预热中的会话总数
+     *           已达上限时不预热，因此预热打开的会话数不超过空闲会话数量上限
+     * @参数 [in] key: 会话键
+     * @参数 [in] opener: 打开会话的函数，在预热线程中调用，不得引用调用者的成员
+     */
+    void Prewarm(const std::string &key, Opener opener)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_exit || m_idle.size() + m_tasks.size() + m_warming >= m_capacity || HasKeyLocked(key)) {
+            return;
+        }
+        m_tasks.emplace_back(key, std::move(opener));
+        if (!m_worker.joinable()) {
+            m_worker = std::thread(&SessionPool::WarmLoop, this);
+        }
+        m_cond.notify_one();
+    }
+
+    /**
+     * @功能描述: 停止预热线程（等待正在打开的会话完成），丢弃待预热任务并关闭所有空闲会话；
+     *           卸载厂商库前必须调用，之后调用Prewarm会重新启动预热线程
+     */
+    void Drain()
+    {
+        std::thread worker;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit = true;
+            worker.swap(m_worker);
+        }
+        m_cond.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        Clear();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = false;
+    }
+
+    /**
+     * @功能描述: 关闭并清空所有空闲会话
+     */
+    void Clear()
+    {
+        std::deque<std::pair<std::string, SessionPtr>> evicted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            evicted.swap(m_idle);
+            m_tasks.clear();
+        }
+        CloseAll(evicted);
+    }
+
+private:
+    bool HasKeyLocked(const std::string &key) const
+    {
+        for (const auto &idle : m_idle) {
+            if (idle.first == key) {
+                return true;
+            }
+        }
+        for (const auto &task : m_tasks) {
+            if (task.first == key) {
+                return true;
+            }
+        }
+        return m_warmingKey == key && m_warming != 0;
+    }
+
+    void CloseAll(std::deque<std::pair<std::string, SessionPtr>> &sessions)
+    {
+        for (auto &session : sessions) {
+            m_closer(*session.second);
+        }
+    }
+
+    void WarmLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cond.wait(lock, [this] { return m_exit || !m_tasks.empty(); });
+            if (m_exit) {
+                return;
+            }
+            std::pair<std::string, Opener> task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_warmingKey = task.first;
+            m_warming = 1;
+            lock.unlock();
+            SessionPtr session = task.second();
+            lock.lock();
+            m_warming = 0;
+            m_warmingKey.clear();
+            if (session == nullptr) {
+                continue;
+            }
+            lock.unlock();
+            Release(task.first, std::move(session));
+            lock.lock();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::pair<std::string, SessionPtr>> m_idle {};   // 空闲会话，按归还顺序排列
+    std::deque<std::pair<std::string, Opener>> m_tasks {};      // 待预热的会话
+    std::string m_warmingKey = "";
+    uint32_t m_warming = 0;
+    uint32_t m_capacity = 0;
+    bool m_exit = false;
+    std::thread m_worker;
+    Closer m_closer;
+};
+
+#endif  // SESSION_POOL_H
@@ -0,0 +1,80 @@
+/*
+ * 功能说明: 有界单生产者单消费者无锁队列，容量在构造时确定，生产者与消费者各自只写一个位置索引
+ */
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @功能描述: 构造函数
+     * @参数 [in] capacity: 队列容量，至少为1
+     */
+    explicit SpscQueue(uint32_t capacity) : m_slots(capacity > 0 ? capacity : 1) {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @功能描述: 生产者入队
+     * @参数 [in] item: 元素
+     * @返回值: true 成功；false 队列已满
+     */
+    bool TryPush(T item)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= m_slots.size()) {
+            return false;
+        }
+        m_slots[head % m_slots.size()] = std::move(item);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @功能描述: 消费者出队
+     * @参数 [out] item: 元素
+     * @返回值: true 成功；false 队列为空
+     */
+    bool TryPop(T &item)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(m_slots[tail % m_slots.size()]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @功能描述: 获取队列中的元素个数，并发修改时为近似值
+     * @返回值: 元素个数
+     */
+    uint32_t Size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @功能描述: 获取队列容量
+     * @返回值: 容量
+     */
+    uint32_t Capacity() const
+    {
+        return static_cast<uint32_t>(m_slots.size());
+    }
+
+private:
+    std::vector<T> m_slots;
+    alignas(64) std::atomic<uint32_t> m_head {0};   // 64: 缓存行大小，生产者写入位置
+    alignas(64) std::atomic<uint32_t> m_tail {0};   // 消费者读取位置
+};
+
+#endif  // SPSC_QUEUE_H
@@ -3,6 +3,7 @@
  */
 #include "Property.h"
 #include <sstream>
+#include <cstring>
 #include <sys/system_properties.h>
 
 int32_t GetIntEncParam(const char *inputValue)
@@ -42,3 +43,53 @@ void SetEncParam(const char *key, const char *value)
 {
     __system_property_set(key, value);
 }
+
+static_assert(PropertyWatcher::VALUE_MAX_LEN == PROP_VALUE_MAX, "property value length mismatch");
+
+PropertyWatcher::PropertyWatcher(const char *name) : m_name(name) {}
+
+bool PropertyWatcher::Update()
+{
+    if (m_propInfo == nullptr) {
+        // 属性尚未创建时，仅在属性区序列号变化后才重新查找，避免逐帧查找
+        uint32_t areaSerial = __system_property_area_serial();
+        if (m_hasSerial && areaSerial == m_areaSerial) {
+            return false;
+        }
+        m_areaSerial = areaSerial;
+        m_hasSerial = true;
+        m_propInfo = __system_property_find(m_name);
+        if (m_propInfo == nullptr) {
+            return false;
+        }
+    } else if (m_committed && __system_property_serial(m_propInfo) == m_serial) {
+        return false;
+    }
+    __system_property_read_callback(m_propInfo, ReadCallback, this);
+    return true;
+}
+
+void PropertyWatcher::Commit()
+{
+    m_serial = m_readSerial;
+    m_committed = true;
+}
+
+const char *PropertyWatcher::GetValue() const
+{
+    return m_value;
+}
+
+bool PropertyWatcher::ValueEquals(const char *value) const
+{
+    return strcmp(m_value, value) == 0;
+}
+
+void PropertyWatcher::ReadCallback(void *cookie, const char *name, const char *value, uint32_t serial)
+{
+    (void) name;
+    auto *watcher = static_cast<PropertyWatcher *>(cookie);
+    watcher->m_readSerial = serial;
+    (void) strncpy(watcher->m_value, value, VALUE_MAX_LEN - 1);
+    watcher->m_value[VALUE_MAX_LEN - 1] = '\0';
+}
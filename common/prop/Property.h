@@ -1,9 +1,69 @@
 /*
  * 功能描述：该文件封装了设置和读取属性的功能接口
  */
+#ifndef PROPERTY_H
+#define PROPERTY_H
+
 #include <string>
+#include <cstdint>
+
+struct prop_info;
 
 int32_t GetIntEncParam(const char *inputValue);
 std::string GetStrEncParam(const char *inputValue);
 void SetEncParam(const char *key, const char *value);
 int32_t StrToInt(std::string inputValue);
+
+/*
+ * 属性监听器：缓存属性句柄与序列号，仅在属性发生变化时重新读取属性值，
+ * 供编码等逐帧调用的热路径使用，属性未变化时不产生属性查询和内存分配。
+ * 读取到的新值经调用方处理成功并调用Commit后才记录其序列号，处理失败时下次Update重新读取
+ */
+class PropertyWatcher {
+public:
+    static constexpr uint32_t VALUE_MAX_LEN = 92;  // 与PROP_VALUE_MAX保持一致
+
+    /**
+     * @功能描述: 构造函数
+     * @参数 [in] name: 属性名，需保证在监听器生命周期内有效
+     */
+    explicit PropertyWatcher(const char *name);
+
+    /**
+     * @功能描述: 检查属性是否发生变化，变化时刷新缓存的属性值
+     * @返回值: true 属性值已更新或上次读取的值尚未Commit（首次调用时只要属性存在即返回true）
+     *          false 属性未变化或属性不存在
+     */
+    bool Update();
+
+    /**
+     * @功能描述: 确认最近一次Update读取的值已处理，属性再次变化前Update不再返回true
+     */
+    void Commit();
+
+    /**
+     * @功能描述: 获取缓存的属性值
+     * @返回值: 属性值，属性不存在时为空字符串
+     */
+    const char *GetValue() const;
+
+    /**
+     * @功能描述: 判断缓存的属性值是否与给定字符串相等
+     * @参数 [in] value: 待比较字符串
+     */
+    bool ValueEquals(const char *value) const;
+
+private:
+    static void ReadCallback(void *cookie, const char *name, const char *value, uint32_t serial);
+
+    const char *m_name = nullptr;
+    const prop_info *m_propInfo = nullptr;
+    uint32_t m_areaSerial = 0;
+    uint32_t m_serial = 0;          // 已Commit的属性序列号
+    uint32_t m_readSerial = 0;      // 最近一次读取的属性序列号
+    bool m_committed = false;
+    bool m_hasSerial = false;
+    char m_value[VALUE_MAX_LEN] = {'\0'};
+};
+
+#endif  // PROPERTY_H
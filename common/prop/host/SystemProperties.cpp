@@ -0,0 +1,135 @@
+/*
+ * 功能说明: 主机Linux构建使用的进程内系统属性实现
+ */
+
+#include "sys/system_properties.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+
+struct prop_info {
+    std::string name;
+    char value[PROP_VALUE_MAX];
+    uint32_t serial;
+};
+
+namespace {
+    const char *PROPERTY_FILE_ENV = "VMI_PROPERTY_FILE";
+
+    class PropertyArea {
+    public:
+        static PropertyArea &GetInstance()
+        {
+            static PropertyArea area;
+            return area;
+        }
+
+        prop_info *Find(const std::string &name)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_props.find(name);
+            return (it == m_props.end()) ? nullptr : &it->second;
+        }
+
+        int Set(const std::string &name, const char *value)
+        {
+            if (name.empty() || value == nullptr || strlen(value) >= PROP_VALUE_MAX) {
+                return -1;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_props.find(name);
+            if (it == m_props.end()) {
+                it = m_props.emplace(name, prop_info {name, {'\0'}, 0}).first;
+                ++m_areaSerial;
+            }
+            (void) strncpy(it->second.value, value, PROP_VALUE_MAX - 1);
+            it->second.value[PROP_VALUE_MAX - 1] = '\0';
+            ++it->second.serial;
+            return 0;
+        }
+
+        // 读取属性值，与设置互斥，保证读到完整的值
+        uint32_t Read(const prop_info &pi, char *value)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            (void) strncpy(value, pi.value, PROP_VALUE_MAX);
+            return pi.serial;
+        }
+
+        uint32_t Serial(const prop_info &pi)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return pi.serial;
+        }
+
+        uint32_t AreaSerial()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_areaSerial;
+        }
+
+    private:
+        PropertyArea()
+        {
+            const char *path = getenv(PROPERTY_FILE_ENV);
+            if (path == nullptr) {
+                return;
+            }
+            std::ifstream file(path);
+            std::string line;
+            while (std::getline(file, line)) {
+                size_t pos = line.find('=');
+                if (line.empty() || line[0] == '#' || pos == std::string::npos) {
+                    continue;
+                }
+                (void) Set(line.substr(0, pos), line.substr(pos + 1).c_str());
+            }
+        }
+
+        std::mutex m_mutex;
+        std::map<std::string, prop_info> m_props {};  // map节点地址稳定，可作为属性句柄返回
+        uint32_t m_areaSerial = 0;
+    };
+}
+
+int __system_property_get(const char *name, char *value)
+{
+    value[0] = '\0';
+    const prop_info *pi = __system_property_find(name);
+    if (pi == nullptr) {
+        return 0;
+    }
+    (void) PropertyArea::GetInstance().Read(*pi, value);
+    return static_cast<int>(strlen(value));
+}
+
+int __system_property_set(const char *name, const char *value)
+{
+    return (name == nullptr) ? -1 : PropertyArea::GetInstance().Set(name, value);
+}
+
+const prop_info *__system_property_find(const char *name)
+{
+    return (name == nullptr) ? nullptr : PropertyArea::GetInstance().Find(name);
+}
+
+uint32_t __system_property_serial(const prop_info *pi)
+{
+    return PropertyArea::GetInstance().Serial(*pi);
+}
+
+uint32_t __system_property_area_serial()
+{
+    return PropertyArea::GetInstance().AreaSerial();
+}
+
+void __system_property_read_callback(const prop_info *pi,
+    void (*callback)(void *cookie, const char *name, const char *value, uint32_t serial), void *cookie)
+{
+    char value[PROP_VALUE_MAX] = {'\0'};
+    uint32_t serial = PropertyArea::GetInstance().Read(*pi, value);
+    callback(cookie, pi->name.c_str(), value, serial);
+}
@@ -0,0 +1,25 @@
+/*
+ * 功能说明: 主机Linux构建使用的系统属性接口，与Android bionic的<sys/system_properties.h>保持一致，
+ *           属性保存在进程内，可通过环境变量VMI_PROPERTY_FILE指定的文件（每行name=value）预置
+ */
+#ifndef HOST_SYSTEM_PROPERTIES_H
+#define HOST_SYSTEM_PROPERTIES_H
+
+#include <cstdint>
+
+#define PROP_VALUE_MAX 92
+#define PROP_NAME_MAX 32
+
+typedef struct prop_info prop_info;
+
+extern "C" {
+int __system_property_get(const char *name, char *value);
+int __system_property_set(const char *name, const char *value);
+const prop_info *__system_property_find(const char *name);
+uint32_t __system_property_serial(const prop_info *pi);
+uint32_t __system_property_area_serial();
+void __system_property_read_callback(const prop_info *pi,
+    void (*callback)(void *cookie, const char *name, const char *value, uint32_t serial), void *cookie);
+}
+
+#endif  // HOST_SYSTEM_PROPERTIES_H
@@ -0,0 +1,826 @@
+/*
+ * 功能说明: 编解码性能测试工具，通过对外接口驱动编码器与解码器，输入为合成或文件读取的I420图像与码流，
+ *           统计各后端的帧率、单帧时延分位数与CPU时间
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "VideoCodecApi.h"
+#include "VideoDecoder.h"
+#include "Property.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t PERCENT_50 = 50;
+    constexpr uint32_t PERCENT_90 = 90;
+    constexpr uint32_t PERCENT_99 = 99;
+    constexpr uint32_t PERCENT_FULL = 100;
+    constexpr uint32_t RGBA_BYTES_PER_PIXEL = 4;
+    constexpr uint32_t DECODE_RETRY_MAX = 1000;
+    constexpr std::chrono::microseconds DECODE_RETRY_INTERVAL(500);
+    constexpr int32_t DECODE_WAIT_MS = 20;    // 异步模式下阻塞获取解码帧的超时
+    constexpr double MS_PER_SECOND = 1000.0;
+    constexpr double NS_PER_MS = 1000000.0;
+    constexpr int CHROMA_DIVISOR = 2;
+    constexpr int YUV420_SIZE_NUMERATOR = 3;
+    constexpr uint32_t YUV420_PLANES = 3;
+    constexpr uint32_t CHROMA_PLANE_DIVISOR = 4;
+    constexpr size_t SIM_TAG_TRAILER_SIZE = 2;  // NETINT模拟编码器在切片末尾写入的输入帧标记与结束字节
+    constexpr uint32_t FNV_OFFSET_BASIS = 2166136261U;
+    constexpr uint32_t FNV_PRIME = 16777619U;
+    const char *PROP_PIPELINE_DEPTH = "persist.vmi.video.encode.pipeline_depth";
+    const char *PROP_KEYFRAME = "persist.vmi.video.encode.keyframe";
+    const char *PROP_KEYFRAME_RESULT = "persist.vmi.video.encode.keyframe_result";
+    constexpr uint8_t H264_NAL_TYPE_MASK = 0x1F;
+    constexpr uint8_t H265_NAL_TYPE_SHIFT = 1;
+    constexpr uint8_t H265_NAL_TYPE_MASK = 0x3F;
+    constexpr uint8_t H264_NAL_IDR = 5;
+    constexpr uint8_t H265_NAL_IDR_W_RADL = 19;
+    constexpr uint8_t H265_NAL_IDR_N_LP = 20;
+    const std::vector<uint8_t> H264_PARAMETER_SETS = { 7, 8 };        // SPS, PPS
+    const std::vector<uint8_t> H265_PARAMETER_SETS = { 32, 33, 34 };  // VPS, SPS, PPS
+
+    // 编码器类型，与ro.vmi.demo.video.encode.format取值一致
+    const std::vector<std::pair<std::string, std::string>> ENCODER_TYPES = {
+        { "openh264", "0" },
+        { "netint-h264", "1" },
+        { "netint-h265", "2" },
+    };
+
+    struct BenchOptions {
+        std::string encoder = "openh264";   // 编码后端，none表示不编码
+        std::string decoder = "none";       // 解码码流类型h264/h265，none表示不解码
+        std::string input = "";             // I420输入文件，为空时使用合成图像
+        std::string bitstream = "";         // Annex-B码流文件，为空时解码编码输出
+        uint32_t width = 1280;
+        uint32_t height = 720;
+        uint32_t framerate = 30;
+        uint32_t frames = 300;
+        uint32_t bitrate = 5000000;
+        uint32_t gopsize = 30;
+        std::string profile = "baseline";
+        bool zeroCopy = false;              // 通过AcquireFrame获取解码帧，不经过CopyFrame拷贝
+        std::string outputFormat = "i420";  // 解码输出格式，nv12/nv21/rgba使用解码器内置转换
+        bool async = false;                 // 异步解码模式，阻塞等待解码帧而不是轮询
+        uint32_t framePool = 0;             // 解码帧缓冲池预留深度，0使用解码器默认值
+        bool configureSize = true;          // 启动前向解码器配置分辨率，否则由解码器从码流SPS获取
+        bool pipeline = false;              // 编码使用SubmitFrame/PollPacket，在途帧达到上限时才取输出
+        bool inputBuffers = false;          // 流水线编码的输入经DequeueInputBuffer/QueueInputBuffer送编
+        bool verify = false;                // 按NETINT模拟库的已知输出核对编解码结果
+        uint32_t keyframeAt = 0;            // 在该帧送编前请求强制I帧，0表示不请求
+        uint32_t restartAt = 0;             // 流水线编码在该帧送编前停止并重置编码器，0表示不重置
+    };
+
+    // 解码输出格式名称与MediaPixelFormat的对应关系
+    const std::vector<std::pair<std::string, MediaPixelFormat>> OUTPUT_FORMATS = {
+        { "i420", PIXEL_FORMAT_FLEX_YUV_420P },
+        { "nv12", PIXEL_FORMAT_NV12 },
+        { "nv21", PIXEL_FORMAT_NV21 },
+        { "rgba", PIXEL_FORMAT_RGBA_8888 },
+    };
+
+    // 单个后端的统计结果
+    struct BenchResult {
+        std::string name = "";
+        std::vector<double> latencyMs {};
+        double wallSeconds = 0;
+        double cpuSeconds = 0;
+        uint64_t bytes = 0;
+        uint32_t discarded = 0;             // 重置编码器时丢弃的在途帧数
+        bool ok = true;
+    };
+
+    double CpuSeconds()
+    {
+        timespec ts {};
+        (void) clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / (NS_PER_MS * MS_PER_SECOND);
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double Percentile(std::vector<double> sorted, uint32_t percent)
+    {
+        if (sorted.empty()) {
+            return 0;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        size_t index = (sorted.size() - 1) * percent / PERCENT_FULL;
+        return sorted[index];
+    }
+
+    void PrintUsage(const char *name)
+    {
+        printf("usage: %s [options]\n"
+            "  --encoder <openh264|netint-h264|netint-h265|none>  encode backend (default openh264)\n"
+            "  --decoder <h264|h265|none>   decode the encoder output or --bitstream (default none)\n"
+            "  --input <file>               I420 input, looped; synthetic frames when absent\n"
+            "  --bitstream <file>           Annex-B stream to decode instead of the encoder output\n"
+            "  --width <n> --height <n> --fps <n> --frames <n>\n"
+            "  --bitrate <bps> --gop <n> --profile <baseline|main|high>\n"
+            "  --zero-copy <0|1>            retrieve decoded frames with AcquireFrame/ReleaseFrame\n"
+            "  --output-format <i420|nv12|nv21|rgba>  decoder output format (default i420)\n"
+            "  --async <0|1>                decode in async mode and block on decoded frames\n"
+            "  --frame-pool <n>             decoder frame buffers reserved at start (default: decoder's)\n"
+            "  --configure-size <0|1>       configure the decoder size before start (default 1)\n"
+            "  --pipeline <0|1>             encode with SubmitFrame/PollPacket, keeping frames in flight\n"
+            "  --input-buffers <0|1>        in pipeline mode, fill encoder-owned input buffers\n"
+            "  --verify <0|1>               check the output against the NETINT simulator's known content\n"
+            "  --keyframe-at <n>            request a key frame before frame n and check its packet (0 = off)\n"
+            "  --restart-at <n>             in pipeline mode, stop and reset the encoder before frame n (0 = off)\n"
+            "Properties can be preset through the file named by VMI_PROPERTY_FILE (name=value per line).\n",
+            name);
+    }
+
+    bool ParseOptions(int argc, char **argv, BenchOptions &options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+                return false;
+            }
+            std::string value = argv[++i];
+            uint32_t number = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10)); // 10: 十进制
+            if (arg == "--encoder") {
+                options.encoder = value;
+            } else if (arg == "--decoder") {
+                options.decoder = value;
+            } else if (arg == "--input") {
+                options.input = value;
+            } else if (arg == "--bitstream") {
+                options.bitstream = value;
+            } else if (arg == "--width") {
+                options.width = number;
+            } else if (arg == "--height") {
+                options.height = number;
+            } else if (arg == "--fps") {
+                options.framerate = number;
+            } else if (arg == "--frames") {
+                options.frames = number;
+            } else if (arg == "--bitrate") {
+                options.bitrate = number;
+            } else if (arg == "--gop") {
+                options.gopsize = number;
+            } else if (arg == "--profile") {
+                options.profile = value;
+            } else if (arg == "--zero-copy") {
+                options.zeroCopy = number != 0;
+            } else if (arg == "--output-format") {
+                options.outputFormat = value;
+            } else if (arg == "--async") {
+                options.async = number != 0;
+            } else if (arg == "--frame-pool") {
+                options.framePool = number;
+            } else if (arg == "--configure-size") {
+                options.configureSize = number != 0;
+            } else if (arg == "--pipeline") {
+                options.pipeline = number != 0;
+            } else if (arg == "--input-buffers") {
+                options.inputBuffers = number != 0;
+            } else if (arg == "--keyframe-at") {
+                options.keyframeAt = number;
+            } else if (arg == "--restart-at") {
+                options.restartAt = number;
+            } else if (arg == "--verify") {
+                options.verify = number != 0;
+            } else {
+                return false;
+            }
+        }
+        // 重置会丢弃在途帧，输出序号与输入帧不再一一对应，不与强制I帧核对同时使用
+        bool restartValid = options.restartAt == 0 || (options.pipeline && options.keyframeAt == 0);
+        return options.width != 0 && options.height != 0 && options.frames != 0 && restartValid;
+    }
+
+    /**
+     * @功能描述: 生成或读取一帧I420图像，合成图像为逐帧平移的渐变，使编码器有运动可估计
+     */
+    class FrameSource {
+    public:
+        explicit FrameSource(const BenchOptions &options)
+            : m_width(options.width), m_height(options.height),
+              m_frame(options.width * options.height * YUV420_SIZE_NUMERATOR / CHROMA_DIVISOR)
+        {
+            if (!options.input.empty()) {
+                m_file.open(options.input, std::ios::binary);
+                m_useFile = m_file.is_open();
+                if (!m_useFile) {
+                    fprintf(stderr, "open %s failed, use synthetic frames\n", options.input.c_str());
+                }
+            }
+        }
+
+        const std::vector<uint8_t> &Next(uint32_t index)
+        {
+            if (m_useFile) {
+                if (!m_file.read(reinterpret_cast<char *>(m_frame.data()), m_frame.size())) {
+                    m_file.clear();
+                    m_file.seekg(0);
+                    (void) m_file.read(reinterpret_cast<char *>(m_frame.data()), m_frame.size());
+                }
+                return m_frame;
+            }
+            uint8_t *y = m_frame.data();
+            for (uint32_t row = 0; row < m_height; ++row) {
+                for (uint32_t col = 0; col < m_width; ++col) {
+                    y[row * m_width + col] = static_cast<uint8_t>(row + col + index * CHROMA_DIVISOR);
+                }
+            }
+            uint32_t chromaSize = (m_width / CHROMA_DIVISOR) * (m_height / CHROMA_DIVISOR);
+            std::fill_n(m_frame.data() + m_width * m_height, chromaSize, static_cast<uint8_t>(index));
+            std::fill_n(m_frame.data() + m_width * m_height + chromaSize, chromaSize, static_cast<uint8_t>(~index));
+            return m_frame;
+        }
+
+    private:
+        uint32_t m_width;
+        uint32_t m_height;
+        std::vector<uint8_t> m_frame;
+        std::ifstream m_file;
+        bool m_useFile = false;
+    };
+
+    void SetEncoderProperties(const BenchOptions &options, const std::string &encoderType)
+    {
+        SetEncParam("ro.vmi.demo.video.encode.format", encoderType.c_str());
+        SetEncParam("ro.sys.vmi.cloudphone", "instruction");
+        SetEncParam("persist.vmi.demo.video.encode.width", std::to_string(options.width).c_str());
+        SetEncParam("persist.vmi.demo.video.encode.height", std::to_string(options.height).c_str());
+        SetEncParam("persist.vmi.demo.video.encode.framerate", std::to_string(options.framerate).c_str());
+        SetEncParam("persist.vmi.demo.video.encode.bitrate", std::to_string(options.bitrate).c_str());
+        SetEncParam("persist.vmi.demo.video.encode.gopsize", std::to_string(options.gopsize).c_str());
+        SetEncParam("persist.vmi.demo.video.encode.profile", options.profile.c_str());
+    }
+
+    // 与客户端一致，通过属性请求强制I帧，编码器在下一次写入设备前读取
+    void RequestKeyFrame(const BenchOptions &options, uint32_t frame)
+    {
+        if (options.keyframeAt != 0 && frame == options.keyframeAt) {
+            SetEncParam(PROP_KEYFRAME, "1");
+        }
+    }
+
+    // 按I420紧凑布局逐平面逐行拷贝到编码器持有的输入缓冲区
+    void FillInputBuffer(const BenchOptions &options, const std::vector<uint8_t> &frame,
+        const EncoderInputBuffer &buffer)
+    {
+        const uint8_t *src = frame.data();
+        for (uint32_t plane = 0; plane < YUV420_PLANES && plane < buffer.planeNum; ++plane) {
+            uint32_t width = (plane == 0) ? options.width : options.width / CHROMA_DIVISOR;
+            uint32_t height = (plane == 0) ? options.height : options.height / CHROMA_DIVISOR;
+            uint32_t copyWidth = std::min(width, buffer.stride[plane]);
+            for (uint32_t row = 0; row < height && row < buffer.height[plane]; ++row) {
+                (void) memcpy(buffer.data + buffer.offset[plane] + row * buffer.stride[plane], src + row * width,
+                    copyWidth);
+            }
+            src += width * height;
+        }
+    }
+
+    /**
+     * @功能描述: 流水线编码，在途帧达到上限前只提交不取输出，停止编码器后取出排空的剩余输出；
+     *           指定--restart-at时在该帧前停止并重置编码器，不取出排空的输出，重置后不应再收到这些输出
+     * @返回值: 同时在途的最大帧数
+     */
+    uint32_t PipelineEncode(const BenchOptions &options, VideoEncoder *encoder, BenchResult &result,
+        std::vector<std::vector<uint8_t>> &packets)
+    {
+        std::deque<Clock::time_point> submitTimes;
+        auto collect = [&](bool wait) {
+            uint8_t *output = nullptr;
+            uint32_t outputSize = 0;
+            EncoderRetCode ret = encoder->PollPacket(&output, &outputSize, wait);
+            if (ret == VIDEO_ENCODER_SUCCESS) {
+                if (!submitTimes.empty()) {
+                    result.latencyMs.push_back(ElapsedMs(submitTimes.front()));
+                    submitTimes.pop_front();
+                }
+                result.bytes += outputSize;
+                packets.emplace_back(output, output + outputSize);
+            }
+            return ret;
+        };
+        auto submit = [&](const std::vector<uint8_t> &frame) {
+            if (!options.inputBuffers) {
+                return encoder->SubmitFrame(frame.data(), static_cast<uint32_t>(frame.size()));
+            }
+            EncoderInputBuffer buffer;
+            EncoderRetCode ret = encoder->DequeueInputBuffer(&buffer);
+            if (ret != VIDEO_ENCODER_SUCCESS) {
+                return ret;
+            }
+            FillInputBuffer(options, frame, buffer);
+            // 设备队列满时缓冲区仍归调用者所有，取出输出后重新提交
+            while ((ret = encoder->QueueInputBuffer(buffer)) == VIDEO_ENCODER_QUEUE_FULL) {
+                if (collect(true) != VIDEO_ENCODER_SUCCESS) {
+                    return VIDEO_ENCODER_ENCODE_FAIL;
+                }
+            }
+            return ret;
+        };
+
+        FrameSource source(options);
+        uint32_t maxInFlight = 0;
+        for (uint32_t i = 0; i < options.frames; ++i) {
+            const std::vector<uint8_t> &frame = source.Next(i);
+            RequestKeyFrame(options, i);
+            if (options.restartAt != 0 && i == options.restartAt) {
+                (void) encoder->StopEncoder();
+                if (encoder->ResetEncoder() != VIDEO_ENCODER_SUCCESS) {
+                    fprintf(stderr, "reset encoder before frame %u failed\n", i);
+                    result.ok = false;
+                    break;
+                }
+                result.discarded = static_cast<uint32_t>(submitTimes.size());
+                submitTimes.clear();
+                printf("encoder reset before frame %u, %u frames in flight discarded\n", i, result.discarded);
+            }
+            Clock::time_point start = Clock::now();
+            EncoderRetCode ret = VIDEO_ENCODER_SUCCESS;
+            while ((ret = submit(frame)) == VIDEO_ENCODER_QUEUE_FULL) {
+                if (collect(true) != VIDEO_ENCODER_SUCCESS) {
+                    ret = VIDEO_ENCODER_ENCODE_FAIL;
+                    break;
+                }
+            }
+            if (ret != VIDEO_ENCODER_SUCCESS) {
+                fprintf(stderr, "submit frame %u failed: %#x\n", i, ret);
+                result.ok = false;
+                break;
+            }
+            submitTimes.push_back(start);
+            maxInFlight = std::max(maxInFlight, static_cast<uint32_t>(submitTimes.size()));
+        }
+        (void) encoder->StopEncoder();
+        while (collect(false) == VIDEO_ENCODER_SUCCESS) {
+        }
+        return maxInFlight;
+    }
+
+    // 模拟编码器在切片末尾写入输入帧的首个亮度样本，合成图像第i帧为i * CHROMA_DIVISOR的低8位；
+    // 重置编码器时丢弃的在途帧紧接在重置帧之前，之后的输出依次对应重置帧及其后的输入帧
+    bool VerifyPacketOrder(const BenchOptions &options, const std::vector<std::vector<uint8_t>> &packets,
+        uint32_t discarded)
+    {
+        size_t firstDiscarded = options.restartAt - discarded;
+        for (size_t i = 0; i < packets.size(); ++i) {
+            const std::vector<uint8_t> &packet = packets[i];
+            size_t frame = (discarded != 0 && i >= firstDiscarded) ? i + discarded : i;
+            uint8_t expected = static_cast<uint8_t>(frame * CHROMA_DIVISOR);
+            if (packet.size() < SIM_TAG_TRAILER_SIZE || packet[packet.size() - SIM_TAG_TRAILER_SIZE] != expected) {
+                fprintf(stderr, "packet %zu is not the output of input frame %zu\n", i, frame);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 按出现顺序列出一帧编码输出内各NAL单元的类型
+    std::vector<uint8_t> NalTypes(const std::vector<uint8_t> &packet, bool isH264)
+    {
+        std::vector<uint8_t> types;
+        for (size_t i = 0; i + 3 < packet.size(); ++i) { // 3: 起始码00 00 01长度
+            if (packet[i] == 0 && packet[i + 1] == 0 && packet[i + 2] == 1) {
+                uint8_t header = packet[i + 3];           // 3: NAL单元头位置
+                types.push_back(isH264 ? (header & H264_NAL_TYPE_MASK) :
+                    ((header >> H265_NAL_TYPE_SHIFT) & H265_NAL_TYPE_MASK));
+                i += 2; // 2: 跳过起始码剩余字节
+            }
+        }
+        return types;
+    }
+
+    bool IsIdrNal(bool isH264, uint8_t type)
+    {
+        return isH264 ? type == H264_NAL_IDR : (type == H265_NAL_IDR_W_RADL || type == H265_NAL_IDR_N_LP);
+    }
+
+    // 请求后的下一个输出须以参数集开头、以IDR切片结束，且前一个输出不是IDR；NETINT编码器还需上报结果
+    bool VerifyForcedKeyFrame(const BenchOptions &options, const std::vector<std::vector<uint8_t>> &packets)
+    {
+        bool isH264 = options.encoder != "netint-h265";
+        const std::vector<uint8_t> &parameterSets = isH264 ? H264_PARAMETER_SETS : H265_PARAMETER_SETS;
+        std::vector<uint8_t> types = NalTypes(packets[options.keyframeAt], isH264);
+        if (types.size() <= parameterSets.size() || !std::equal(parameterSets.begin(), parameterSets.end(),
+            types.begin()) || !IsIdrNal(isH264, types.back())) {
+            fprintf(stderr, "packet %u is not an IDR led by parameter sets\n", options.keyframeAt);
+            return false;
+        }
+        std::vector<uint8_t> previous = NalTypes(packets[options.keyframeAt - 1], isH264);
+        if (!previous.empty() && IsIdrNal(isH264, previous.back())) {
+            fprintf(stderr, "IDR came before the key frame request at frame %u\n", options.keyframeAt);
+            return false;
+        }
+        std::string result = GetStrEncParam(PROP_KEYFRAME_RESULT);
+        if (options.encoder.compare(0, strlen("netint"), "netint") == 0 && result != "1") {
+            fprintf(stderr, "key frame result is \"%s\", expected \"1\"\n", result.c_str());
+            return false;
+        }
+        printf("key frame forced on packet %u\n", options.keyframeAt);
+        return true;
+    }
+
+    // 除重置时丢弃的在途帧外，每个输入帧都应有一个编码输出，--verify时按模拟编码器的帧标记核对输出顺序
+    void FinishEncode(const BenchOptions &options, const std::vector<std::vector<uint8_t>> &packets,
+        BenchResult &result)
+    {
+        if (!result.ok) {
+            return;
+        }
+        if (packets.size() + result.discarded != options.frames) {
+            fprintf(stderr, "encoded %zu packets for %u frames, %u discarded\n", packets.size(), options.frames,
+                result.discarded);
+            result.ok = false;
+        } else if (options.verify && !VerifyPacketOrder(options, packets, result.discarded)) {
+            result.ok = false;
+        } else if (options.keyframeAt != 0 && options.keyframeAt < packets.size() &&
+            !VerifyForcedKeyFrame(options, packets)) {
+            result.ok = false;
+        }
+    }
+
+    BenchResult RunEncoder(const BenchOptions &options, const std::string &encoderType,
+        std::vector<std::vector<uint8_t>> &packets)
+    {
+        BenchResult result;
+        result.name = "encode:" + options.encoder;
+        SetEncoderProperties(options, encoderType);
+        VideoEncoder *encoder = nullptr;
+        if (CreateVideoEncoder(&encoder) != VIDEO_ENCODER_SUCCESS || encoder == nullptr) {
+            fprintf(stderr, "create encoder %s failed\n", options.encoder.c_str());
+            result.ok = false;
+            return result;
+        }
+        if (encoder->InitEncoder() != VIDEO_ENCODER_SUCCESS || encoder->StartEncoder() != VIDEO_ENCODER_SUCCESS) {
+            fprintf(stderr, "init/start encoder %s failed\n", options.encoder.c_str());
+            (void) DestroyVideoEncoder(encoder);
+            result.ok = false;
+            return result;
+        }
+
+        double cpuStart = CpuSeconds();
+        Clock::time_point wallStart = Clock::now();
+        if (options.pipeline) {
+            uint32_t maxInFlight = PipelineEncode(options, encoder, result, packets);
+            result.wallSeconds = ElapsedMs(wallStart) / MS_PER_SECOND;
+            result.cpuSeconds = CpuSeconds() - cpuStart;
+            encoder->DestroyEncoder();
+            (void) DestroyVideoEncoder(encoder);
+            // 流水线深度大于1时，提交阶段应能让在途帧达到该深度
+            int32_t depth = GetIntEncParam(PROP_PIPELINE_DEPTH);
+            printf("pipeline depth %d, max in flight %u\n", depth, maxInFlight);
+            if (depth > 1 && maxInFlight != static_cast<uint32_t>(depth)) {
+                fprintf(stderr, "pipeline kept at most %u of %d frames in flight\n", maxInFlight, depth);
+                result.ok = false;
+            }
+            FinishEncode(options, packets, result);
+            return result;
+        }
+
+        FrameSource source(options);
+        for (uint32_t i = 0; i < options.frames; ++i) {
+            const std::vector<uint8_t> &frame = source.Next(i);
+            RequestKeyFrame(options, i);
+            uint8_t *output = nullptr;
+            uint32_t outputSize = 0;
+            Clock::time_point start = Clock::now();
+            EncoderRetCode ret = encoder->EncodeOneFrame(frame.data(), static_cast<uint32_t>(frame.size()),
+                &output, &outputSize);
+            result.latencyMs.push_back(ElapsedMs(start));
+            if (ret != VIDEO_ENCODER_SUCCESS) {
+                fprintf(stderr, "encode frame %u failed: %#x\n", i, ret);
+                result.ok = false;
+                break;
+            }
+            result.bytes += outputSize;
+            packets.emplace_back(output, output + outputSize);
+        }
+        result.wallSeconds = ElapsedMs(wallStart) / MS_PER_SECOND;
+        result.cpuSeconds = CpuSeconds() - cpuStart;
+        (void) encoder->StopEncoder();
+        encoder->DestroyEncoder();
+        (void) DestroyVideoEncoder(encoder);
+        FinishEncode(options, packets, result);
+        return result;
+    }
+
+    bool IsVclNal(bool isH264, const uint8_t *nal)
+    {
+        constexpr uint8_t h264TypeMask = 0x1F;
+        constexpr uint8_t h264SliceMin = 1;
+        constexpr uint8_t h264SliceMax = 5;
+        constexpr uint8_t h265TypeShift = 1;
+        constexpr uint8_t h265TypeMask = 0x3F;
+        constexpr uint8_t h265VclMax = 31;
+        if (isH264) {
+            uint8_t type = nal[0] & h264TypeMask;
+            return type >= h264SliceMin && type <= h264SliceMax;
+        }
+        return ((nal[0] >> h265TypeShift) & h265TypeMask) <= h265VclMax;
+    }
+
+    /**
+     * @功能描述: 将Annex-B码流按访问单元切分，假定每帧一个slice：非VCL单元之后或连续VCL单元之间开始新的访问单元
+     */
+    std::vector<std::vector<uint8_t>> SplitAccessUnits(const std::vector<uint8_t> &stream, bool isH264)
+    {
+        std::vector<size_t> starts;
+        for (size_t i = 0; i + 3 < stream.size(); ++i) { // 3: 起始码00 00 01长度
+            if (stream[i] == 0 && stream[i + 1] == 0 && stream[i + 2] == 1) {
+                starts.push_back((i > 0 && stream[i - 1] == 0) ? i - 1 : i);
+                i += 2; // 2: 跳过起始码剩余字节
+            }
+        }
+        std::vector<std::vector<uint8_t>> units;
+        size_t auStart = starts.empty() ? stream.size() : starts[0];
+        bool vclSeen = false;
+        for (size_t n = 0; n < starts.size(); ++n) {
+            size_t payload = starts[n] + ((stream[starts[n] + 2] == 1) ? 3 : 4); // 3/4: 起始码长度
+            bool vcl = IsVclNal(isH264, &stream[payload]);
+            if (vclSeen && starts[n] > auStart) {
+                units.emplace_back(stream.begin() + auStart, stream.begin() + starts[n]);
+                auStart = starts[n];
+                vclSeen = false;
+            }
+            vclSeen = vclSeen || vcl;
+        }
+        if (auStart < stream.size()) {
+            units.emplace_back(stream.begin() + auStart, stream.end());
+        }
+        return units;
+    }
+
+    // 解码帧的亮度平面
+    struct LumaPlane {
+        const uint8_t *data = nullptr;
+        uint32_t stride = 0;    // 为0时各行取同一行数据
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    // FNV-1a校验和
+    uint32_t PlaneChecksum(const LumaPlane &plane)
+    {
+        uint32_t hash = FNV_OFFSET_BASIS;
+        for (uint32_t y = 0; y < plane.height; ++y) {
+            const uint8_t *row = plane.data + static_cast<size_t>(y) * plane.stride;
+            for (uint32_t x = 0; x < plane.width; ++x) {
+                hash = (hash ^ row[x]) * FNV_PRIME;
+            }
+        }
+        return hash;
+    }
+
+    // 模拟解码器以切片末尾的输入帧标记填充亮度平面，第i个解码帧的亮度平面应与以合成图像第i帧首个亮度样本
+    // 填充的平面一致，同时核对了解码输出的顺序与输出缓冲中亮度平面的布局
+    bool VerifyDecodedLuma(size_t index, const LumaPlane &plane)
+    {
+        std::vector<uint8_t> row(plane.width, static_cast<uint8_t>(index * CHROMA_DIVISOR));
+        LumaPlane reference = plane;
+        reference.data = row.data();
+        reference.stride = 0;
+        uint32_t expected = PlaneChecksum(reference);
+        uint32_t actual = (plane.data != nullptr) ? PlaneChecksum(plane) : 0;
+        if (plane.data == nullptr || plane.width == 0 || actual != expected) {
+            fprintf(stderr, "decoded frame %zu luma checksum %#x, expected %#x\n", index, actual, expected);
+            return false;
+        }
+        return true;
+    }
+
+    BenchResult RunDecoder(const BenchOptions &options, const std::vector<std::vector<uint8_t>> &units)
+    {
+        BenchResult result;
+        result.name = "decode:netint-" + options.decoder +
+            ((options.outputFormat != "i420") ? "-" + options.outputFormat : "") + (options.async ? "-async" : "");
+        VideoDecoder *decoder = nullptr;
+        if (CreateVideoDecoder(&decoder) != VIDEO_DECODER_SUCCESS || decoder == nullptr) {
+            fprintf(stderr, "create decoder failed\n");
+            result.ok = false;
+            return result;
+        }
+        PicInfoParams picInfo;
+        picInfo.width = options.width;
+        picInfo.height = options.height;
+        picInfo.stride = static_cast<int32_t>(options.width);
+        picInfo.scanLines = options.height;
+        bool picInfoChanged = false;
+        (void) decoder->CreateDecoder((options.decoder == "h265") ? STREAM_FORMAT_HEVC : STREAM_FORMAT_AVC);
+        if (options.configureSize) {
+            (void) decoder->SetDecodeParams(INDEX_PIC_INFO, &picInfo);
+        }
+        (void) decoder->SetCallbacks([&picInfo, &picInfoChanged](DecodeEventIndex index, uint32_t, void *data) {
+            if (index == INDEX_PIC_INFO_CHANGE && data != nullptr) {
+                picInfo = *static_cast<PicInfoParams *>(data);
+                picInfoChanged = true;
+            }
+        });
+        // src为解码帧的平面指针数组（Y、U、V），按平面依次拷贝
+        (void) decoder->SetCopyFrameFunc([](uint8_t *src, uint8_t *dst, const PicInfoParams &params, uint32_t maxLen) {
+            uint8_t **planes = reinterpret_cast<uint8_t **>(src);
+            uint32_t lumaSize = static_cast<uint32_t>(params.stride) * params.height;
+            uint32_t planeSize[YUV420_PLANES] = {lumaSize, lumaSize / CHROMA_PLANE_DIVISOR,
+                lumaSize / CHROMA_PLANE_DIVISOR};
+            uint32_t filled = 0;
+            for (uint32_t i = 0; i < YUV420_PLANES && planes[i] != nullptr; ++i) {
+                uint32_t size = std::min(maxLen - filled, planeSize[i]);
+                (void) memcpy(dst + filled, planes[i], size);
+                filled += size;
+            }
+            return filled;
+        });
+        auto outputFormat = std::find_if(OUTPUT_FORMATS.begin(), OUTPUT_FORMATS.end(),
+            [&options](const std::pair<std::string, MediaPixelFormat> &item) {
+                return item.first == options.outputFormat;
+            });
+        PortFormatParams portFormat;
+        portFormat.port = OUT_PORT;
+        portFormat.format = (outputFormat != OUTPUT_FORMATS.end()) ? outputFormat->second : PIXEL_FORMAT_NONE;
+        AsyncModeParams asyncMode;
+        asyncMode.enable = options.async;
+        (void) decoder->SetDecodeParams(INDEX_ASYNC_MODE_INFO, &asyncMode);
+        FramePoolParams framePool;
+        framePool.depth = options.framePool;
+        (void) decoder->SetDecodeParams(INDEX_FRAME_POOL_INFO, &framePool);
+        if (decoder->SetDecodeParams(INDEX_PORT_FORMAT_INFO, &portFormat) != VIDEO_DECODER_SUCCESS) {
+            fprintf(stderr, "unsupported output format %s\n", options.outputFormat.c_str());
+            (void) DestroyVideoDecoder(decoder);
+            result.ok = false;
+            return result;
+        }
+        if (decoder->InitDecoder() != VIDEO_DECODER_SUCCESS || decoder->StartDecoder() != VIDEO_DECODER_SUCCESS) {
+            fprintf(stderr, "init/start decoder failed\n");
+            (void) DestroyVideoDecoder(decoder);
+            result.ok = false;
+            return result;
+        }
+
+        std::vector<uint8_t> output(options.width * options.height * RGBA_BYTES_PER_PIXEL);
+        std::deque<Clock::time_point> sendTimes;
+        // 零拷贝模式下保留最近一帧的引用直到解码器销毁之后，验证帧缓冲可晚于解码器归还
+        DecodedFrame lastFrame;
+        // --verify时核对编码输出解码后的亮度平面，RGBA输出没有亮度平面
+        bool verifyLuma = options.verify && options.bitstream.empty() && options.outputFormat != "rgba";
+        auto retrieve = [&](uint32_t &filled, bool wait) {
+            if (!options.zeroCopy) {
+                DecoderRetCode ret = decoder->RetrieveFrameData(output.data(), static_cast<uint32_t>(output.size()),
+                    &filled, (options.async && wait) ? DECODE_WAIT_MS : 0);
+                LumaPlane luma = { output.data(), static_cast<uint32_t>(picInfo.stride), picInfo.width,
+                    picInfo.height };
+                if (ret == VIDEO_DECODER_SUCCESS && verifyLuma && !VerifyDecodedLuma(result.latencyMs.size(), luma)) {
+                    return VIDEO_DECODER_DECODE_FAIL;
+                }
+                return ret;
+            }
+            DecodedFrame frame;
+            DecoderRetCode ret = decoder->AcquireFrame(&frame);
+            if (frame.buffer != nullptr) {
+                filled = static_cast<uint32_t>(frame.strides[0]) * frame.height * YUV420_SIZE_NUMERATOR /
+                    CHROMA_DIVISOR;
+                LumaPlane luma = { frame.planes[0], static_cast<uint32_t>(frame.strides[0]), frame.width,
+                    frame.height };
+                if (verifyLuma && !VerifyDecodedLuma(result.latencyMs.size(), luma)) {
+                    ret = VIDEO_DECODER_DECODE_FAIL;
+                }
+                lastFrame = frame;
+                (void) decoder->ReleaseFrame(&frame);
+            }
+            return ret;
+        };
+        auto drain = [&](bool wait) {
+            for (uint32_t retry = 0; retry < DECODE_RETRY_MAX && !sendTimes.empty(); ++retry) {
+                if (picInfoChanged) {
+                    // 解码器在首包解析出码流尺寸或解码帧分辨率变化时通知，重新配置后获取的帧按新尺寸交付
+                    picInfoChanged = false;
+                    (void) decoder->SetDecodeParams(INDEX_PIC_INFO, &picInfo);
+                    output.resize(std::max<size_t>(output.size(),
+                        static_cast<size_t>(picInfo.width) * picInfo.height * RGBA_BYTES_PER_PIXEL));
+                }
+                uint32_t filled = 0;
+                DecoderRetCode ret = retrieve(filled, wait);
+                if (ret == VIDEO_DECODER_BAD_PIC_SIZE) {
+                    // 分辨率变化时解码器保留当前帧，重新配置后的下一次获取交付该帧
+                    continue;
+                }
+                if (ret == VIDEO_DECODER_SUCCESS) {
+                    result.latencyMs.push_back(ElapsedMs(sendTimes.front()));
+                    result.bytes += filled;
+                    sendTimes.pop_front();
+                    continue;
+                }
+                if (ret != VIDEO_DECODER_READ_UNDERFLOW || !wait) {
+                    return ret == VIDEO_DECODER_READ_UNDERFLOW || ret == VIDEO_DECODER_EOS;
+                }
+                if (!options.async || options.zeroCopy) {
+                    std::this_thread::sleep_for(DECODE_RETRY_INTERVAL);
+                }
+            }
+            return true;
+        };
+
+        double cpuStart = CpuSeconds();
+        Clock::time_point wallStart = Clock::now();
+        for (const auto &unit : units) {
+            sendTimes.push_back(Clock::now());
+            DecoderRetCode ret = decoder->SendStreamData(const_cast<uint8_t *>(unit.data()),
+                static_cast<uint32_t>(unit.size()));
+            for (uint32_t retry = 0; ret == VIDEO_DECODER_WRITE_OVERFLOW && retry < DECODE_RETRY_MAX; ++retry) {
+                (void) drain(false);
+                std::this_thread::sleep_for(DECODE_RETRY_INTERVAL);
+                ret = decoder->SendStreamData(const_cast<uint8_t *>(unit.data()), static_cast<uint32_t>(unit.size()));
+            }
+            if (ret != VIDEO_DECODER_SUCCESS || !drain(false)) {
+                fprintf(stderr, "decode failed: %#x\n", ret);
+                result.ok = false;
+                break;
+            }
+        }
+        if (!drain(result.ok)) {
+            result.ok = false;
+        }
+        // 分辨率变化时解码器保留新尺寸的帧并在重新配置后交付，每个送入的帧都应解码输出
+        if (result.ok && result.latencyMs.size() != units.size()) {
+            fprintf(stderr, "decoded %zu frames for %zu access units\n", result.latencyMs.size(), units.size());
+            result.ok = false;
+        }
+        // 未配置分辨率时解码器应从码流参数集取得编码尺寸，通知后按其重新配置
+        PicInfoParams current;
+        if (result.ok && !options.configureSize && options.bitstream.empty() &&
+            (decoder->GetDecodeParams(INDEX_PIC_INFO, &current) != VIDEO_DECODER_SUCCESS ||
+            current.cropWidth != options.width || current.cropHeight != options.height)) {
+            fprintf(stderr, "decoder display size %ux%u, encoded %ux%u\n", current.cropWidth, current.cropHeight,
+                options.width, options.height);
+            result.ok = false;
+        }
+        result.wallSeconds = ElapsedMs(wallStart) / MS_PER_SECOND;
+        result.cpuSeconds = CpuSeconds() - cpuStart;
+        decoder->DestroyDecoder();
+        (void) DestroyVideoDecoder(decoder);
+        lastFrame = DecodedFrame();
+        return result;
+    }
+
+    void PrintResult(const BenchResult &result)
+    {
+        size_t frames = result.latencyMs.size();
+        double fps = (result.wallSeconds > 0) ? frames / result.wallSeconds : 0;
+        double cpuPerFrameMs = (frames > 0) ? result.cpuSeconds * MS_PER_SECOND / frames : 0;
+        printf("%-20s %7zu %9.2f %9.3f %9.3f %9.3f %9.3f %9.3f %12.3f %12llu%s\n", result.name.c_str(), frames, fps,
+            Percentile(result.latencyMs, PERCENT_50), Percentile(result.latencyMs, PERCENT_90),
+            Percentile(result.latencyMs, PERCENT_99), Percentile(result.latencyMs, PERCENT_FULL),
+            result.cpuSeconds, cpuPerFrameMs, static_cast<unsigned long long>(result.bytes),
+            result.ok ? "" : "  (failed)");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BenchResult> results;
+    std::vector<std::vector<uint8_t>> units;
+    if (options.encoder != "none") {
+        auto type = std::find_if(ENCODER_TYPES.begin(), ENCODER_TYPES.end(),
+            [&options](const std::pair<std::string, std::string> &item) { return item.first == options.encoder; });
+        if (type == ENCODER_TYPES.end()) {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        results.push_back(RunEncoder(options, type->second, units));
+    }
+    if (options.decoder != "none") {
+        if (!options.bitstream.empty()) {
+            std::ifstream file(options.bitstream, std::ios::binary);
+            std::vector<uint8_t> stream((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            units = SplitAccessUnits(stream, options.decoder != "h265");
+        }
+        results.push_back(RunDecoder(options, units));
+    }
+
+    printf("%-20s %7s %9s %9s %9s %9s %9s %9s %12s %12s\n", "backend", "frames", "fps", "p50(ms)", "p90(ms)",
+        "p99(ms)", "max(ms)", "cpu(s)", "cpu/frame(ms)", "bytes");
+    bool ok = true;
+    for (const auto &result : results) {
+        PrintResult(result);
+        ok = ok && result.ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,204 @@
+/*
+ * 功能说明: 解码输出格式转换微基准，以随机I420图像对比逐像素转换与FrameConverter的SIMD转换，
+ *           NV12/NV21/RGBA输出须逐字节一致，输出吞吐量与加速比
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "FrameConverter.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t WIDTH_ALIGN = 32;        // 与NETINT解码输出的亮度宽度对齐一致
+    constexpr uint32_t CHROMA_DIVISOR = 2;
+    constexpr double PIXELS_PER_MP = 1000000.0;
+    // 额外验证的非16倍数宽度，覆盖行尾逐像素处理
+    constexpr uint32_t ODD_WIDTHS[] = {1, 17, 33, 1279};
+
+    struct BenchOptions {
+        uint32_t width = 1920;
+        uint32_t height = 1080;
+        uint32_t iterations = 50;
+    };
+
+    // 源图像及其平面内存
+    struct SourceImage {
+        std::vector<uint8_t> planes[FrameConverter::PLANE_NUM];
+        FrameConverter::SourceFrame frame;
+    };
+
+    void PrintUsage(const char *name)
+    {
+        printf("usage: %s [--width <n>] [--height <n>] [--iterations <n>]\n", name);
+    }
+
+    bool ParseOptions(int argc, char **argv, BenchOptions &options)
+    {
+        for (int i = 1; i < argc; i += 2) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            uint32_t value = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 0));
+            if (value == 0) {
+                return false;
+            }
+            if (arg == "--width") {
+                options.width = value;
+            } else if (arg == "--height") {
+                options.height = value;
+            } else if (arg == "--iterations") {
+                options.iterations = value;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SourceImage BuildSource(uint32_t width, uint32_t height, std::mt19937 &random)
+    {
+        SourceImage image;
+        uint32_t lumaStride = (width + WIDTH_ALIGN - 1) / WIDTH_ALIGN * WIDTH_ALIGN;
+        uint32_t strides[FrameConverter::PLANE_NUM] = {lumaStride, lumaStride / CHROMA_DIVISOR,
+            lumaStride / CHROMA_DIVISOR};
+        uint32_t rows[FrameConverter::PLANE_NUM] = {height, (height + 1) / CHROMA_DIVISOR,
+            (height + 1) / CHROMA_DIVISOR};
+        for (uint32_t i = 0; i < FrameConverter::PLANE_NUM; ++i) {
+            image.planes[i].resize(static_cast<size_t>(strides[i]) * rows[i]);
+            for (auto &value : image.planes[i]) {
+                value = static_cast<uint8_t>(random());
+            }
+            image.frame.planes[i] = image.planes[i].data();
+            image.frame.strides[i] = strides[i];
+        }
+        image.frame.width = width;
+        image.frame.height = height;
+        return image;
+    }
+
+    // 半平面格式的输出跨距，宽度为奇数时交织的色度行比亮度行多一个字节
+    uint32_t SemiPlanarStride(uint32_t width)
+    {
+        return (width + 1) / CHROMA_DIVISOR * CHROMA_DIVISOR;
+    }
+
+    // 与ToSemiPlanar布局一致的逐像素转换
+    void ScalarSemiPlanar(const FrameConverter::SourceFrame &src, std::vector<uint8_t> &dst, bool vFirst)
+    {
+        uint32_t chromaWidth = (src.width + 1) / CHROMA_DIVISOR;
+        uint32_t chromaHeight = (src.height + 1) / CHROMA_DIVISOR;
+        uint32_t stride = SemiPlanarStride(src.width);
+        size_t lumaSize = static_cast<size_t>(stride) * src.height;
+        dst.resize(lumaSize + static_cast<size_t>(stride) * chromaHeight);
+        for (uint32_t row = 0; row < src.height; ++row) {
+            for (uint32_t col = 0; col < src.width; ++col) {
+                dst[static_cast<size_t>(row) * stride + col] = src.planes[0][row * src.strides[0] + col];
+            }
+        }
+        for (uint32_t row = 0; row < chromaHeight; ++row) {
+            FrameConverter::InterleaveRowScalar(src.planes[vFirst ? 2 : 1] + row * src.strides[vFirst ? 2 : 1],
+                src.planes[vFirst ? 1 : 2] + row * src.strides[vFirst ? 1 : 2],
+                dst.data() + lumaSize + static_cast<size_t>(row) * stride, chromaWidth);
+        }
+    }
+
+    void ScalarRgba(const FrameConverter::SourceFrame &src, std::vector<uint8_t> &dst)
+    {
+        size_t rowBytes = static_cast<size_t>(src.width) * FrameConverter::RGBA_BYTES_PER_PIXEL;
+        dst.resize(rowBytes * src.height);
+        for (uint32_t row = 0; row < src.height; ++row) {
+            FrameConverter::YuvToRgbaRowScalar(src.planes[0] + row * src.strides[0],
+                src.planes[1] + (row / CHROMA_DIVISOR) * src.strides[1],
+                src.planes[2] + (row / CHROMA_DIVISOR) * src.strides[2], dst.data() + row * rowBytes, src.width);
+        }
+    }
+
+    // 以紧凑跨距调用FrameConverter，format: 0 NV12，1 NV21，2 RGBA
+    uint32_t SimdConvert(const FrameConverter::SourceFrame &src, std::vector<uint8_t> &dst, int format)
+    {
+        size_t size = static_cast<size_t>(SemiPlanarStride(src.width)) * (src.height + 1) *
+            FrameConverter::RGBA_BYTES_PER_PIXEL;
+        dst.resize(size);
+        if (format == 2) {  // 2: RGBA
+            uint32_t filled = FrameConverter::ToRgba(src, dst.data(), src.width, static_cast<uint32_t>(size));
+            dst.resize(filled);
+            return filled;
+        }
+        uint32_t filled = FrameConverter::ToSemiPlanar(src, dst.data(), SemiPlanarStride(src.width), src.height,
+            static_cast<uint32_t>(size), format == 1);
+        dst.resize(filled);
+        return filled;
+    }
+
+    void ScalarConvert(const FrameConverter::SourceFrame &src, std::vector<uint8_t> &dst, int format)
+    {
+        if (format == 2) {  // 2: RGBA
+            ScalarRgba(src, dst);
+        } else {
+            ScalarSemiPlanar(src, dst, format == 1);
+        }
+    }
+
+    bool Verify(const FrameConverter::SourceFrame &src, const char *name, int format)
+    {
+        std::vector<uint8_t> expected;
+        std::vector<uint8_t> actual;
+        ScalarConvert(src, expected, format);
+        (void) SimdConvert(src, actual, format);
+        if (expected != actual) {
+            fprintf(stderr, "mismatch: %s %ux%u\n", name, src.width, src.height);
+            return false;
+        }
+        return true;
+    }
+
+    template <typename Convert>
+    double Run(uint32_t iterations, Convert convert)
+    {
+        Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            convert();
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::mt19937 random(1);
+    SourceImage image = BuildSource(options.width, options.height, random);
+    const char *names[] = {"nv12", "nv21", "rgba"};
+    constexpr int formatNum = 3;
+
+    bool ok = true;
+    for (uint32_t width : ODD_WIDTHS) {
+        SourceImage odd = BuildSource(width, options.height | 1, random);
+        for (int format = 0; format < formatNum; ++format) {
+            ok = Verify(odd.frame, names[format], format) && ok;
+        }
+    }
+
+    printf("%ux%u, %u iterations\n", options.width, options.height, options.iterations);
+    printf("%-8s %12s %12s %10s\n", "format", "scalar MP/s", "simd MP/s", "speedup");
+    double megaPixels = static_cast<double>(options.width) * options.height * options.iterations / PIXELS_PER_MP;
+    std::vector<uint8_t> output;
+    for (int format = 0; format < formatNum; ++format) {
+        ok = Verify(image.frame, names[format], format) && ok;
+        double scalarSeconds = Run(options.iterations, [&]() { ScalarConvert(image.frame, output, format); });
+        double simdSeconds = Run(options.iterations, [&]() { (void) SimdConvert(image.frame, output, format); });
+        printf("%-8s %12.1f %12.1f %9.2fx\n", names[format], megaPixels / scalarSeconds, megaPixels / simdSeconds,
+            scalarSeconds / simdSeconds);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
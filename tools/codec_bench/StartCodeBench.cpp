@@ -0,0 +1,239 @@
+/*
+ * 功能说明: 起始码查找微基准，以合成的高码率IDR帧（参数集加多个切片，负载已插入防竞争字节）对比逐字节查找与
+ *           StartCodeScanner，两者找到的NAL单元位置须完全一致，输出吞吐量与加速比；另以大量0x00的短码流在
+ *           每个起始位置与对齐偏移上逐位置核对SIMD查找与逐字节查找，覆盖分组边界与行尾处理
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "StartCodeScanner.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using NalList = std::vector<std::pair<size_t, size_t>>;    // 每个NAL单元的起始码位置与结束位置
+
+    constexpr uint32_t SLICES_PER_FRAME = 8;
+    constexpr uint32_t PARAM_SET_SIZE = 16;
+    constexpr uint8_t EMULATION_PREVENTION_BYTE = 0x03;
+    constexpr size_t STREAM_PADDING = 4;    // 逐字节查找在末尾会多读一个字节
+    constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+    // 短码流核对：长度覆盖多个SIMD分组及组尾，每个长度随机填充若干次
+    constexpr size_t EDGE_MAX_SIZE = 4 * StartCodeScanner::SIMD_WIDTH;
+    constexpr uint32_t EDGE_ROUNDS = 64;
+
+    struct BenchOptions {
+        uint32_t frames = 8;
+        uint32_t frameSize = 1024 * 1024;   // 1MB: 4K高码率IDR帧
+        uint32_t iterations = 50;
+    };
+
+    void PrintUsage(const char *name)
+    {
+        printf("usage: %s [--frames <n>] [--frame-size <bytes>] [--iterations <n>]\n", name);
+    }
+
+    bool ParseOptions(int argc, char **argv, BenchOptions &options)
+    {
+        for (int i = 1; i < argc; i += 2) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            uint32_t value = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 0));
+            if (value == 0) {
+                return false;
+            }
+            if (arg == "--frames") {
+                options.frames = value;
+            } else if (arg == "--frame-size") {
+                options.frameSize = value;
+            } else if (arg == "--iterations") {
+                options.iterations = value;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void AppendNal(std::vector<uint8_t> &stream, uint8_t header, size_t payloadSize, std::mt19937 &random, bool longCode)
+    {
+        if (longCode) {
+            stream.push_back(0);
+        }
+        stream.insert(stream.end(), {0, 0, 1, header});
+        uint32_t zeros = 0;
+        for (size_t i = 0; i < payloadSize; ++i) {
+            // 偏向0x00以产生较多防竞争字节，接近真实熵编码输出
+            uint8_t byte = (random() % 8 == 0) ? 0 : static_cast<uint8_t>(random());   // 8: 约1/8为0x00
+            if (zeros >= 2 && byte <= EMULATION_PREVENTION_BYTE) {  // 2: 连续两个0x00
+                stream.push_back(EMULATION_PREVENTION_BYTE);
+                zeros = 0;
+            }
+            stream.push_back(byte);
+            zeros = (byte == 0) ? zeros + 1 : 0;
+        }
+        if (zeros > 0) {
+            stream.push_back(EMULATION_PREVENTION_BYTE + 1);    // rbsp结尾不能为0x00
+        }
+    }
+
+    std::vector<uint8_t> BuildStream(const BenchOptions &options)
+    {
+        std::mt19937 random(1);
+        std::vector<uint8_t> stream;
+        stream.reserve(static_cast<size_t>(options.frames) * options.frameSize * 2);   // 2: 防竞争字节余量
+        for (uint32_t frame = 0; frame < options.frames; ++frame) {
+            AppendNal(stream, 0x67, PARAM_SET_SIZE, random, true);  // 0x67: SPS
+            AppendNal(stream, 0x68, PARAM_SET_SIZE, random, true);  // 0x68: PPS
+            for (uint32_t slice = 0; slice < SLICES_PER_FRAME; ++slice) {
+                AppendNal(stream, 0x65, options.frameSize / SLICES_PER_FRAME, random, slice == 0);  // 0x65: IDR
+            }
+        }
+        return stream;
+    }
+
+    // 与原VideoDecoderNetint::FindNalStartCode一致的逐字节查找
+    size_t ScalarFindStartCode(const uint8_t *data, size_t size, size_t from, size_t &codeLen)
+    {
+        size_t i = from;
+        while ((data[i] != 0x00 || data[i + 1] != 0x00 || data[i + 2] != 0x01) &&
+            (data[i] != 0x00 || data[i + 1] != 0x00 || data[i + 2] != 0x00 || data[i + 3] != 0x01)) {
+            i++;
+            if (i + StartCodeScanner::START_CODE_LEN > size) {
+                return size;
+            }
+        }
+        codeLen = (data[i + 2] == 0x01) ? StartCodeScanner::START_CODE_LEN : StartCodeScanner::START_CODE_LONG_LEN;
+        return i;
+    }
+
+    // 与原VideoDecoderNetint::FindNextNonVclNalu一致的逐字节查找
+    size_t ScalarFindNalEnd(const uint8_t *data, size_t size, size_t i)
+    {
+        while ((data[i] != 0x00 || data[i + 1] != 0x00 || data[i + 2] != 0x00) &&
+            (data[i] != 0x00 || data[i + 1] != 0x00 || data[i + 2] != 0x01)) {
+            i++;
+            if (i + StartCodeScanner::START_CODE_LEN > size) {
+                return size;
+            }
+        }
+        return i;
+    }
+
+    // 逐字节查找第一个0x000000或0x000001，不读取size之外的数据，作为FindZeroPair的参考结果
+    size_t ScalarFindZeroPair(const uint8_t *data, size_t size, size_t from)
+    {
+        for (size_t i = from; i + StartCodeScanner::START_CODE_LEN <= size; ++i) {
+            if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] <= 1) {
+                return i;
+            }
+        }
+        return size;
+    }
+
+    /**
+     * @功能描述: 以大部分为0x00、0x01的短码流核对FindZeroPair与逐字节查找，数据起始地址依次偏移0~15字节，
+     *           使候选落在SIMD分组的每个字节位置及分组之后的逐字节处理区
+     * @返回值: true 全部一致；false 存在不一致，已输出首个不一致的码流
+     */
+    bool VerifyEdgeCases()
+    {
+        std::mt19937 random(1);
+        const uint8_t alphabet[] = {0, 0, 0, 0, 1, 1, 2, 0xFF};
+        std::vector<uint8_t> buffer(EDGE_MAX_SIZE + StartCodeScanner::SIMD_WIDTH);
+        for (size_t size = 0; size <= EDGE_MAX_SIZE; ++size) {
+            for (uint32_t round = 0; round < EDGE_ROUNDS; ++round) {
+                uint8_t *data = buffer.data() + round % StartCodeScanner::SIMD_WIDTH;
+                for (size_t i = 0; i < size; ++i) {
+                    data[i] = alphabet[random() % sizeof(alphabet)];
+                }
+                for (size_t from = 0; from <= size; ++from) {
+                    size_t expected = ScalarFindZeroPair(data, size, from);
+                    size_t actual = StartCodeScanner::FindZeroPair(data, size, from);
+                    if (expected == actual) {
+                        continue;
+                    }
+                    fprintf(stderr, "mismatch: size %zu from %zu, scalar %zu, simd %zu, data", size, from,
+                        expected, actual);
+                    for (size_t i = 0; i < size; ++i) {
+                        fprintf(stderr, " %02x", data[i]);
+                    }
+                    fprintf(stderr, "\n");
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename FindStart, typename FindEnd>
+    NalList Walk(const std::vector<uint8_t> &stream, size_t size, FindStart findStart, FindEnd findEnd)
+    {
+        NalList nals;
+        size_t pos = 0;
+        while (pos + StartCodeScanner::START_CODE_LEN < size) {
+            size_t codeLen = 0;
+            size_t start = findStart(stream.data(), size, pos, codeLen);
+            if (start >= size || start + codeLen >= size) {
+                break;
+            }
+            size_t end = findEnd(stream.data(), size, start + codeLen);
+            nals.emplace_back(start, end);
+            pos = end;
+        }
+        return nals;
+    }
+
+    template <typename FindStart, typename FindEnd>
+    double Run(const char *name, const std::vector<uint8_t> &stream, size_t size, uint32_t iterations,
+        FindStart findStart, FindEnd findEnd, NalList &nals)
+    {
+        Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            nals = Walk(stream, size, findStart, findEnd);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        double throughput = (seconds > 0) ? size * static_cast<double>(iterations) / BYTES_PER_MB / seconds : 0;
+        printf("%-10s %10zu %12.1f %10.3f\n", name, nals.size(), throughput, seconds);
+        return seconds;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::vector<uint8_t> stream = BuildStream(options);
+    size_t size = stream.size();
+    stream.resize(size + STREAM_PADDING, 0xFF);
+
+    printf("%zu bytes, %u IDR frames\n", size, options.frames);
+    printf("%-10s %10s %12s %10s\n", "scanner", "nals", "MB/s", "time(s)");
+    NalList scalarNals;
+    NalList simdNals;
+    double scalarSeconds = Run("scalar", stream, size, options.iterations, ScalarFindStartCode, ScalarFindNalEnd,
+        scalarNals);
+    double simdSeconds = Run("simd", stream, size, options.iterations, StartCodeScanner::FindStartCode,
+        StartCodeScanner::FindNalEnd, simdNals);
+    if (simdSeconds > 0) {
+        printf("speedup    %.2fx\n", scalarSeconds / simdSeconds);
+    }
+    if (scalarNals != simdNals) {
+        fprintf(stderr, "mismatch: scalar found %zu nals, simd found %zu\n", scalarNals.size(), simdNals.size());
+        return EXIT_FAILURE;
+    }
+    if (!VerifyEdgeCases()) {
+        return EXIT_FAILURE;
+    }
+    printf("edge cases match up to %zu bytes\n", EDGE_MAX_SIZE);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,395 @@
+/*
+ * 功能说明: NETINT模拟库公共部分，包括环境变量配置、模拟设备表（资源分配、负载、设备句柄与编解码引擎占用时间）
+ *           与会话表，libxcoder与libxcoder_logan模拟库各自包含一份，设备状态仅在进程内有效
+ */
+#ifndef NETINT_SIM_H
+#define NETINT_SIM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+
+namespace NetintSim {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint64_t PIXELS_1080P = 1920 * 1080;
+    constexpr uint32_t LOAD_FULL = 100;
+    constexpr int DEVICE_NUM_MAX = 16;
+    constexpr int HANDLE_BASE = 1000;   // 模拟设备句柄起始值，避免与真实文件描述符混淆
+    constexpr uint32_t SESSION_ID_BASE = 1;
+
+    /**
+     * @功能描述: 读取整型环境变量
+     * @参数 [in] name: 环境变量名
+     * @参数 [in] minValue: 最小值
+     * @参数 [in] maxValue: 最大值
+     * @参数 [in] defaultValue: 未设置或超出范围时使用的值
+     * @返回值: 环境变量值
+     */
+    inline long GetEnvLong(const char *name, long minValue, long maxValue, long defaultValue)
+    {
+        const char *value = getenv(name);
+        if (value == nullptr || value[0] == '\0') {
+            return defaultValue;
+        }
+        char *end = nullptr;
+        long result = strtol(value, &end, 10);  // 10: 十进制
+        if (end == value || *end != '\0' || result < minValue || result > maxValue) {
+            fprintf(stderr, "netint sim: ignore invalid %s=%s\n", name, value);
+            return defaultValue;
+        }
+        return result;
+    }
+
+    // 模拟库配置，进程内首次使用时从环境变量读取
+    struct SimConfig {
+        int devices = 1;                    // NI_SIM_DEVICES: 模拟卡数量
+        int maxFps1080p = 240;              // NI_SIM_MAX_FPS_1080P: 单卡1080p处理帧率，决定引擎占用时间
+        int maxInstances = 32;              // NI_SIM_MAX_INSTANCES: 单卡最大实例数
+        long latencyUs = 4000;              // NI_SIM_LATENCY_US: 帧处理完成后到可读取的固定时延
+        long openLatencyUs = 0;             // NI_SIM_OPEN_LATENCY_US: 打开会话耗时
+        uint32_t queueDepth = 4;            // NI_SIM_QUEUE_DEPTH: 设备内最多未读取的帧数，超出时写入返回0
+        uint32_t backpressureEvery = 0;     // NI_SIM_BACKPRESSURE_EVERY: 每N次写入返回一次0，0表示不注入
+        uint64_t resolutionChangeAt = 0;    // NI_SIM_RESOLUTION_CHANGE_AT: 解码第N帧起分辨率变化，0表示不变化
+        uint32_t changeWidth = 0;           // NI_SIM_RESOLUTION_CHANGE_SIZE: 变化后的分辨率WxH，默认宽高减半
+        uint32_t changeHeight = 0;
+        uint32_t expectPoolAllocs = 0;      // NI_SIM_EXPECT_POOL_ALLOCS: 解码会话缓冲池应申请的缓冲数，0表示不检查
+
+        static const SimConfig &Get()
+        {
+            static const SimConfig config = Load();
+            return config;
+        }
+
+    private:
+        static SimConfig Load()
+        {
+            SimConfig config;
+            config.devices = static_cast<int>(GetEnvLong("NI_SIM_DEVICES", 1, DEVICE_NUM_MAX, config.devices));
+            config.maxFps1080p = static_cast<int>(GetEnvLong("NI_SIM_MAX_FPS_1080P", 1, 10000, config.maxFps1080p));
+            config.maxInstances = static_cast<int>(GetEnvLong("NI_SIM_MAX_INSTANCES", 1, 1024, config.maxInstances));
+            config.latencyUs = GetEnvLong("NI_SIM_LATENCY_US", 0, 10000000, config.latencyUs);
+            config.openLatencyUs = GetEnvLong("NI_SIM_OPEN_LATENCY_US", 0, 10000000, config.openLatencyUs);
+            config.queueDepth = static_cast<uint32_t>(GetEnvLong("NI_SIM_QUEUE_DEPTH", 1, 64, config.queueDepth));
+            config.backpressureEvery = static_cast<uint32_t>(GetEnvLong("NI_SIM_BACKPRESSURE_EVERY", 0, INT32_MAX, 0));
+            config.resolutionChangeAt = static_cast<uint64_t>(GetEnvLong("NI_SIM_RESOLUTION_CHANGE_AT", 0, INT32_MAX, 0));
+            config.expectPoolAllocs = static_cast<uint32_t>(GetEnvLong("NI_SIM_EXPECT_POOL_ALLOCS", 0, INT32_MAX, 0));
+            const char *size = getenv("NI_SIM_RESOLUTION_CHANGE_SIZE");
+            if (size != nullptr && sscanf(size, "%ux%u", &config.changeWidth, &config.changeHeight) != 2) {
+                fprintf(stderr, "netint sim: ignore invalid NI_SIM_RESOLUTION_CHANGE_SIZE=%s\n", size);
+                config.changeWidth = 0;
+                config.changeHeight = 0;
+            }
+            return config;
+        }
+    };
+
+    inline void SleepUs(long us)
+    {
+        if (us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+    }
+
+    inline uint32_t AlignUp(uint32_t value, uint32_t align)
+    {
+        return (value + align - 1) / align * align;
+    }
+
+    inline void *AllocAligned(size_t size, size_t alignment)
+    {
+        void *buffer = nullptr;
+        return (posix_memalign(&buffer, alignment, size) == 0) ? buffer : nullptr;
+    }
+
+    /**
+     * @功能描述: 模拟设备表，维护各卡资源分配、负载与设备句柄，并按像素率模拟编解码引擎的占用时间，
+     *            同一张卡上的会话共享引擎，满载时帧的完成时间依次后延
+     * @参数 DeviceInfo: ni_device_info_t或ni_logan_device_info_t
+     * @参数 DeviceContext: ni_device_context_t或ni_logan_device_context_t
+     */
+    template <typename DeviceInfo, typename DeviceContext>
+    class SimDeviceTable {
+    public:
+        static SimDeviceTable &GetInstance()
+        {
+            // 与资源池共享内存一样在进程退出时保持有效，进程退出阶段关闭的会话仍可访问设备信息与锁
+            static SimDeviceTable *table = new SimDeviceTable();
+            return *table;
+        }
+
+        int Count() const
+        {
+            return static_cast<int>(m_devices.size());
+        }
+
+        /**
+         * @功能描述: 列出设备信息
+         * @参数 [out] infos: 设备信息数组
+         * @参数 [in] maxCount: 数组长度
+         * @返回值: 设备数量
+         */
+        int ListInfos(DeviceInfo *infos, int maxCount)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            int count = std::min(Count(), maxCount);
+            for (int i = 0; i < count; ++i) {
+                infos[i] = m_devices[i]->info;
+            }
+            return count;
+        }
+
+        DeviceContext *GetContext(int guid)
+        {
+            if (guid < 0 || guid >= Count()) {
+                return nullptr;
+            }
+            auto ctx = new DeviceContext();
+            (void) snprintf(ctx->shm_name, sizeof(ctx->shm_name), "NI_SIM_SHM_%d", guid);
+            ctx->lock = m_devices[guid]->lockFd;
+            ctx->p_device_info = &m_devices[guid]->info;
+            return ctx;
+        }
+
+        static void FreeContext(DeviceContext *ctx)
+        {
+            delete ctx;
+        }
+
+        /**
+         * @功能描述: 在指定设备上分配实例
+         * @参数 [in] guid: 设备guid
+         * @参数 [in] width/height/framerate: 会话分辨率与帧率
+         * @参数 [out] load: 会话负载(像素/秒)
+         * @返回值: 设备上下文，设备不存在或实例已满时返回nullptr
+         */
+        DeviceContext *Allocate(int guid, int width, int height, int framerate, unsigned long *load)
+        {
+            if (guid < 0 || guid >= Count() || width <= 0 || height <= 0 || framerate <= 0) {
+                return nullptr;
+            }
+            unsigned long pixelRate = static_cast<unsigned long>(width) * height * framerate;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Device &device = *m_devices[guid];
+                DeviceInfo &info = device.info;
+                if (device.instances >= info.max_instance_cnt) {
+                    return nullptr;
+                }
+                ++device.instances;
+                info.xcode_load_pixel += pixelRate;
+                UpdateModelLoad(info);
+            }
+            if (load != nullptr) {
+                *load = pixelRate;
+            }
+            return GetContext(guid);
+        }
+
+        /**
+         * @功能描述: 按规则选择设备：按实例数或按模型负载选择最空闲且未满的设备
+         * @返回值: 设备guid，无可用设备时返回-1
+         */
+        int SelectDevice(bool byInstance)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            int best = -1;
+            for (int guid = 0; guid < Count(); ++guid) {
+                const Device &device = *m_devices[guid];
+                if (device.instances >= device.info.max_instance_cnt) {
+                    continue;
+                }
+                const Device *bestDevice = (best < 0) ? nullptr : m_devices[best].get();
+                if (bestDevice == nullptr || (byInstance ? device.instances < bestDevice->instances :
+                    device.info.model_load < bestDevice->info.model_load)) {
+                    best = guid;
+                }
+            }
+            return best;
+        }
+
+        void Release(DeviceContext *ctx, unsigned long load)
+        {
+            if (ctx == nullptr || ctx->p_device_info == nullptr) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Device &device = *m_devices[std::min(std::max(ctx->p_device_info->module_id, 0), Count() - 1)];
+            device.instances = std::max(device.instances - 1, 0);
+            DeviceInfo &info = device.info;
+            info.xcode_load_pixel = (info.xcode_load_pixel > load) ? info.xcode_load_pixel - load : 0;
+            UpdateModelLoad(info);
+        }
+
+        /**
+         * @功能描述: 发布设备负载与实例数，真实设备由周期性上报覆盖，模拟设备保持发布的值
+         */
+        void UpdateLoad(DeviceContext *ctx, int load, int swInstanceCnt)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ctx->p_device_info->load = std::min(std::max(load, 0), static_cast<int>(LOAD_FULL));
+            ctx->p_device_info->active_num_inst = std::max(swInstanceCnt, 0);
+        }
+
+        /**
+         * @功能描述: 打开设备
+         * @参数 [in] name: 块设备名
+         * @返回值: 设备句柄，设备不存在时返回-1
+         */
+        int Open(const char *name)
+        {
+            if (name == nullptr) {
+                return -1;
+            }
+            for (int guid = 0; guid < Count(); ++guid) {
+                if (strcmp(name, m_devices[guid]->info.blk_name) == 0) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    int handle = m_nextHandle++;
+                    m_handles[handle] = guid;
+                    return handle;
+                }
+            }
+            return -1;
+        }
+
+        void Close(int handle)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            (void) m_handles.erase(handle);
+        }
+
+        int GuidOf(int handle)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_handles.find(handle);
+            return (it == m_handles.end()) ? -1 : it->second;
+        }
+
+        /**
+         * @功能描述: 在设备引擎上排入一帧，引擎按1080p最大帧率折算的像素吞吐串行处理各会话的帧
+         * @参数 [in] guid: 设备guid
+         * @参数 [in] pixels: 帧像素数
+         * @返回值: 帧可读取的时间
+         */
+        Clock::time_point Schedule(int guid, uint64_t pixels)
+        {
+            const SimConfig &config = SimConfig::Get();
+            auto service = std::chrono::microseconds(pixels * 1000000 /
+                (PIXELS_1080P * static_cast<uint64_t>(config.maxFps1080p)));
+            Clock::time_point now = Clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Device &device = *m_devices[std::min(std::max(guid, 0), Count() - 1)];
+            device.busyUntil = std::max(device.busyUntil, now) + service;
+            return device.busyUntil + std::chrono::microseconds(config.latencyUs);
+        }
+
+    private:
+        struct Device {
+            DeviceInfo info {};
+            int instances = 0;      // 已分配实例数，active_num_inst仅反映发布的实例数
+            int lockFd = -1;        // 设备共享锁，与真实资源池一样以文件描述符表示，随进程退出关闭
+            Clock::time_point busyUntil {};
+        };
+
+        SimDeviceTable()
+        {
+            const SimConfig &config = SimConfig::Get();
+            for (int guid = 0; guid < config.devices; ++guid) {
+                auto device = std::make_unique<Device>();
+                DeviceInfo &info = device->info;
+                (void) snprintf(info.dev_name, sizeof(info.dev_name), "/dev/nvme%d", guid);
+                (void) snprintf(info.blk_name, sizeof(info.blk_name), "/dev/nvme%dn1", guid);
+                info.hw_id = 0;
+                info.module_id = guid;
+                info.max_fps_1080p = config.maxFps1080p;
+                info.max_instance_cnt = config.maxInstances;
+                info.supports_h264 = 1;
+                info.supports_h265 = 1;
+                // 锁文件创建后即删除，仅供flock使用
+                char lockPath[] = "/tmp/ni_sim_lck_XXXXXX";
+                device->lockFd = mkstemp(lockPath);
+                if (device->lockFd >= 0) {
+                    (void) unlink(lockPath);
+                }
+                m_devices.push_back(std::move(device));
+            }
+        }
+
+        void UpdateModelLoad(DeviceInfo &info) const
+        {
+            uint64_t capacity = PIXELS_1080P * static_cast<uint64_t>(info.max_fps_1080p);
+            info.model_load = static_cast<int>(std::min<uint64_t>(info.xcode_load_pixel * LOAD_FULL / capacity,
+                LOAD_FULL));
+        }
+
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<Device>> m_devices {};   // 设备信息地址需保持稳定，供设备上下文引用
+        std::unordered_map<int, int> m_handles {};
+        int m_nextHandle = HANDLE_BASE;
+    };
+
+    /**
+     * @功能描述: 模拟会话表，按会话ID保存会话状态
+     */
+    template <typename Session>
+    class SimSessionTable {
+    public:
+        static SimSessionTable &GetInstance()
+        {
+            static SimSessionTable table;
+            return table;
+        }
+
+        uint32_t Add(std::shared_ptr<Session> session)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            uint32_t id = m_nextId++;
+            m_sessions[id] = std::move(session);
+            return id;
+        }
+
+        std::shared_ptr<Session> Find(uint32_t id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_sessions.find(id);
+            return (it == m_sessions.end()) ? nullptr : it->second;
+        }
+
+        void Remove(uint32_t id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            (void) m_sessions.erase(id);
+        }
+
+    private:
+        SimSessionTable() = default;
+
+        std::mutex m_mutex;
+        std::unordered_map<uint32_t, std::shared_ptr<Session>> m_sessions {};
+        uint32_t m_nextId = SESSION_ID_BASE;
+    };
+
+    /**
+     * @功能描述: 判断写入是否应被拒绝（返回0字节），模拟设备输入队列满与注入的反压
+     * @参数 [in] writes: 本次写入序号（从1开始）
+     * @参数 [in] queued: 设备内未读取的帧数
+     * @参数 [in] depth: 设备队列深度
+     */
+    inline bool RejectWrite(uint64_t writes, size_t queued, uint32_t depth)
+    {
+        uint32_t every = SimConfig::Get().backpressureEvery;
+        return (every != 0 && writes % every == 0) || queued >= depth;
+    }
+}
+
+#endif  // NETINT_SIM_H
@@ -0,0 +1,617 @@
+/*
+ * 功能说明: libxcoder_logan模拟库，实现解码器使用的ni_logan_*接口，不依赖NETINT硬件。按码流中每帧首个切片
+ *           计数解码帧，未收到参数集前的帧丢弃；输出为灰色YUV420P图像，分辨率取自打开会话时配置的尺寸，
+ *           可配置在指定帧起改变输出分辨率；
+ *           设备时延、队列深度与写入反压通过环境变量配置，见NetintSim.h
+ */
+
+#include <deque>
+#include <new>
+#include "NetintSim.h"
+
+// 模拟库以隐藏符号编译，仅导出头文件中声明的NETINT接口
+#pragma GCC visibility push(default)
+#include "ni_device_api_logan.h"
+#include "ni_rsrc_api_logan.h"
+#pragma GCC visibility pop
+
+namespace {
+    using NetintSim::Clock;
+    using DeviceTable = NetintSim::SimDeviceTable<ni_logan_device_info_t, ni_logan_device_context_t>;
+
+    constexpr int Y_INDEX = 0;
+    constexpr int U_INDEX = 1;
+    constexpr int V_INDEX = 2;
+    constexpr int NUM_OF_PLANES = 3;
+    constexpr uint32_t CHROMA_DIVISOR = 2;
+    constexpr uint32_t WIDTH_ALIGN = 32;
+    constexpr uint32_t HEIGHT_ALIGN_H264 = 16;
+    constexpr uint32_t HEIGHT_ALIGN_H265 = 8;
+    constexpr uint32_t START_CODE_LEN = 3;
+    constexpr uint8_t CHROMA_GRAY = 0x80;
+    constexpr uint8_t FIRST_SLICE_FLAG = 0x80;  // first_mb_in_slice = 0 / first_slice_segment_in_pic_flag = 1
+    constexpr uint8_t RBSP_STOP_BYTE = 0x80;
+    constexpr uint32_t TAG_TRAILER_SIZE = 2;    // 模拟编码器在切片末尾写入的输入帧标记与结束字节
+    constexpr int H264_NAL_TYPE_MASK = 0x1F;
+    constexpr int H264_SLICE = 1;
+    constexpr int H264_IDR_SLICE = 5;
+    constexpr int H264_SPS = 7;
+    constexpr int H265_NAL_TYPE_MASK = 0x3F;
+    constexpr int H265_VCL_MAX = 31;
+    constexpr int H265_SPS = 33;
+
+    // 设备内已解码、尚未读取的帧
+    struct PendingFrame {
+        Clock::time_point ready {};
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint8_t luma = 0;       // 亮度平面的填充值
+    };
+
+    struct SimDecoder {
+        std::mutex mutex;
+        int guid = 0;
+        bool h264 = true;
+        uint32_t width = 0;         // 码流分辨率，打开会话时配置的尺寸
+        uint32_t height = 0;
+        bool headersSeen = false;   // 已收到参数集，之后的帧才能解码
+        std::deque<PendingFrame> queue {};
+        uint64_t writes = 0;
+        uint64_t pictures = 0;
+        uint64_t dropped = 0;
+        bool eosReceived = false;
+    };
+
+    using SessionTable = NetintSim::SimSessionTable<SimDecoder>;
+
+    // 帧缓冲池中的缓冲，buf须为首成员，dec_buf指向它
+    struct SimFrameBuffer {
+        ni_logan_buf_t buf {};
+        uint32_t size = 0;
+    };
+
+    // 解码帧缓冲池：与真实库一致，会话打开时创建，帧缓冲从池中取出、释放时归还，池空时新申请；
+    // pool须为首成员，dec_fme_buf_pool与缓冲的pool指向它
+    struct SimFramePool {
+        ni_logan_buf_pool_t pool {};
+        std::mutex mutex;
+        std::vector<SimFrameBuffer *> freeBuffers {};
+        uint32_t inUse = 0;
+        uint64_t allocated = 0;
+        uint64_t reused = 0;
+    };
+
+    SimFramePool *FramePoolOf(ni_logan_buf_pool_t *pool)
+    {
+        return reinterpret_cast<SimFramePool *>(pool);
+    }
+
+    void FreeFrameBuffer(SimFrameBuffer *buffer)
+    {
+        free(buffer->buf.buf);
+        delete buffer;
+    }
+
+    // 取出不小于size的缓冲，空闲缓冲大小不符（分辨率变化前申请）时释放
+    SimFrameBuffer *GetFrameBuffer(SimFramePool &framePool, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(framePool.mutex);
+        while (!framePool.freeBuffers.empty()) {
+            SimFrameBuffer *buffer = framePool.freeBuffers.back();
+            framePool.freeBuffers.pop_back();
+            if (buffer->size == size) {
+                ++framePool.inUse;
+                ++framePool.reused;
+                return buffer;
+            }
+            FreeFrameBuffer(buffer);
+        }
+        auto *buffer = new (std::nothrow) SimFrameBuffer;
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+        buffer->buf.buf = NetintSim::AllocAligned(size, NI_LOGAN_MEM_PAGE_ALIGNMENT);
+        if (buffer->buf.buf == nullptr) {
+            delete buffer;
+            return nullptr;
+        }
+        buffer->buf.pool = &framePool.pool;
+        buffer->size = size;
+        framePool.pool.buf_size = size;
+        ++framePool.pool.number_of_buffers;
+        ++framePool.inUse;
+        ++framePool.allocated;
+        return buffer;
+    }
+
+    void ReturnFrameBuffer(SimFrameBuffer *buffer)
+    {
+        SimFramePool &framePool = *FramePoolOf(buffer->buf.pool);
+        std::lock_guard<std::mutex> lock(framePool.mutex);
+        --framePool.inUse;
+        framePool.freeBuffers.push_back(buffer);
+    }
+
+    // 会话关闭时释放缓冲池，仍有缓冲未归还时保留缓冲池，避免归还时访问已释放的内存
+    void DestroyFramePool(ni_logan_session_context_t *p_ctx)
+    {
+        if (p_ctx->dec_fme_buf_pool == nullptr) {
+            return;
+        }
+        SimFramePool *framePool = FramePoolOf(p_ctx->dec_fme_buf_pool);
+        p_ctx->dec_fme_buf_pool = nullptr;
+        std::unique_lock<std::mutex> lock(framePool->mutex);
+        fprintf(stderr, "netint sim: decoder frame pool %llu buffers allocated, %llu reused\n",
+            static_cast<unsigned long long>(framePool->allocated), static_cast<unsigned long long>(framePool->reused));
+        uint32_t expected = NetintSim::SimConfig::Get().expectPoolAllocs;
+        if (expected != 0 && framePool->allocated != expected) {
+            fprintf(stderr, "netint sim: decoder frame pool allocation mismatch, %llu allocated, expected %u\n",
+                static_cast<unsigned long long>(framePool->allocated), expected);
+        }
+        if (framePool->inUse > 0) {
+            fprintf(stderr, "netint sim: %u decoder frame buffers not returned at session close\n", framePool->inUse);
+            return;
+        }
+        for (SimFrameBuffer *buffer : framePool->freeBuffers) {
+            FreeFrameBuffer(buffer);
+        }
+        lock.unlock();
+        delete framePool;
+    }
+
+    // 码流中的一帧：参数集与各帧的亮度填充值（按每帧首个切片计数）
+    struct ScanResult {
+        bool hasSps = false;
+        std::vector<uint8_t> pictures {};
+    };
+
+    // 模拟编码器输出的切片以输入帧的首个亮度样本加结束字节收尾，解码帧以结束字节前的一个字节填充亮度平面，
+    // 供测试核对解码输出与编码输入的对应关系；切片不以结束字节收尾时以灰色填充
+    uint8_t SliceLuma(const uint8_t *nal, uint32_t size)
+    {
+        if (size >= TAG_TRAILER_SIZE && nal[size - 1] == RBSP_STOP_BYTE) {
+            return nal[size - TAG_TRAILER_SIZE];
+        }
+        return CHROMA_GRAY;
+    }
+
+    ScanResult ScanPacket(const uint8_t *data, uint32_t size, bool h264)
+    {
+        ScanResult result;
+        const uint32_t headerLen = h264 ? 1 : 2;    // 2: H.265 NAL头长度
+        const uint8_t *slice = nullptr;
+        auto endSlice = [&result, &slice](const uint8_t *end) {
+            if (slice != nullptr) {
+                result.pictures.push_back(SliceLuma(slice, static_cast<uint32_t>(end - slice)));
+                slice = nullptr;
+            }
+        };
+        for (uint32_t i = 0; i + START_CODE_LEN + headerLen < size; ++i) {
+            if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1) {
+                continue;
+            }
+            // 4字节起始码的前导0不属于上一个NAL单元
+            endSlice((i > 0 && data[i - 1] == 0) ? data + i - 1 : data + i);
+            const uint8_t *nal = data + i + START_CODE_LEN;
+            int type = h264 ? (nal[0] & H264_NAL_TYPE_MASK) : ((nal[0] >> 1) & H265_NAL_TYPE_MASK);
+            bool vcl = h264 ? (type >= H264_SLICE && type <= H264_IDR_SLICE) : (type <= H265_VCL_MAX);
+            result.hasSps = result.hasSps || type == (h264 ? H264_SPS : H265_SPS);
+            if (vcl && (nal[headerLen] & FIRST_SLICE_FLAG) != 0) {
+                slice = nal;
+            }
+            i += START_CODE_LEN;
+        }
+        endSlice(data + size);
+        return result;
+    }
+
+    // 第resolutionChangeAt帧起输出分辨率变化
+    void PictureSize(const SimDecoder &decoder, uint64_t picture, uint32_t &width, uint32_t &height)
+    {
+        const NetintSim::SimConfig &config = NetintSim::SimConfig::Get();
+        width = decoder.width;
+        height = decoder.height;
+        if (config.resolutionChangeAt == 0 || picture < config.resolutionChangeAt) {
+            return;
+        }
+        width = (config.changeWidth != 0) ? config.changeWidth : (decoder.width / CHROMA_DIVISOR) & ~1U;
+        height = (config.changeHeight != 0) ? config.changeHeight : (decoder.height / CHROMA_DIVISOR) & ~1U;
+    }
+
+    uint32_t PlaneSize(int plane, uint32_t stride, uint32_t heightAligned)
+    {
+        return (plane == Y_INDEX) ? stride * heightAligned : stride * heightAligned / (CHROMA_DIVISOR * CHROMA_DIVISOR);
+    }
+}
+
+ni_logan_retcode_t ni_logan_decoder_init_default_params(ni_logan_encoder_params_t *p_param, int fps_num,
+    int fps_denom, long bit_rate, int width, int height)
+{
+    if (p_param == nullptr || fps_num <= 0 || fps_denom <= 0 || width <= 0 || height <= 0) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    (void) memset(p_param, 0, sizeof(*p_param));
+    p_param->fps_number = static_cast<uint32_t>(fps_num);
+    p_param->fps_denominator = static_cast<uint32_t>(fps_denom);
+    p_param->source_width = width;
+    p_param->source_height = height;
+    p_param->bitrate = static_cast<int>(bit_rate);
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_rsrc_list_devices(ni_logan_device_type_t device_type,
+    ni_logan_device_info_t *p_device_info, int *p_device_count)
+{
+    (void) device_type;
+    if (p_device_info == nullptr || p_device_count == nullptr) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    *p_device_count = DeviceTable::GetInstance().ListInfos(p_device_info, NetintSim::DEVICE_NUM_MAX);
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+void ni_logan_rsrc_free_device_context(ni_logan_device_context_t *p_ctxt)
+{
+    DeviceTable::FreeContext(p_ctxt);
+}
+
+ni_logan_device_context_t *ni_logan_rsrc_allocate_auto(ni_logan_device_type_t device_type, ni_alloc_rule_t rule,
+    ni_codec_t codec, int width, int height, int frame_rate, unsigned long *p_load)
+{
+    (void) device_type;
+    (void) codec;
+    DeviceTable &table = DeviceTable::GetInstance();
+    int guid = table.SelectDevice(rule == EN_ALLOC_LEAST_INSTANCE);
+    return table.Allocate(guid, width, height, frame_rate, p_load);
+}
+
+ni_logan_device_context_t *ni_logan_rsrc_allocate_direct(ni_logan_device_type_t device_type, int guid,
+    ni_codec_t codec, int width, int height, int frame_rate, unsigned long *p_load)
+{
+    (void) device_type;
+    (void) codec;
+    return DeviceTable::GetInstance().Allocate(guid, width, height, frame_rate, p_load);
+}
+
+void ni_logan_rsrc_release_resource(ni_logan_device_context_t *p_ctxt, ni_codec_t codec, unsigned long load)
+{
+    (void) codec;
+    DeviceTable::GetInstance().Release(p_ctxt, load);
+}
+
+int ni_logan_rsrc_update_device_load(ni_logan_device_context_t *p_ctxt, int load, int sw_instance_cnt,
+    const ni_logan_sw_instance_info_t sw_instance_info[])
+{
+    (void) sw_instance_info;
+    if (p_ctxt == nullptr || p_ctxt->p_device_info == nullptr) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    DeviceTable::GetInstance().UpdateLoad(p_ctxt, load, sw_instance_cnt);
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_device_handle_t ni_logan_device_open(const char *dev, uint32_t *p_max_io_size_out)
+{
+    if (p_max_io_size_out != nullptr) {
+        *p_max_io_size_out = NI_LOGAN_MAX_PACKET_SZ;
+    }
+    int handle = DeviceTable::GetInstance().Open(dev);
+    return (handle < 0) ? NI_INVALID_DEVICE_HANDLE : handle;
+}
+
+void ni_logan_device_close(ni_device_handle_t dev)
+{
+    DeviceTable::GetInstance().Close(dev);
+}
+
+void ni_logan_device_session_context_init(ni_logan_session_context_t *p_ctx)
+{
+    if (p_ctx == nullptr) {
+        return;
+    }
+    (void) memset(p_ctx, 0, sizeof(*p_ctx));
+    p_ctx->session_id = static_cast<uint32_t>(NI_LOGAN_INVALID_SESSION_ID);
+    p_ctx->device_handle = NI_INVALID_DEVICE_HANDLE;
+    p_ctx->blk_io_handle = NI_INVALID_DEVICE_HANDLE;
+    p_ctx->src_bit_depth = 8;   // 8: 默认8bit
+    p_ctx->bit_depth_factor = 1;
+}
+
+ni_logan_retcode_t ni_logan_device_session_open(ni_logan_session_context_t *p_ctx, ni_logan_device_type_t device_type)
+{
+    if (p_ctx == nullptr || p_ctx->p_session_config == nullptr || device_type != NI_LOGAN_DEVICE_TYPE_DECODER) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    int guid = DeviceTable::GetInstance().GuidOf(p_ctx->blk_io_handle);
+    if (guid < 0) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    const auto &params = *static_cast<const ni_logan_encoder_params_t *>(p_ctx->p_session_config);
+    p_ctx->p_leftover = malloc(NI_LOGAN_MAX_PACKET_SZ);
+    if (p_ctx->p_leftover == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_MEM_ALOC;
+    }
+    p_ctx->dec_fme_buf_pool = &(new SimFramePool)->pool;
+    auto decoder = std::make_shared<SimDecoder>();
+    decoder->guid = guid;
+    decoder->h264 = p_ctx->codec_format == NI_LOGAN_CODEC_FORMAT_H264;
+    decoder->width = static_cast<uint32_t>(params.source_width);
+    decoder->height = static_cast<uint32_t>(params.source_height);
+
+    NetintSim::SleepUs(NetintSim::SimConfig::Get().openLatencyUs);
+    p_ctx->session_id = SessionTable::GetInstance().Add(decoder);
+    p_ctx->prev_size = 0;
+    p_ctx->ready_to_close = 0;
+    p_ctx->active_video_width = 0;
+    p_ctx->active_video_height = 0;
+    p_ctx->frame_num = 0;
+    p_ctx->pkt_num = 0;
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_device_session_close(ni_logan_session_context_t *p_ctx, int eos_recieved,
+    ni_logan_device_type_t device_type)
+{
+    (void) eos_recieved;
+    (void) device_type;
+    if (p_ctx == nullptr) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    SessionTable::GetInstance().Remove(p_ctx->session_id);
+    DestroyFramePool(p_ctx);
+    free(p_ctx->p_leftover);
+    p_ctx->p_leftover = nullptr;
+    p_ctx->session_id = static_cast<uint32_t>(NI_LOGAN_INVALID_SESSION_ID);
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_device_session_flush(ni_logan_session_context_t *p_ctx, ni_logan_device_type_t device_type)
+{
+    (void) device_type;
+    std::shared_ptr<SimDecoder> decoder =
+        (p_ctx == nullptr) ? nullptr : SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (decoder == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_INVALID_SESSION;
+    }
+    std::lock_guard<std::mutex> lock(decoder->mutex);
+    decoder->eosReceived = true;
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_device_dec_session_flush(ni_logan_session_context_t *p_ctx)
+{
+    std::shared_ptr<SimDecoder> decoder =
+        (p_ctx == nullptr) ? nullptr : SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (decoder == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_INVALID_SESSION;
+    }
+    // 清空设备内的帧与EOS状态，已保存的参数集保留，之后的帧无需重新发送参数集
+    std::lock_guard<std::mutex> lock(decoder->mutex);
+    decoder->queue.clear();
+    decoder->eosReceived = false;
+    p_ctx->ready_to_close = 0;
+    p_ctx->prev_size = 0;
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_device_dec_session_save_hdrs(ni_logan_session_context_t *p_ctx, uint8_t *hdr_data,
+    uint8_t hdr_size)
+{
+    std::shared_ptr<SimDecoder> decoder =
+        (p_ctx == nullptr) ? nullptr : SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (decoder == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_INVALID_SESSION;
+    }
+    if (hdr_data == nullptr || hdr_size == 0) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(decoder->mutex);
+    decoder->headersSeen = true;
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+int ni_logan_device_session_write(ni_logan_session_context_t *p_ctx, ni_logan_session_data_io_t *p_data,
+    ni_logan_device_type_t device_type)
+{
+    if (p_ctx == nullptr || p_data == nullptr || device_type != NI_LOGAN_DEVICE_TYPE_DECODER) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    std::shared_ptr<SimDecoder> decoder = SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (decoder == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_INVALID_SESSION;
+    }
+    const ni_logan_packet_t &packet = p_data->data.packet;
+    std::lock_guard<std::mutex> lock(decoder->mutex);
+    if (packet.data_len == 0 || packet.p_data == nullptr) {
+        decoder->eosReceived = decoder->eosReceived || packet.end_of_stream != 0;
+        return 0;
+    }
+    if (NetintSim::RejectWrite(++decoder->writes, decoder->queue.size(), NetintSim::SimConfig::Get().queueDepth)) {
+        return 0;
+    }
+    ScanResult scan = ScanPacket(static_cast<const uint8_t *>(packet.p_data), packet.data_len, decoder->h264);
+    decoder->headersSeen = decoder->headersSeen || scan.hasSps;
+    for (uint8_t luma : scan.pictures) {
+        if (!decoder->headersSeen) {
+            ++decoder->dropped;
+            continue;
+        }
+        PendingFrame frame;
+        frame.luma = luma;
+        PictureSize(*decoder, ++decoder->pictures, frame.width, frame.height);
+        frame.ready = DeviceTable::GetInstance().Schedule(decoder->guid,
+            static_cast<uint64_t>(frame.width) * frame.height);
+        decoder->queue.push_back(frame);
+    }
+    decoder->eosReceived = decoder->eosReceived || packet.end_of_stream != 0;
+    ++p_ctx->pkt_num;
+    return static_cast<int>(packet.data_len);
+}
+
+int ni_logan_device_session_read(ni_logan_session_context_t *p_ctx, ni_logan_session_data_io_t *p_data,
+    ni_logan_device_type_t device_type)
+{
+    if (p_ctx == nullptr || p_data == nullptr || device_type != NI_LOGAN_DEVICE_TYPE_DECODER) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    std::shared_ptr<SimDecoder> decoder = SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (decoder == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_INVALID_SESSION;
+    }
+    ni_logan_frame_t &frame = p_data->data.frame;
+    std::lock_guard<std::mutex> lock(decoder->mutex);
+    frame.end_of_stream = 0;
+    if (decoder->queue.empty()) {
+        if (decoder->eosReceived) {
+            frame.end_of_stream = 1;
+            p_ctx->ready_to_close = 1;
+        }
+        return 0;
+    }
+    const PendingFrame pending = decoder->queue.front();
+    if (Clock::now() < pending.ready) {
+        return 0;
+    }
+    // 分辨率首次确定或发生变化时更新会话分辨率，调用方按新分辨率分配输出缓冲后再读取；
+    // 与硬件一致，帧高度为按编码块对齐后的高度，实际图像大小由裁剪区域给出
+    uint32_t stride = NetintSim::AlignUp(pending.width, WIDTH_ALIGN) * static_cast<uint32_t>(p_ctx->bit_depth_factor);
+    uint32_t heightAligned = NetintSim::AlignUp(pending.height, decoder->h264 ? HEIGHT_ALIGN_H264 : HEIGHT_ALIGN_H265);
+    p_ctx->active_video_width = pending.width;
+    p_ctx->active_video_height = heightAligned;
+    uint32_t totalSize = 0;
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        totalSize += PlaneSize(i, stride, heightAligned);
+    }
+    if (frame.p_buffer == nullptr || frame.buffer_size < totalSize ||
+        frame.video_width != pending.width || frame.video_height != heightAligned) {
+        return 0;
+    }
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        (void) memset(frame.p_data[i], (i == Y_INDEX) ? pending.luma : CHROMA_GRAY, PlaneSize(i, stride, heightAligned));
+    }
+    decoder->queue.pop_front();
+    frame.video_width = pending.width;
+    frame.video_height = heightAligned;
+    frame.crop_top = 0;
+    frame.crop_left = 0;
+    frame.crop_right = pending.width;
+    frame.crop_bottom = pending.height;
+    frame.bit_depth = static_cast<uint16_t>(p_ctx->src_bit_depth);
+    frame.end_of_stream = (decoder->queue.empty() && decoder->eosReceived) ? 1 : 0;
+    ++p_ctx->frame_num;
+    return static_cast<int>(totalSize);
+}
+
+ni_logan_retcode_t ni_logan_packet_buffer_alloc(ni_logan_packet_t *ppacket, int packet_size)
+{
+    if (ppacket == nullptr || packet_size <= 0) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    uint32_t bufferSize = NetintSim::AlignUp(static_cast<uint32_t>(packet_size), NI_LOGAN_MEM_PAGE_ALIGNMENT);
+    (void) ni_logan_packet_buffer_free(ppacket);
+    ppacket->p_buffer = NetintSim::AllocAligned(bufferSize, NI_LOGAN_MEM_PAGE_ALIGNMENT);
+    if (ppacket->p_buffer == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_MEM_ALOC;
+    }
+    ppacket->buffer_size = bufferSize;
+    ppacket->p_data = ppacket->p_buffer;
+    ppacket->data_len = static_cast<uint32_t>(packet_size);
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_packet_buffer_free(ni_logan_packet_t *ppacket)
+{
+    if (ppacket == nullptr) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    free(ppacket->p_buffer);
+    ppacket->p_buffer = nullptr;
+    ppacket->p_data = nullptr;
+    ppacket->buffer_size = 0;
+    ppacket->data_len = 0;
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+int ni_logan_packet_copy(void *p_destination, const void * const p_source, int cur_size, void *p_leftover,
+    int *p_prev_size)
+{
+    if (p_destination == nullptr || p_prev_size == nullptr || cur_size < 0 ||
+        (cur_size > 0 && p_source == nullptr) || (*p_prev_size > 0 && p_leftover == nullptr)) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    // 先拷贝上次遗留的数据，再拷贝本次数据
+    uint8_t *dst = static_cast<uint8_t *>(p_destination);
+    int prevSize = *p_prev_size;
+    if (prevSize > 0) {
+        (void) memcpy(dst, p_leftover, prevSize);
+    }
+    if (cur_size > 0) {
+        (void) memcpy(dst + prevSize, p_source, cur_size);
+    }
+    *p_prev_size = 0;
+    return prevSize + cur_size;
+}
+
+ni_logan_retcode_t ni_logan_decoder_frame_buffer_alloc(ni_logan_buf_pool_t *p_pool, ni_logan_frame_t *pframe,
+    int alloc_mem, int video_width, int video_height, int alignment, int factor)
+{
+    if (pframe == nullptr || video_width <= 0 || video_height <= 0 || factor <= 0) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    // alignment非0表示H.264，高度按16对齐，否则按8对齐
+    uint32_t stride = NetintSim::AlignUp(static_cast<uint32_t>(video_width), WIDTH_ALIGN) *
+        static_cast<uint32_t>(factor);
+    uint32_t heightAligned = NetintSim::AlignUp(static_cast<uint32_t>(video_height),
+        (alignment != 0) ? HEIGHT_ALIGN_H264 : HEIGHT_ALIGN_H265);
+    uint32_t planeSize[NUM_OF_PLANES];
+    uint32_t totalSize = 0;
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        planeSize[i] = PlaneSize(i, stride, heightAligned);
+        totalSize += planeSize[i];
+    }
+    (void) ni_logan_decoder_frame_buffer_free(pframe);
+    pframe->video_width = static_cast<uint32_t>(video_width);
+    pframe->video_height = static_cast<uint32_t>(video_height);
+    // 分辨率尚未确定时不分配内存，仅读取码流信息
+    if (alloc_mem == 0) {
+        return NI_LOGAN_RETCODE_SUCCESS;
+    }
+    if (p_pool == nullptr) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    SimFrameBuffer *frameBuffer = GetFrameBuffer(*FramePoolOf(p_pool), totalSize);
+    if (frameBuffer == nullptr) {
+        return NI_LOGAN_RETCODE_ERROR_MEM_ALOC;
+    }
+    pframe->dec_buf = &frameBuffer->buf;
+    pframe->p_buffer = frameBuffer->buf.buf;
+    pframe->buffer_size = totalSize;
+    uint8_t *buffer = static_cast<uint8_t *>(pframe->p_buffer);
+    pframe->p_data[Y_INDEX] = buffer;
+    pframe->p_data[U_INDEX] = buffer + planeSize[Y_INDEX];
+    pframe->p_data[V_INDEX] = buffer + planeSize[Y_INDEX] + planeSize[U_INDEX];
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        pframe->data_len[i] = planeSize[i];
+    }
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
+
+ni_logan_retcode_t ni_logan_decoder_frame_buffer_free(ni_logan_frame_t *pframe)
+{
+    if (pframe == nullptr) {
+        return NI_LOGAN_RETCODE_INVALID_PARAM;
+    }
+    if (pframe->dec_buf != nullptr) {
+        ReturnFrameBuffer(reinterpret_cast<SimFrameBuffer *>(pframe->dec_buf));
+    } else {
+        free(pframe->p_buffer);
+    }
+    pframe->p_buffer = nullptr;
+    pframe->buffer_size = 0;
+    pframe->dec_buf = nullptr;
+    for (int i = 0; i < NI_LOGAN_MAX_NUM_DATA_POINTERS; ++i) {
+        pframe->p_data[i] = nullptr;
+        pframe->data_len[i] = 0;
+    }
+    return NI_LOGAN_RETCODE_SUCCESS;
+}
@@ -0,0 +1,773 @@
+/*
+ * 功能说明: libxcoder模拟库，实现编码器使用的ni_*接口，不依赖NETINT硬件。编码输出为Annex-B码流，与设备一致
+ *           仅在会话首帧、帧上要求重发或repeatHeaders为每个I帧时输出SPS/PPS(/VPS)，切片内容为填充数据，仅保证NAL结构、帧类型与码率大小合理，切片末尾带输入帧的首个亮度样本；
+ *           设备时延、队列深度与写入反压通过环境变量配置，见NetintSim.h
+ */
+
+#include <deque>
+#include <functional>
+#include "NetintSim.h"
+
+// 模拟库以隐藏符号编译，仅导出头文件中声明的NETINT接口
+#pragma GCC visibility push(default)
+#include "ni_device_api.h"
+#include "ni_rsrc_api.h"
+
+extern "C" {
+void ni_get_hw_yuv420p_dim(int width, int height, int bitDepthFactor, int isH264,
+    int planeStride[NI_MAX_NUM_DATA_POINTERS], int planeHeight[NI_MAX_NUM_DATA_POINTERS]);
+void ni_copy_hw_yuv420p(uint8_t *dstPtr[NI_MAX_NUM_DATA_POINTERS], uint8_t *srcPtr[NI_MAX_NUM_DATA_POINTERS],
+    int frameWidth, int frameHeight, int bitDepthFactor, int dstStride[NI_MAX_NUM_DATA_POINTERS],
+    int dstHeight[NI_MAX_NUM_DATA_POINTERS], int srcStride[NI_MAX_NUM_DATA_POINTERS],
+    int srcHeight[NI_MAX_NUM_DATA_POINTERS]);
+}
+#pragma GCC visibility pop
+
+namespace {
+    using NetintSim::Clock;
+    using DeviceTable = NetintSim::SimDeviceTable<ni_device_info_t, ni_device_context_t>;
+
+    constexpr int Y_INDEX = 0;
+    constexpr int U_INDEX = 1;
+    constexpr int V_INDEX = 2;
+    constexpr int NUM_OF_PLANES = 3;
+    constexpr int CHROMA_DIVISOR = 2;
+    constexpr uint32_t WIDTH_ALIGN = 32;
+    constexpr uint32_t HEIGHT_ALIGN_H264 = 16;
+    constexpr uint32_t HEIGHT_ALIGN_H265 = 8;
+    constexpr uint32_t MB_SIZE = 16;
+    constexpr uint32_t MIN_CB_SIZE = 8;
+    constexpr uint32_t BITS_PER_BYTE = 8;
+    constexpr uint32_t IDR_SIZE_RATIO = 3;      // IDR帧大小约为P帧的3倍
+    constexpr uint32_t MIN_PAYLOAD_SIZE = 16;
+    constexpr uint8_t SLICE_HEADER_BYTE = 0x88; // 最高位为1: first_mb_in_slice = 0 / first_slice_segment_in_pic_flag = 1
+    constexpr uint8_t SLICE_FILL_BYTE = 0xAA;   // 填充字节不含0x00，不会构成起始码
+    constexpr uint8_t RBSP_STOP_BYTE = 0x80;    // 切片以输入帧标记加结束字节收尾，标记为0x00时也不会构成起始码
+    constexpr size_t TAG_TRAILER_SIZE = 2;
+    constexpr int DEFAULT_INTRA_PERIOD = 92;
+    constexpr int DEFAULT_GOP_PRESET = 5;
+    constexpr int DEFAULT_RC_INIT_DELAY = 3000;
+    constexpr int DEFAULT_MIN_QP = 8;
+    constexpr int DEFAULT_MAX_QP = 51;
+    constexpr int DEFAULT_INTRA_QP = 22;
+    constexpr int PROFILE_HIGH = 100;
+
+    // H.264/H.265 NAL头
+    const std::vector<uint8_t> H264_SPS_HEADER = { 0x67 };
+    const std::vector<uint8_t> H264_PPS_HEADER = { 0x68 };
+    const std::vector<uint8_t> H264_IDR_HEADER = { 0x65 };
+    const std::vector<uint8_t> H264_P_HEADER = { 0x41 };
+    const std::vector<uint8_t> H265_VPS_HEADER = { 0x40, 0x01 };
+    const std::vector<uint8_t> H265_SPS_HEADER = { 0x42, 0x01 };
+    const std::vector<uint8_t> H265_PPS_HEADER = { 0x44, 0x01 };
+    const std::vector<uint8_t> H265_IDR_HEADER = { 0x26, 0x01 };   // IDR_W_RADL
+    const std::vector<uint8_t> H265_P_HEADER = { 0x02, 0x01 };     // TRAIL_R
+    const std::vector<uint8_t> START_CODE = { 0x00, 0x00, 0x00, 0x01 };
+
+    // RBSP比特写入，支持无符号/有符号指数哥伦布编码
+    class BitWriter {
+    public:
+        void PutBits(uint64_t value, int count)
+        {
+            for (int i = count - 1; i >= 0; --i) {
+                PutBit(static_cast<uint32_t>((value >> i) & 1));
+            }
+        }
+
+        void PutBit(uint32_t bit)
+        {
+            m_cur = static_cast<uint8_t>((m_cur << 1) | bit);
+            if (++m_bits == BITS_PER_BYTE) {
+                m_data.push_back(m_cur);
+                m_cur = 0;
+                m_bits = 0;
+            }
+        }
+
+        void PutUe(uint32_t value)
+        {
+            uint64_t codeNum = static_cast<uint64_t>(value) + 1;
+            int len = 0;
+            for (uint64_t v = codeNum; v != 0; v >>= 1) {
+                ++len;
+            }
+            PutBits(0, len - 1);
+            PutBits(codeNum, len);
+        }
+
+        void PutSe(int32_t value)
+        {
+            PutUe((value <= 0) ? static_cast<uint32_t>(-2 * value) : static_cast<uint32_t>(2 * value - 1));
+        }
+
+        // 写入rbsp_trailing_bits并返回RBSP
+        std::vector<uint8_t> Finish()
+        {
+            PutBit(1);
+            while (m_bits != 0) {
+                PutBit(0);
+            }
+            return m_data;
+        }
+
+    private:
+        std::vector<uint8_t> m_data {};
+        uint8_t m_cur = 0;
+        uint32_t m_bits = 0;
+    };
+
+    // 追加一个NAL单元，RBSP中插入防竞争字节
+    void AppendNal(std::vector<uint8_t> &out, const std::vector<uint8_t> &header, const std::vector<uint8_t> &rbsp)
+    {
+        out.insert(out.end(), START_CODE.begin(), START_CODE.end());
+        out.insert(out.end(), header.begin(), header.end());
+        int zeros = 0;
+        for (uint8_t byte : rbsp) {
+            if (zeros >= 2 && byte <= 0x03) {   // 2: 连续两个0x00后需插入0x03
+                out.push_back(0x03);
+                zeros = 0;
+            }
+            out.push_back(byte);
+            zeros = (byte == 0) ? zeros + 1 : 0;
+        }
+    }
+
+    struct StreamInfo {
+        uint32_t codedWidth = 0;    // 编码宽高（已对齐）
+        uint32_t codedHeight = 0;
+        uint32_t cropRight = 0;     // 裁剪像素数
+        uint32_t cropBottom = 0;
+        uint32_t framerate = 0;
+        int profile = 0;
+    };
+
+    std::vector<uint8_t> BuildH264Headers(const StreamInfo &info)
+    {
+        const int profile = (info.profile == 0) ? 66 : info.profile;  // 66: Baseline
+        BitWriter sps;
+        sps.PutBits(profile, BITS_PER_BYTE);
+        sps.PutBits((profile == 66) ? 0xC0 : 0x00, BITS_PER_BYTE);   // constraint_set0/1_flag
+        sps.PutBits((info.codedWidth * info.codedHeight > 2048 * 1088) ? 51 : 40, BITS_PER_BYTE);  // level 5.1 / 4.0
+        sps.PutUe(0);                   // seq_parameter_set_id
+        if (profile == PROFILE_HIGH) {
+            sps.PutUe(1);               // chroma_format_idc: 4:2:0
+            sps.PutUe(0);               // bit_depth_luma_minus8
+            sps.PutUe(0);               // bit_depth_chroma_minus8
+            sps.PutBit(0);              // qpprime_y_zero_transform_bypass_flag
+            sps.PutBit(0);              // seq_scaling_matrix_present_flag
+        }
+        sps.PutUe(0);                   // log2_max_frame_num_minus4
+        sps.PutUe(2);                   // pic_order_cnt_type: 2, 与useLowDelayPocType一致
+        sps.PutUe(1);                   // max_num_ref_frames
+        sps.PutBit(0);                  // gaps_in_frame_num_value_allowed_flag
+        sps.PutUe(info.codedWidth / MB_SIZE - 1);
+        sps.PutUe(info.codedHeight / MB_SIZE - 1);
+        sps.PutBit(1);                  // frame_mbs_only_flag
+        sps.PutBit(1);                  // direct_8x8_inference_flag
+        bool crop = info.cropRight != 0 || info.cropBottom != 0;
+        sps.PutBit(crop ? 1 : 0);
+        if (crop) {                     // 4:2:0裁剪单位为2个像素
+            sps.PutUe(0);
+            sps.PutUe(info.cropRight / CHROMA_DIVISOR);
+            sps.PutUe(0);
+            sps.PutUe(info.cropBottom / CHROMA_DIVISOR);
+        }
+        sps.PutBit(1);                  // vui_parameters_present_flag
+        sps.PutBits(0, 4);              // 4: aspect_ratio/overscan/video_signal_type/chroma_loc_info_present_flag
+        sps.PutBit(1);                  // timing_info_present_flag
+        sps.PutBits(1, 32);             // 32: num_units_in_tick
+        sps.PutBits(static_cast<uint64_t>(info.framerate) * 2, 32);   // 32: time_scale，帧率 = time_scale / 2
+        sps.PutBit(1);                  // fixed_frame_rate_flag
+        sps.PutBits(0, 4);              // 4: nal/vcl_hrd_parameters_present, pic_struct_present, bitstream_restriction
+
+        BitWriter pps;
+        pps.PutUe(0);                   // pic_parameter_set_id
+        pps.PutUe(0);                   // seq_parameter_set_id
+        pps.PutBit(0);                  // entropy_coding_mode_flag
+        pps.PutBit(0);                  // bottom_field_pic_order_in_frame_present_flag
+        pps.PutUe(0);                   // num_slice_groups_minus1
+        pps.PutUe(0);                   // num_ref_idx_l0_default_active_minus1
+        pps.PutUe(0);                   // num_ref_idx_l1_default_active_minus1
+        pps.PutBit(0);                  // weighted_pred_flag
+        pps.PutBits(0, 2);              // 2: weighted_bipred_idc
+        pps.PutSe(0);                   // pic_init_qp_minus26
+        pps.PutSe(0);                   // pic_init_qs_minus26
+        pps.PutSe(0);                   // chroma_qp_index_offset
+        pps.PutBit(1);                  // deblocking_filter_control_present_flag
+        pps.PutBit(0);                  // constrained_intra_pred_flag
+        pps.PutBit(0);                  // redundant_pic_cnt_present_flag
+
+        std::vector<uint8_t> headers;
+        AppendNal(headers, H264_SPS_HEADER, sps.Finish());
+        AppendNal(headers, H264_PPS_HEADER, pps.Finish());
+        return headers;
+    }
+
+    void PutH265ProfileTierLevel(BitWriter &writer, uint32_t codedWidth, uint32_t codedHeight)
+    {
+        writer.PutBits(0, 2);           // 2: general_profile_space
+        writer.PutBit(0);               // general_tier_flag
+        writer.PutBits(1, 5);           // 5: general_profile_idc, Main
+        writer.PutBits(0x60000000, 32); // 32: general_profile_compatibility_flag[1..2]
+        writer.PutBit(1);               // general_progressive_source_flag
+        writer.PutBit(0);               // general_interlaced_source_flag
+        writer.PutBit(0);               // general_non_packed_constraint_flag
+        writer.PutBit(1);               // general_frame_only_constraint_flag
+        writer.PutBits(0, 44);          // 44: general_reserved_zero_43bits, general_inbld_flag
+        writer.PutBits((codedWidth * codedHeight > 2048 * 1088) ? 153 : 120, BITS_PER_BYTE);  // level 5.1 / 4.0
+    }
+
+    std::vector<uint8_t> BuildH265Headers(const StreamInfo &info)
+    {
+        BitWriter vps;
+        vps.PutBits(0, 4);              // 4: vps_video_parameter_set_id
+        vps.PutBit(1);                  // vps_base_layer_internal_flag
+        vps.PutBit(1);                  // vps_base_layer_available_flag
+        vps.PutBits(0, 6);              // 6: vps_max_layers_minus1
+        vps.PutBits(0, 3);              // 3: vps_max_sub_layers_minus1
+        vps.PutBit(1);                  // vps_temporal_id_nesting_flag
+        vps.PutBits(0xFFFF, 16);        // 16: vps_reserved_0xffff_16bits
+        PutH265ProfileTierLevel(vps, info.codedWidth, info.codedHeight);
+        vps.PutBit(1);                  // vps_sub_layer_ordering_info_present_flag
+        vps.PutUe(1);                   // vps_max_dec_pic_buffering_minus1
+        vps.PutUe(0);                   // vps_max_num_reorder_pics
+        vps.PutUe(0);                   // vps_max_latency_increase_plus1
+        vps.PutBits(0, 6);              // 6: vps_max_layer_id
+        vps.PutUe(0);                   // vps_num_layer_sets_minus1
+        vps.PutBit(1);                  // vps_timing_info_present_flag
+        vps.PutBits(1, 32);             // 32: vps_num_units_in_tick
+        vps.PutBits(info.framerate, 32);    // 32: vps_time_scale
+        vps.PutBit(0);                  // vps_poc_proportional_to_timing_flag
+        vps.PutUe(0);                   // vps_num_hrd_parameters
+        vps.PutBit(0);                  // vps_extension_flag
+
+        BitWriter sps;
+        sps.PutBits(0, 4);              // 4: sps_video_parameter_set_id
+        sps.PutBits(0, 3);              // 3: sps_max_sub_layers_minus1
+        sps.PutBit(1);                  // sps_temporal_id_nesting_flag
+        PutH265ProfileTierLevel(sps, info.codedWidth, info.codedHeight);
+        sps.PutUe(0);                   // sps_seq_parameter_set_id
+        sps.PutUe(1);                   // chroma_format_idc: 4:2:0
+        sps.PutUe(info.codedWidth);     // pic_width_in_luma_samples
+        sps.PutUe(info.codedHeight);    // pic_height_in_luma_samples
+        bool crop = info.cropRight != 0 || info.cropBottom != 0;
+        sps.PutBit(crop ? 1 : 0);       // conformance_window_flag
+        if (crop) {
+            sps.PutUe(0);
+            sps.PutUe(info.cropRight / CHROMA_DIVISOR);
+            sps.PutUe(0);
+            sps.PutUe(info.cropBottom / CHROMA_DIVISOR);
+        }
+        sps.PutUe(0);                   // bit_depth_luma_minus8
+        sps.PutUe(0);                   // bit_depth_chroma_minus8
+        sps.PutUe(4);                   // 4: log2_max_pic_order_cnt_lsb_minus4
+        sps.PutBit(1);                  // sps_sub_layer_ordering_info_present_flag
+        sps.PutUe(1);                   // sps_max_dec_pic_buffering_minus1
+        sps.PutUe(0);                   // sps_max_num_reorder_pics
+        sps.PutUe(0);                   // sps_max_latency_increase_plus1
+        sps.PutUe(0);                   // log2_min_luma_coding_block_size_minus3
+        sps.PutUe(3);                   // 3: log2_diff_max_min_luma_coding_block_size, CTB 64
+        sps.PutUe(0);                   // log2_min_luma_transform_block_size_minus2
+        sps.PutUe(3);                   // 3: log2_diff_max_min_luma_transform_block_size
+        sps.PutUe(0);                   // max_transform_hierarchy_depth_inter
+        sps.PutUe(0);                   // max_transform_hierarchy_depth_intra
+        sps.PutBit(0);                  // scaling_list_enabled_flag
+        sps.PutBit(0);                  // amp_enabled_flag
+        sps.PutBit(0);                  // sample_adaptive_offset_enabled_flag
+        sps.PutBit(0);                  // pcm_enabled_flag
+        sps.PutUe(0);                   // num_short_term_ref_pic_sets
+        sps.PutBit(0);                  // long_term_ref_pics_present_flag
+        sps.PutBit(0);                  // sps_temporal_mvp_enabled_flag
+        sps.PutBit(0);                  // strong_intra_smoothing_enabled_flag
+        sps.PutBit(1);                  // vui_parameters_present_flag
+        sps.PutBits(0, 8);              // 8: aspect_ratio ... default_display_window_flag
+        sps.PutBit(1);                  // vui_timing_info_present_flag
+        sps.PutBits(1, 32);             // 32: vui_num_units_in_tick
+        sps.PutBits(info.framerate, 32);    // 32: vui_time_scale
+        sps.PutBit(0);                  // vui_poc_proportional_to_timing_flag
+        sps.PutBit(0);                  // vui_hrd_parameters_present_flag
+        sps.PutBit(0);                  // bitstream_restriction_flag
+        sps.PutBit(0);                  // sps_extension_present_flag
+
+        BitWriter pps;
+        pps.PutUe(0);                   // pps_pic_parameter_set_id
+        pps.PutUe(0);                   // pps_seq_parameter_set_id
+        pps.PutBits(0, 7);              // 7: dependent_slice_segments ... cabac_init_present_flag
+        pps.PutUe(0);                   // num_ref_idx_l0_default_active_minus1
+        pps.PutUe(0);                   // num_ref_idx_l1_default_active_minus1
+        pps.PutSe(0);                   // init_qp_minus26
+        pps.PutBits(0, 3);              // 3: constrained_intra_pred, transform_skip, cu_qp_delta_enabled_flag
+        pps.PutSe(0);                   // pps_cb_qp_offset
+        pps.PutSe(0);                   // pps_cr_qp_offset
+        pps.PutBits(0, 10);             // 10: pps_slice_chroma_qp_offsets_present ... lists_modification_present_flag
+        pps.PutUe(0);                   // log2_parallel_merge_level_minus2
+        pps.PutBit(0);                  // slice_segment_header_extension_present_flag
+        pps.PutBit(0);                  // pps_extension_present_flag
+
+        std::vector<uint8_t> headers;
+        AppendNal(headers, H265_VPS_HEADER, vps.Finish());
+        AppendNal(headers, H265_SPS_HEADER, sps.Finish());
+        AppendNal(headers, H265_PPS_HEADER, pps.Finish());
+        return headers;
+    }
+
+    // 设备内已接收、尚未读取的帧
+    struct PendingPacket {
+        Clock::time_point ready {};
+        bool idr = false;
+        bool headers = false;   // 切片前输出参数集：会话首帧、帧上要求重发或repeatHeaders配置为每个I帧
+        uint8_t tag = 0;    // 输入帧的首个亮度样本，写在切片末尾，供测试核对输出与输入的对应关系
+    };
+
+    struct SimEncoder {
+        std::mutex mutex;
+        int guid = 0;
+        bool h264 = true;
+        uint32_t pixels = 0;
+        uint32_t framerate = 0;
+        uint32_t bitrate = 0;
+        uint32_t intraPeriod = 0;
+        bool lowDelay = false;
+        int repeatHeaders = NI_ENC_REPEAT_HEADERS_FIRST_IDR;
+        std::vector<uint8_t> headers {};
+        std::deque<PendingPacket> queue {};
+        uint64_t writes = 0;
+        uint64_t frames = 0;
+        bool eosReceived = false;
+    };
+
+    using SessionTable = NetintSim::SimSessionTable<SimEncoder>;
+
+    uint32_t PayloadSize(const SimEncoder &encoder, bool idr)
+    {
+        uint32_t avg = encoder.bitrate / BITS_PER_BYTE / std::max<uint32_t>(encoder.framerate, 1);
+        return std::max(idr ? avg * IDR_SIZE_RATIO : avg, MIN_PAYLOAD_SIZE);
+    }
+
+    void ApplyReconfig(SimEncoder &encoder, const ni_frame_t &frame)
+    {
+        if (frame.reconf_len < sizeof(ni_encoder_change_params_t) || frame.p_data[V_INDEX] == nullptr) {
+            return;
+        }
+        // 重配置参数位于V平面之后的帧元数据之后
+        const uint8_t *extraData = static_cast<const uint8_t *>(frame.p_data[V_INDEX]) + frame.data_len[V_INDEX];
+        ni_encoder_change_params_t params;
+        (void) memcpy(&params, extraData + NI_APP_ENC_FRAME_META_DATA_SIZE, sizeof(params));
+        if (params.bitRate > 0) {
+            encoder.bitrate = static_cast<uint32_t>(params.bitRate);
+        }
+        if (params.intraPeriod > 0) {
+            encoder.intraPeriod = static_cast<uint32_t>(params.intraPeriod);
+        }
+    }
+
+    const std::unordered_map<std::string, std::function<void(ni_encoder_params_t &, int)>> PARAM_SETTERS = {
+        { "profile", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.profile = v; } },
+        { "gopPresetIdx", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.gop_preset_index = v; } },
+        { "lowDelay", [](ni_encoder_params_t &p, int v) { p.low_delay_mode = v; } },
+        { "RcEnable", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.rc.enable_rate_control = v; } },
+        { "useLowDelayPocType", [](ni_encoder_params_t &p, int v) { p.use_low_delay_poc_type = v; } },
+        { "intraPeriod", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.intra_period = v; } },
+        { "repeatHeaders", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.forced_header_enable = v; } },
+        { "bitrate", [](ni_encoder_params_t &p, int v) { p.bitrate = v; } },
+        { "frameRate", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.frame_rate = v; } },
+        { "RcInitDelay", [](ni_encoder_params_t &p, int v) { p.hevc_enc_params.rc.rc_init_delay = v; } },
+    };
+}
+
+ni_retcode_t ni_encoder_init_default_params(ni_encoder_params_t *p_param, int fps_num, int fps_denom,
+    long bit_rate, int width, int height)
+{
+    if (p_param == nullptr || fps_num <= 0 || fps_denom <= 0 || bit_rate <= 0 || width <= 0 || height <= 0) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    (void) memset(p_param, 0, sizeof(*p_param));
+    p_param->fps_number = static_cast<uint32_t>(fps_num);
+    p_param->fps_denominator = static_cast<uint32_t>(fps_denom);
+    p_param->source_width = width;
+    p_param->source_height = height;
+    p_param->bitrate = static_cast<int>(bit_rate);
+    ni_h265_encoder_params_t &hevc = p_param->hevc_enc_params;
+    hevc.frame_rate = fps_num / fps_denom;
+    hevc.gop_preset_index = DEFAULT_GOP_PRESET;
+    hevc.intra_period = DEFAULT_INTRA_PERIOD;
+    hevc.rc.rc_init_delay = DEFAULT_RC_INIT_DELAY;
+    hevc.rc.min_qp = DEFAULT_MIN_QP;
+    hevc.rc.max_qp = DEFAULT_MAX_QP;
+    hevc.rc.intra_qp = DEFAULT_INTRA_QP;
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_retcode_t ni_encoder_params_set_value(ni_encoder_params_t *p_params, const char *name, const char *value)
+{
+    if (p_params == nullptr || name == nullptr || value == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    auto setter = PARAM_SETTERS.find(name);
+    if (setter == PARAM_SETTERS.end()) {
+        return NI_RETCODE_PARAM_INVALID_NAME;
+    }
+    setter->second(*p_params, atoi(value));
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_retcode_t ni_rsrc_list_devices(ni_device_type_t device_type, ni_device_info_t *p_device_info,
+    int *p_device_count)
+{
+    (void) device_type;
+    if (p_device_info == nullptr || p_device_count == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    *p_device_count = DeviceTable::GetInstance().ListInfos(p_device_info, NetintSim::DEVICE_NUM_MAX);
+    return NI_RETCODE_SUCCESS;
+}
+
+void ni_rsrc_free_device_context(ni_device_context_t *p_ctxt)
+{
+    DeviceTable::FreeContext(p_ctxt);
+}
+
+ni_device_context_t *ni_rsrc_allocate_auto(ni_device_type_t device_type, ni_alloc_rule_t rule, ni_codec_t codec,
+    int width, int height, int frame_rate, unsigned long *p_load)
+{
+    (void) device_type;
+    (void) codec;
+    DeviceTable &table = DeviceTable::GetInstance();
+    int guid = table.SelectDevice(rule == EN_ALLOC_LEAST_INSTANCE);
+    return table.Allocate(guid, width, height, frame_rate, p_load);
+}
+
+ni_device_context_t *ni_rsrc_allocate_direct(ni_device_type_t device_type, int guid, ni_codec_t codec,
+    int width, int height, int frame_rate, unsigned long *p_load)
+{
+    (void) device_type;
+    (void) codec;
+    return DeviceTable::GetInstance().Allocate(guid, width, height, frame_rate, p_load);
+}
+
+void ni_rsrc_release_resource(ni_device_context_t *p_ctxt, ni_codec_t codec, unsigned long load)
+{
+    (void) codec;
+    DeviceTable::GetInstance().Release(p_ctxt, load);
+}
+
+int ni_rsrc_update_device_load(ni_device_context_t *p_ctxt, int load, int sw_instance_cnt,
+    const ni_sw_instance_info_t sw_instance_info[])
+{
+    (void) sw_instance_info;
+    if (p_ctxt == nullptr || p_ctxt->p_device_info == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    DeviceTable::GetInstance().UpdateLoad(p_ctxt, load, sw_instance_cnt);
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_device_handle_t ni_device_open(const char *dev, uint32_t *p_max_io_size_out)
+{
+    if (p_max_io_size_out != nullptr) {
+        *p_max_io_size_out = NI_MAX_PACKET_SZ;
+    }
+    int handle = DeviceTable::GetInstance().Open(dev);
+    return (handle < 0) ? NI_INVALID_DEVICE_HANDLE : handle;
+}
+
+void ni_device_close(ni_device_handle_t dev)
+{
+    DeviceTable::GetInstance().Close(dev);
+}
+
+void ni_device_session_context_init(ni_session_context_t *p_ctx)
+{
+    if (p_ctx == nullptr) {
+        return;
+    }
+    (void) memset(p_ctx, 0, sizeof(*p_ctx));
+    p_ctx->session_id = NI_INVALID_SESSION_ID;
+    p_ctx->device_handle = NI_INVALID_DEVICE_HANDLE;
+    p_ctx->blk_io_handle = NI_INVALID_DEVICE_HANDLE;
+    p_ctx->src_bit_depth = 8;   // 8: 默认8bit输入
+    p_ctx->bit_depth_factor = 1;
+}
+
+void ni_device_session_context_free(ni_session_context_t *p_ctx)
+{
+    (void) p_ctx;
+}
+
+ni_retcode_t ni_device_session_open(ni_session_context_t *p_ctx, ni_device_type_t device_type)
+{
+    if (p_ctx == nullptr || p_ctx->p_session_config == nullptr || device_type != NI_DEVICE_TYPE_ENCODER) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    int guid = DeviceTable::GetInstance().GuidOf(p_ctx->blk_io_handle);
+    if (guid < 0) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    const ni_encoder_params_t &params = *static_cast<const ni_encoder_params_t *>(p_ctx->p_session_config);
+    const ni_h265_encoder_params_t &hevc = params.hevc_enc_params;
+    auto encoder = std::make_shared<SimEncoder>();
+    encoder->guid = guid;
+    encoder->h264 = p_ctx->codec_format == NI_CODEC_FORMAT_H264;
+    encoder->framerate = std::max<uint32_t>(params.fps_number / std::max<uint32_t>(params.fps_denominator, 1), 1);
+    encoder->bitrate = static_cast<uint32_t>(std::max(params.bitrate, 0));
+    encoder->intraPeriod = static_cast<uint32_t>(std::max(hevc.intra_period, 0));
+    encoder->lowDelay = params.low_delay_mode != 0;
+    encoder->repeatHeaders = hevc.forced_header_enable;
+
+    StreamInfo info;
+    const uint32_t align = encoder->h264 ? MB_SIZE : MIN_CB_SIZE;
+    info.codedWidth = NetintSim::AlignUp(static_cast<uint32_t>(params.source_width), align);
+    info.codedHeight = NetintSim::AlignUp(static_cast<uint32_t>(params.source_height), align);
+    info.cropRight = info.codedWidth - static_cast<uint32_t>(params.source_width) +
+        static_cast<uint32_t>(std::max(hevc.conf_win_right, 0));
+    info.cropBottom = info.codedHeight - static_cast<uint32_t>(params.source_height) +
+        static_cast<uint32_t>(std::max(hevc.conf_win_bottom, 0));
+    info.framerate = encoder->framerate;
+    info.profile = hevc.profile;
+    encoder->pixels = info.codedWidth * info.codedHeight;
+    encoder->headers = encoder->h264 ? BuildH264Headers(info) : BuildH265Headers(info);
+
+    NetintSim::SleepUs(NetintSim::SimConfig::Get().openLatencyUs);
+    p_ctx->session_id = SessionTable::GetInstance().Add(encoder);
+    p_ctx->ready_to_close = 0;
+    p_ctx->frame_num = 0;
+    p_ctx->pkt_num = 0;
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_retcode_t ni_device_session_close(ni_session_context_t *p_ctx, int eos_recieved, ni_device_type_t device_type)
+{
+    (void) eos_recieved;
+    (void) device_type;
+    if (p_ctx == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    SessionTable::GetInstance().Remove(p_ctx->session_id);
+    p_ctx->session_id = NI_INVALID_SESSION_ID;
+    return NI_RETCODE_SUCCESS;
+}
+
+int ni_device_session_write(ni_session_context_t *p_ctx, ni_session_data_io_t *p_data, ni_device_type_t device_type)
+{
+    if (p_ctx == nullptr || p_data == nullptr || device_type != NI_DEVICE_TYPE_ENCODER) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    std::shared_ptr<SimEncoder> encoder = SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (encoder == nullptr) {
+        return NI_RETCODE_ERROR_INVALID_SESSION;
+    }
+    const ni_frame_t &frame = p_data->data.frame;
+    std::lock_guard<std::mutex> lock(encoder->mutex);
+    if (frame.end_of_stream != 0) {
+        encoder->eosReceived = true;
+        return 1;
+    }
+    if (frame.p_data[Y_INDEX] == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    // 低延时模式下设备只接收一帧，输出被读取后才能写入下一帧
+    uint32_t depth = encoder->lowDelay ? 1 : NetintSim::SimConfig::Get().queueDepth;
+    if (NetintSim::RejectWrite(++encoder->writes, encoder->queue.size(), depth)) {
+        return 0;
+    }
+    if (frame.reconf_len != 0) {
+        ApplyReconfig(*encoder, frame);
+    }
+    PendingPacket packet;
+    // 会话开启帧类型强制时按帧的图像类型编码，否则只响应force_key_frame
+    bool forced = (p_ctx->force_frame_type != 0) ? frame.ni_pict_type == PIC_TYPE_IDR : frame.force_key_frame != 0;
+    packet.idr = encoder->frames == 0 || forced ||
+        (encoder->intraPeriod != 0 && encoder->frames % encoder->intraPeriod == 0);
+    packet.headers = encoder->frames == 0 || frame.force_headers != 0 ||
+        (packet.idr && encoder->repeatHeaders == NI_ENC_REPEAT_HEADERS_ALL_I_FRAMES);
+    packet.ready = DeviceTable::GetInstance().Schedule(encoder->guid, encoder->pixels);
+    packet.tag = *static_cast<const uint8_t *>(frame.p_data[Y_INDEX]);
+    encoder->queue.push_back(packet);
+    ++encoder->frames;
+    ++p_ctx->frame_num;
+    return static_cast<int>(frame.data_len[Y_INDEX] + frame.data_len[U_INDEX] + frame.data_len[V_INDEX]);
+}
+
+int ni_device_session_read(ni_session_context_t *p_ctx, ni_session_data_io_t *p_data, ni_device_type_t device_type)
+{
+    if (p_ctx == nullptr || p_data == nullptr || device_type != NI_DEVICE_TYPE_ENCODER) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    std::shared_ptr<SimEncoder> encoder = SessionTable::GetInstance().Find(p_ctx->session_id);
+    if (encoder == nullptr) {
+        return NI_RETCODE_ERROR_INVALID_SESSION;
+    }
+    ni_packet_t &packet = p_data->data.packet;
+    std::lock_guard<std::mutex> lock(encoder->mutex);
+    packet.end_of_stream = 0;
+    if (encoder->queue.empty()) {
+        if (encoder->eosReceived) {
+            packet.end_of_stream = 1;
+            p_ctx->ready_to_close = 1;
+        }
+        return 0;
+    }
+    const PendingPacket pending = encoder->queue.front();
+    if (Clock::now() < pending.ready) {
+        return 0;
+    }
+    const std::vector<uint8_t> &sliceHeader = encoder->h264 ? (pending.idr ? H264_IDR_HEADER : H264_P_HEADER) :
+        (pending.idr ? H265_IDR_HEADER : H265_P_HEADER);
+    size_t prefix = NI_FW_ENC_BITSTREAM_META_DATA_SIZE + (pending.headers ? encoder->headers.size() : 0) +
+        START_CODE.size() + sliceHeader.size() + 1;
+    if (packet.p_data == nullptr || packet.buffer_size <= prefix) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    // 输出缓冲不足时截断切片数据
+    size_t payload = std::min<size_t>(PayloadSize(*encoder, pending.idr), packet.buffer_size - prefix);
+    uint8_t *out = static_cast<uint8_t *>(packet.p_data);
+    (void) memset(out, 0, NI_FW_ENC_BITSTREAM_META_DATA_SIZE);
+    out += NI_FW_ENC_BITSTREAM_META_DATA_SIZE;
+    if (pending.headers) {
+        out = std::copy(encoder->headers.begin(), encoder->headers.end(), out);
+    }
+    out = std::copy(START_CODE.begin(), START_CODE.end(), out);
+    out = std::copy(sliceHeader.begin(), sliceHeader.end(), out);
+    *out++ = SLICE_HEADER_BYTE;
+    (void) memset(out, SLICE_FILL_BYTE, payload);
+    if (payload >= TAG_TRAILER_SIZE) {
+        out[payload - TAG_TRAILER_SIZE] = pending.tag;
+        out[payload - 1] = RBSP_STOP_BYTE;
+    }
+    encoder->queue.pop_front();
+
+    packet.data_len = static_cast<uint32_t>(prefix + payload);
+    packet.frame_type = pending.idr ? PIC_TYPE_I : PIC_TYPE_P;
+    packet.end_of_stream = (encoder->queue.empty() && encoder->eosReceived) ? 1 : 0;
+    ++p_ctx->pkt_num;
+    return static_cast<int>(packet.data_len);
+}
+
+ni_retcode_t ni_frame_buffer_alloc_v3(ni_frame_t *pframe, int video_width, int video_height, int linesize[],
+    int alignment, int extra_len)
+{
+    if (pframe == nullptr || linesize == nullptr || video_width <= 0 || video_height <= 0 || extra_len < 0) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    // alignment非0表示H.264，高度按16对齐，否则按8对齐
+    uint32_t heightAligned = NetintSim::AlignUp(static_cast<uint32_t>(video_height),
+        (alignment != 0) ? HEIGHT_ALIGN_H264 : HEIGHT_ALIGN_H265);
+    uint32_t planeSize[NUM_OF_PLANES] = {
+        static_cast<uint32_t>(linesize[Y_INDEX]) * heightAligned,
+        static_cast<uint32_t>(linesize[U_INDEX]) * heightAligned / CHROMA_DIVISOR,
+        static_cast<uint32_t>(linesize[V_INDEX]) * heightAligned / CHROMA_DIVISOR
+    };
+    uint32_t bufferSize = NetintSim::AlignUp(planeSize[Y_INDEX] + planeSize[U_INDEX] + planeSize[V_INDEX] +
+        static_cast<uint32_t>(extra_len), NI_MEM_PAGE_ALIGNMENT);
+    if (pframe->p_buffer != nullptr && pframe->buffer_size < bufferSize) {
+        (void) ni_frame_buffer_free(pframe);
+    }
+    if (pframe->p_buffer == nullptr) {
+        pframe->p_buffer = NetintSim::AllocAligned(bufferSize, NI_MEM_PAGE_ALIGNMENT);
+        if (pframe->p_buffer == nullptr) {
+            return NI_RETCODE_ERROR_MEM_ALOC;
+        }
+        pframe->buffer_size = bufferSize;
+    }
+    uint8_t *buffer = static_cast<uint8_t *>(pframe->p_buffer);
+    pframe->p_data[Y_INDEX] = buffer;
+    pframe->p_data[U_INDEX] = buffer + planeSize[Y_INDEX];
+    pframe->p_data[V_INDEX] = buffer + planeSize[Y_INDEX] + planeSize[U_INDEX];
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        pframe->data_len[i] = planeSize[i];
+    }
+    pframe->video_width = static_cast<uint32_t>(video_width);
+    pframe->video_height = static_cast<uint32_t>(video_height);
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_retcode_t ni_frame_buffer_free(ni_frame_t *pframe)
+{
+    if (pframe == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    free(pframe->p_buffer);
+    pframe->p_buffer = nullptr;
+    pframe->buffer_size = 0;
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        pframe->p_data[i] = nullptr;
+        pframe->data_len[i] = 0;
+    }
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_retcode_t ni_packet_buffer_alloc(ni_packet_t *ppacket, int packet_size)
+{
+    if (ppacket == nullptr || packet_size <= 0) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    uint32_t bufferSize = NetintSim::AlignUp(static_cast<uint32_t>(packet_size), NI_MEM_PAGE_ALIGNMENT);
+    (void) ni_packet_buffer_free(ppacket);
+    ppacket->p_buffer = NetintSim::AllocAligned(bufferSize, NI_MEM_PAGE_ALIGNMENT);
+    if (ppacket->p_buffer == nullptr) {
+        return NI_RETCODE_ERROR_MEM_ALOC;
+    }
+    ppacket->buffer_size = bufferSize;
+    ppacket->p_data = ppacket->p_buffer;
+    ppacket->data_len = static_cast<uint32_t>(packet_size);
+    return NI_RETCODE_SUCCESS;
+}
+
+ni_retcode_t ni_packet_buffer_free(ni_packet_t *ppacket)
+{
+    if (ppacket == nullptr) {
+        return NI_RETCODE_INVALID_PARAM;
+    }
+    free(ppacket->p_buffer);
+    ppacket->p_buffer = nullptr;
+    ppacket->p_data = nullptr;
+    ppacket->buffer_size = 0;
+    ppacket->data_len = 0;
+    return NI_RETCODE_SUCCESS;
+}
+
+void ni_get_hw_yuv420p_dim(int width, int height, int bitDepthFactor, int isH264,
+    int planeStride[NI_MAX_NUM_DATA_POINTERS], int planeHeight[NI_MAX_NUM_DATA_POINTERS])
+{
+    int widthAligned = std::max(static_cast<int>(NetintSim::AlignUp(static_cast<uint32_t>(width), WIDTH_ALIGN)),
+        NI_MIN_WIDTH);
+    int heightAligned = std::max(static_cast<int>(NetintSim::AlignUp(static_cast<uint32_t>(height),
+        (isH264 != 0) ? HEIGHT_ALIGN_H264 : HEIGHT_ALIGN_H265)), NI_MIN_HEIGHT);
+    planeStride[Y_INDEX] = widthAligned * bitDepthFactor;
+    planeStride[U_INDEX] = widthAligned / CHROMA_DIVISOR * bitDepthFactor;
+    planeStride[V_INDEX] = planeStride[U_INDEX];
+    planeHeight[Y_INDEX] = heightAligned;
+    planeHeight[U_INDEX] = heightAligned / CHROMA_DIVISOR;
+    planeHeight[V_INDEX] = planeHeight[U_INDEX];
+}
+
+void ni_copy_hw_yuv420p(uint8_t *dstPtr[NI_MAX_NUM_DATA_POINTERS], uint8_t *srcPtr[NI_MAX_NUM_DATA_POINTERS],
+    int frameWidth, int frameHeight, int bitDepthFactor, int dstStride[NI_MAX_NUM_DATA_POINTERS],
+    int dstHeight[NI_MAX_NUM_DATA_POINTERS], int srcStride[NI_MAX_NUM_DATA_POINTERS],
+    int srcHeight[NI_MAX_NUM_DATA_POINTERS])
+{
+    // 逐行拷贝各平面，行尾以最后一个像素填充到硬件跨距，不足的行复制最后一行
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        int rowBytes = std::min(((i == Y_INDEX) ? frameWidth : frameWidth / CHROMA_DIVISOR) * bitDepthFactor,
+            std::min(srcStride[i], dstStride[i]));
+        int rows = std::min(std::min((i == Y_INDEX) ? frameHeight : frameHeight / CHROMA_DIVISOR, srcHeight[i]),
+            dstHeight[i]);
+        if (rowBytes <= 0 || rows <= 0) {
+            continue;
+        }
+        uint8_t *dst = dstPtr[i];
+        const uint8_t *src = srcPtr[i];
+        for (int row = 0; row < rows; ++row) {
+            (void) memcpy(dst, src, rowBytes);
+            if (dstStride[i] > rowBytes) {
+                (void) memset(dst + rowBytes, dst[rowBytes - 1], dstStride[i] - rowBytes);
+            }
+            dst += dstStride[i];
+            src += srcStride[i];
+        }
+        for (int row = rows; row < dstHeight[i]; ++row) {
+            (void) memcpy(dst, dst - dstStride[i], dstStride[i]);
+            dst += dstStride[i];
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * 功能说明: DeviceScheduler单元测试，覆盖会话负载估算、各调度策略的选卡、满载回退与迁移阈值，
+ *           设备guid取非连续值，确认选卡结果为设备guid而非列表下标
+ */
+
+#include <vector>
+#include "DeviceScheduler.h"
+#include "UnitTest.h"
+
+namespace {
+    constexpr int MAX_FPS_1080P = 240;
+    // 1080p60在1080p最大帧率240的设备上占25%负载
+    constexpr uint64_t PIXEL_RATE_1080P60 = DeviceScheduler::PIXELS_1080P * 60;
+
+    DeviceLoad MakeDevice(int guid, uint32_t loadPercent, int instances = 0, int maxInstances = 0)
+    {
+        DeviceLoad device;
+        device.guid = guid;
+        device.loadPercent = loadPercent;
+        device.instances = instances;
+        device.maxInstances = maxInstances;
+        device.capacity = DeviceScheduler::Capacity(MAX_FPS_1080P);
+        return device;
+    }
+}
+
+TEST(ParsesPolicyWithDefault)
+{
+    CHECK(DeviceScheduler::ParsePolicy("least_load") == PlacementPolicy::LEAST_LOAD);
+    CHECK(DeviceScheduler::ParsePolicy("least_instance") == PlacementPolicy::LEAST_INSTANCE);
+    CHECK(DeviceScheduler::ParsePolicy("pack") == PlacementPolicy::PACK);
+    CHECK(DeviceScheduler::ParsePolicy("") == PlacementPolicy::LEAST_LOAD);
+    CHECK(DeviceScheduler::ParsePolicy("unknown", PlacementPolicy::PACK) == PlacementPolicy::PACK);
+}
+
+TEST(SessionLoadRoundsUp)
+{
+    DeviceLoad device = MakeDevice(0, 0);
+    CHECK_EQ(DeviceScheduler::SessionLoad(device, PIXEL_RATE_1080P60), 25u);
+    CHECK_EQ(DeviceScheduler::SessionLoad(device, DeviceScheduler::PIXELS_1080P * 61), 26u);
+    CHECK_EQ(DeviceScheduler::SessionLoad(device, DeviceScheduler::PIXELS_1080P * 1000), DeviceScheduler::LOAD_FULL);
+    device.capacity = DeviceScheduler::Capacity(0);
+    CHECK_EQ(DeviceScheduler::SessionLoad(device, PIXEL_RATE_1080P60), 0u);
+}
+
+TEST(FitsChecksLoadAndInstances)
+{
+    CHECK(DeviceScheduler::Fits(MakeDevice(0, 75), PIXEL_RATE_1080P60));
+    CHECK(!DeviceScheduler::Fits(MakeDevice(0, 76), PIXEL_RATE_1080P60));
+    CHECK(DeviceScheduler::Fits(MakeDevice(0, 0, 1, 2), PIXEL_RATE_1080P60));
+    CHECK(!DeviceScheduler::Fits(MakeDevice(0, 0, 2, 2), PIXEL_RATE_1080P60));
+    // 最大实例数为0表示不限制
+    CHECK(DeviceScheduler::Fits(MakeDevice(0, 0, 100, 0), PIXEL_RATE_1080P60));
+}
+
+TEST(SelectsLeastLoaded)
+{
+    std::vector<DeviceLoad> devices = { MakeDevice(7, 50), MakeDevice(3, 20), MakeDevice(12, 60) };
+    CHECK_EQ(DeviceScheduler::Select(devices, PIXEL_RATE_1080P60, PlacementPolicy::LEAST_LOAD), 3);
+}
+
+TEST(SelectsLeastInstanceAmongFitting)
+{
+    std::vector<DeviceLoad> devices = {
+        MakeDevice(7, 10, 5), MakeDevice(3, 10, 2), MakeDevice(12, 10, 3), MakeDevice(9, 90, 0)
+    };
+    // guid 9实例最少但已无法容纳会话
+    CHECK_EQ(DeviceScheduler::Select(devices, PIXEL_RATE_1080P60, PlacementPolicy::LEAST_INSTANCE), 3);
+}
+
+TEST(PackPrefersFullestFittingDevice)
+{
+    std::vector<DeviceLoad> devices = { MakeDevice(7, 50), MakeDevice(3, 20), MakeDevice(12, 70), MakeDevice(9, 80) };
+    CHECK_EQ(DeviceScheduler::Select(devices, PIXEL_RATE_1080P60, PlacementPolicy::PACK), 12);
+}
+
+TEST(SelectSkipsDevicesAtMaxInstances)
+{
+    std::vector<DeviceLoad> devices = { MakeDevice(7, 10, 4, 4), MakeDevice(3, 40, 1, 4) };
+    CHECK_EQ(DeviceScheduler::Select(devices, PIXEL_RATE_1080P60, PlacementPolicy::LEAST_LOAD), 3);
+}
+
+TEST(SelectFallsBackToLeastLoadedWhenAllFull)
+{
+    std::vector<DeviceLoad> devices = { MakeDevice(7, 90), MakeDevice(3, 85), MakeDevice(12, 95) };
+    CHECK_EQ(DeviceScheduler::Select(devices, PIXEL_RATE_1080P60, PlacementPolicy::PACK), 3);
+    CHECK_EQ(DeviceScheduler::Select({}, PIXEL_RATE_1080P60, PlacementPolicy::LEAST_LOAD), -1);
+}
+
+TEST(MigratesOnlyOverThreshold)
+{
+    std::vector<DeviceLoad> devices = { MakeDevice(7, 80), MakeDevice(3, 30) };
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 40), 3);
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 50), 3);
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 51), -1);
+    // 阈值为0时不迁移，负载较低的设备不迁出
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 0), -1);
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 3, PIXEL_RATE_1080P60, 10), -1);
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 5, PIXEL_RATE_1080P60, 10), -1);
+}
+
+TEST(DoesNotMigrateWhenTargetWouldBeBusier)
+{
+    // 负载差达到阈值，但迁入后目标设备负载(20 + 25)不低于当前设备
+    std::vector<DeviceLoad> devices = { MakeDevice(7, 45), MakeDevice(3, 20) };
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 20), -1);
+    devices[0].loadPercent = 46;
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 20), 3);
+}
+
+TEST(MigratesToLeastLoadedFittingDevice)
+{
+    std::vector<DeviceLoad> devices = {
+        MakeDevice(7, 90), MakeDevice(3, 10, 4, 4), MakeDevice(12, 30), MakeDevice(9, 20)
+    };
+    // guid 3负载最低但实例已满
+    CHECK_EQ(DeviceScheduler::MigrationTarget(devices, 7, PIXEL_RATE_1080P60, 30), 9);
+}
@@ -0,0 +1,158 @@
+/*
+ * 功能说明: LogRateLimiter单元测试，覆盖周期内的输出条数、下一周期首条日志附带的抑制条数、
+ *           调用点不再触发时周期结束后与进程退出时输出的抑制条数汇总
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "LogRateLimiter.h"
+#include "UnitTest.h"
+
+namespace {
+    constexpr int LOG_NUM = 20;
+    constexpr int LOG_BUF_SIZE = 256;
+
+    std::vector<std::string> g_logs;
+    int g_pipeFd = -1;
+
+    void Record(const char *fmt, ...)
+    {
+        char buf[LOG_BUF_SIZE] = {0};
+        va_list args;
+        va_start(args, fmt);
+        (void) vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        g_logs.emplace_back(buf);
+        if (g_pipeFd >= 0) {
+            std::string line = std::string(buf) + "\n";
+            if (write(g_pipeFd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+                return;
+            }
+        }
+    }
+
+    #define TEST_LOG(fmt, ...) Record(fmt, ##__VA_ARGS__)
+    #define TEST_LOG_LIMITED(fmt, ...) LOG_RATE_LIMITED(TEST_LOG, fmt, ##__VA_ARGS__)
+
+    void WaitWindowEnd()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(LogRateLimiter::INTERVAL_MS + 100));
+    }
+
+    // 各用例使用独立的调用点，计数互不影响
+    void BurstLog()
+    {
+        TEST_LOG_LIMITED("burst %d", 1);
+    }
+
+    void QuietLog()
+    {
+        TEST_LOG_LIMITED("quiet %d", 2);
+    }
+
+    void ExitLog()
+    {
+        TEST_LOG_LIMITED("exit %d", 3);
+    }
+}
+
+TEST(AllowsBurstPerWindow)
+{
+    LogRateLimiter limiter;
+    uint32_t suppressed = 0;
+    for (uint32_t i = 0; i < LogRateLimiter::BURST; ++i) {
+        CHECK(limiter.Allow(suppressed));
+        CHECK_EQ(suppressed, 0u);
+    }
+    for (int i = 0; i < LOG_NUM; ++i) {
+        CHECK(!limiter.Allow(suppressed));
+    }
+    WaitWindowEnd();
+    CHECK(limiter.Allow(suppressed));
+    CHECK_EQ(suppressed, static_cast<uint32_t>(LOG_NUM));
+    CHECK(limiter.Allow(suppressed));
+    CHECK_EQ(suppressed, 0u);
+}
+
+TEST(NextWindowLogCarriesSuppressedCount)
+{
+    g_logs.clear();
+    for (int i = 0; i < LOG_NUM; ++i) {
+        BurstLog();
+    }
+    CHECK_EQ(g_logs.size(), static_cast<size_t>(LogRateLimiter::BURST));
+    CHECK(g_logs.back() == "burst 1");
+    // 周期未结束，不输出汇总
+    LogRateLimiter::FlushSuppressed(false);
+    CHECK_EQ(g_logs.size(), static_cast<size_t>(LogRateLimiter::BURST));
+    WaitWindowEnd();
+    BurstLog();
+    std::string expected = "burst 1 (suppressed " + std::to_string(LOG_NUM - LogRateLimiter::BURST) +
+        " similar messages)";
+    CHECK(g_logs.back() == expected);
+    // 抑制条数已随日志输出，不再重复汇总
+    size_t logNum = g_logs.size();
+    LogRateLimiter::FlushSuppressed(true);
+    CHECK_EQ(g_logs.size(), logNum);
+}
+
+TEST(FlushesSummaryOfQuietSiteAfterWindow)
+{
+    g_logs.clear();
+    for (int i = 0; i < LOG_NUM; ++i) {
+        QuietLog();
+    }
+    WaitWindowEnd();
+    LogRateLimiter::FlushSuppressed(false);
+    std::string expected = "suppressed " + std::to_string(LOG_NUM - LogRateLimiter::BURST) +
+        " similar messages: quiet %d";
+    CHECK_EQ(g_logs.size(), static_cast<size_t>(LogRateLimiter::BURST + 1));
+    CHECK(g_logs.back() == expected);
+    LogRateLimiter::FlushSuppressed(false);
+    CHECK_EQ(g_logs.size(), static_cast<size_t>(LogRateLimiter::BURST + 1));
+    // 汇总后新周期从头计数
+    QuietLog();
+    CHECK(g_logs.back() == "quiet 2");
+}
+
+TEST(FlushesSummaryAtExit)
+{
+    int fds[2] = {-1, -1};
+    CHECK_EQ(pipe(fds), 0);
+    (void) fflush(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 子进程抑制日志后直接退出，退出时应输出抑制条数汇总
+        (void) close(fds[0]);
+        g_pipeFd = fds[1];
+        for (int i = 0; i < LOG_NUM; ++i) {
+            ExitLog();
+        }
+        exit(EXIT_SUCCESS);
+    }
+    CHECK(pid > 0);
+    (void) close(fds[1]);
+    std::string output;
+    char buffer[LOG_BUF_SIZE];
+    ssize_t size = 0;
+    while ((size = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        output.append(buffer, static_cast<size_t>(size));
+    }
+    (void) close(fds[0]);
+    int status = 0;
+    CHECK_EQ(waitpid(pid, &status, 0), pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    std::string expected;
+    for (uint32_t i = 0; i < LogRateLimiter::BURST; ++i) {
+        expected += "exit 3\n";
+    }
+    expected += "suppressed " + std::to_string(LOG_NUM - LogRateLimiter::BURST) + " similar messages: exit %d\n";
+    CHECK(output == expected);
+}
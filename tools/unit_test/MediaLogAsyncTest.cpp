@@ -0,0 +1,193 @@
+/*
+ * 功能说明: 异步日志单元测试，覆盖单线程日志的输出顺序、缓冲满与缓冲数超限时的丢弃计数，
+ *           日志回调所在线程以及进程退出时输出剩余日志
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "MediaLog.h"
+#include "MediaLogAsync.h"
+#include "UnitTest.h"
+
+namespace {
+    const char *const TEST_TAG = "AsyncLogTest";
+    constexpr std::chrono::seconds WAIT_TIMEOUT(5);
+    constexpr int EXIT_LOG_NUM = 50;
+
+    std::mutex g_mutex;
+    std::condition_variable g_cond;
+    std::vector<std::string> g_messages;    // 本测试标签的日志
+    std::vector<std::string> g_reports;     // 异步日志模块自身输出的丢弃统计
+    std::thread::id g_callerThread;
+    bool g_onCallerThread = false;
+    bool g_blockCallback = false;
+    int g_pipeFd = -1;
+
+    void ResetCapture()
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_messages.clear();
+        g_reports.clear();
+        g_callerThread = std::this_thread::get_id();
+        g_onCallerThread = false;
+        g_blockCallback = false;
+    }
+
+    // 记录日志后按需阻塞，模拟输出缓慢的日志回调
+    void CaptureLog(int, const char *tag, const char *msg)
+    {
+        std::unique_lock<std::mutex> lock(g_mutex);
+        if (strstr(tag, TEST_TAG) == nullptr) {
+            g_reports.emplace_back(msg);
+            return;
+        }
+        g_messages.emplace_back(msg);
+        g_onCallerThread = g_onCallerThread || std::this_thread::get_id() == g_callerThread;
+        g_cond.notify_all();
+        g_cond.wait(lock, []() { return !g_blockCallback; });
+    }
+
+    void PipeLog(int, const char *tag, const char *msg)
+    {
+        if (strstr(tag, TEST_TAG) != nullptr) {
+            std::string line = std::string(msg) + "\n";
+            if (write(g_pipeFd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+                return;
+            }
+        }
+    }
+
+    bool WaitMessages(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(g_mutex);
+        return g_cond.wait_for(lock, WAIT_TIMEOUT, [count]() { return g_messages.size() >= count; });
+    }
+
+    void Log(int index)
+    {
+        MediaLogPrint(LOG_LEVEL_INFO, TEST_TAG, "log %d", index);
+    }
+}
+
+TEST(KeepsOrderAndCountsDropsWhenRingFull)
+{
+    SetMediaLogCallback(CaptureLog);
+    ResetCapture();
+    g_blockCallback = true;
+    SetMediaLogAsync(true);
+    uint64_t droppedBefore = GetMediaLogDroppedCount();
+    Log(0);
+    // 回调阻塞在第一条日志上，该条日志仍占用缓冲，之后只能再写入RING_SLOT_NUM - 1条
+    CHECK(WaitMessages(1));
+    constexpr int total = 200;
+    for (int i = 1; i < total; ++i) {
+        Log(i);
+    }
+    CHECK_EQ(GetMediaLogDroppedCount() - droppedBefore, total - MediaLogAsync::RING_SLOT_NUM);
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_blockCallback = false;
+    }
+    g_cond.notify_all();
+    SetMediaLogAsync(false);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    CHECK_EQ(g_messages.size(), MediaLogAsync::RING_SLOT_NUM);
+    for (size_t i = 0; i < g_messages.size(); ++i) {
+        CHECK(g_messages[i] == "log " + std::to_string(i));
+    }
+    // 日志回调在后台线程中执行
+    CHECK(!g_onCallerThread);
+    std::string report = std::to_string(total - MediaLogAsync::RING_SLOT_NUM) + " logs dropped";
+    CHECK(!g_reports.empty() && g_reports.back().compare(0, report.size(), report) == 0);
+}
+
+TEST(DropsLogsOfThreadsOverRingLimit)
+{
+    SetMediaLogCallback(CaptureLog);
+    ResetCapture();
+    SetMediaLogAsync(true);
+    // 主线程已持有一个缓冲，其余线程中超出上限的线程没有缓冲，其每条日志都丢弃
+    Log(0);
+    constexpr int threadNum = MediaLogAsync::RING_NUM_MAX + 4;
+    constexpr int logsPerThread = 3;
+    uint64_t droppedBefore = GetMediaLogDroppedCount();
+    std::atomic<int> logged {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&logged]() {
+            for (int i = 0; i < logsPerThread; ++i) {
+                Log(i);
+            }
+            // 所有线程写完前不退出，缓冲不会被回收
+            ++logged;
+            while (logged.load() < threadNum) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    SetMediaLogAsync(false);
+    int deniedThreads = threadNum - (static_cast<int>(MediaLogAsync::RING_NUM_MAX) - 1);
+    CHECK_EQ(GetMediaLogDroppedCount() - droppedBefore, static_cast<uint64_t>(deniedThreads * logsPerThread));
+    std::lock_guard<std::mutex> lock(g_mutex);
+    CHECK_EQ(g_messages.size(), static_cast<size_t>(1 + (threadNum - deniedThreads) * logsPerThread));
+}
+
+TEST(ReusesRingsReleasedByExitedThreads)
+{
+    SetMediaLogCallback(CaptureLog);
+    ResetCapture();
+    SetMediaLogAsync(true);
+    uint64_t droppedBefore = GetMediaLogDroppedCount();
+    std::thread([]() { Log(1); }).join();
+    CHECK(WaitMessages(1));
+    SetMediaLogAsync(false);
+    CHECK_EQ(GetMediaLogDroppedCount(), droppedBefore);
+}
+
+TEST(FlushesBufferedLogsAtExit)
+{
+    int fds[2] = {-1, -1};
+    CHECK_EQ(pipe(fds), 0);
+    (void) fflush(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 子进程开启异步日志后直接退出，退出时应输出全部已缓冲的日志
+        (void) close(fds[0]);
+        g_pipeFd = fds[1];
+        SetMediaLogCallback(PipeLog);
+        SetMediaLogAsync(true);
+        for (int i = 0; i < EXIT_LOG_NUM; ++i) {
+            Log(i);
+        }
+        exit(EXIT_SUCCESS);
+    }
+    CHECK(pid > 0);
+    (void) close(fds[1]);
+    std::string output;
+    char buffer[256];
+    ssize_t size = 0;
+    while ((size = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        output.append(buffer, static_cast<size_t>(size));
+    }
+    (void) close(fds[0]);
+    int status = 0;
+    CHECK_EQ(waitpid(pid, &status, 0), pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    std::string expected;
+    for (int i = 0; i < EXIT_LOG_NUM; ++i) {
+        expected += "log " + std::to_string(i) + "\n";
+    }
+    CHECK(output == expected);
+}
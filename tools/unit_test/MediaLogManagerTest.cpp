@@ -0,0 +1,67 @@
+/*
+ * 功能说明: 日志标签登记单元测试，覆盖以临时字符串设置标签级别后，LOG_TAG地址仍能登记为快速匹配键
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "MediaLog.h"
+#include "MediaLogManager.h"
+#include "UnitTest.h"
+
+namespace {
+    const char *const PROPERTY_TAG = "PropertyTag";
+    std::vector<int> g_levels;
+
+    void CaptureLog(int level, const char *, const char *)
+    {
+        g_levels.push_back(level);
+    }
+}
+
+TEST(PropertyTagLevelKeepsLogTagFastPath)
+{
+    MediaLogManager &logManager = MediaLogManager::GetInstance();
+    SetMediaLogCallback(CaptureLog);
+    SetMediaLogLevel(LOG_LEVEL_DEBUG);
+    {
+        // 与解析persist.vmi.video.log.tag_level一致，标签来自随即释放的临时字符串
+        std::string item = std::string(PROPERTY_TAG) + "=3";
+        SetMediaLogTagLevel(item.substr(0, item.find('=')).c_str(), LOG_LEVEL_ERROR);
+    }
+    CHECK_EQ(logManager.FindTagId(PROPERTY_TAG), -1);
+    int tagId = logManager.GetTagId(PROPERTY_TAG);
+    CHECK(tagId >= 0);
+    // 首个LOG_TAG地址填入快速匹配键，之后不加锁即可命中同一标签
+    CHECK_EQ(logManager.FindTagId(PROPERTY_TAG), tagId);
+    CHECK_EQ(logManager.GetTagLogLevel(tagId), LOG_LEVEL_ERROR);
+    CHECK(strcmp(logManager.GetFullTag(tagId), "Media_PropertyTag") == 0);
+
+    MediaLogPrint(LOG_LEVEL_WARN, PROPERTY_TAG, "filtered");
+    MediaLogPrint(LOG_LEVEL_ERROR, PROPERTY_TAG, "passed");
+    CHECK_EQ(g_levels.size(), 1u);
+    CHECK(!g_levels.empty() && g_levels[0] == LOG_LEVEL_ERROR);
+}
+
+TEST(TemporaryTagIsNeverUsedAsKey)
+{
+    MediaLogManager &logManager = MediaLogManager::GetInstance();
+    std::string tag = "TemporaryTag";
+    logManager.SetTagLogLevel(tag.c_str(), LOG_LEVEL_WARN);
+    CHECK_EQ(logManager.FindTagId(tag.c_str()), -1);
+    // 同名的长期有效地址与临时字符串登记为同一标签
+    int tagId = logManager.GetTagId("TemporaryTag");
+    CHECK(tagId >= 0);
+    CHECK_EQ(logManager.GetTagLogLevel(tagId), LOG_LEVEL_WARN);
+    logManager.SetTagLogLevel(tag.c_str(), -1);
+    CHECK_EQ(logManager.GetTagLogLevel(tagId), static_cast<int>(logManager.GetLogLevel()));
+}
+
+TEST(DefaultTagForNullTag)
+{
+    MediaLogManager &logManager = MediaLogManager::GetInstance();
+    int tagId = logManager.GetTagId(nullptr);
+    CHECK(tagId >= 0);
+    CHECK_EQ(logManager.FindTagId(nullptr), tagId);
+    CHECK(strcmp(logManager.GetFullTag(tagId), "Media") == 0);
+}
@@ -0,0 +1,35 @@
+/*
+ * 功能说明: PropertyWatcher单元测试，覆盖属性创建前后的变化检测与处理失败后的重新读取
+ */
+
+#include <sys/system_properties.h>
+#include "Property.h"
+#include "UnitTest.h"
+
+TEST(NotifiesOnlyOnChange)
+{
+    PropertyWatcher watcher("test.watcher.change");
+    CHECK(!watcher.Update());
+    SetEncParam("test.watcher.change", "1");
+    CHECK(watcher.Update());
+    CHECK(watcher.ValueEquals("1"));
+    watcher.Commit();
+    CHECK(!watcher.Update());
+    SetEncParam("test.watcher.change", "2");
+    CHECK(watcher.Update());
+    CHECK(watcher.ValueEquals("2"));
+    watcher.Commit();
+    CHECK(!watcher.Update());
+}
+
+TEST(RereadsUntilCommitted)
+{
+    SetEncParam("test.watcher.retry", "1");
+    PropertyWatcher watcher("test.watcher.retry");
+    CHECK(watcher.Update());
+    // 调用方处理失败未确认，值未变化时仍需再次处理
+    CHECK(watcher.Update());
+    CHECK(watcher.ValueEquals("1"));
+    watcher.Commit();
+    CHECK(!watcher.Update());
+}
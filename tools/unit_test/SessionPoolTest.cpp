@@ -0,0 +1,142 @@
+/*
+ * 功能说明: SessionPool单元测试，覆盖按键取用、容量淘汰、预热数量上限以及卸载前排空
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include "SessionPool.h"
+#include "UnitTest.h"
+
+namespace {
+    struct FakeSession {
+        int id = 0;
+    };
+
+    struct Counters {
+        std::atomic<int> opened = { 0 };
+        std::atomic<int> closed = { 0 };
+    };
+
+    SessionPool<FakeSession>::Closer CloserOf(Counters &counters)
+    {
+        return [&counters](FakeSession &) { ++counters.closed; };
+    }
+
+    // 等待预热线程打开指定数量的会话
+    bool WaitOpened(const Counters &counters, int expected)
+    {
+        constexpr int waitRounds = 1000;
+        for (int i = 0; i < waitRounds && counters.opened.load() < expected; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return counters.opened.load() == expected;
+    }
+
+    SessionPool<FakeSession>::Opener OpenerOf(Counters &counters)
+    {
+        return [&counters]() {
+            ++counters.opened;
+            return std::unique_ptr<FakeSession>(new FakeSession());
+        };
+    }
+}
+
+TEST(AcquiresOnlyMatchingKey)
+{
+    Counters counters;
+    SessionPool<FakeSession> pool(CloserOf(counters));
+    pool.SetCapacity(2);
+    std::unique_ptr<FakeSession> session(new FakeSession());
+    session->id = 7;
+    pool.Release("h264_720p", std::move(session));
+    CHECK(pool.Acquire("h265_720p") == nullptr);
+    std::unique_ptr<FakeSession> reused = pool.Acquire("h264_720p");
+    CHECK(reused != nullptr);
+    CHECK_EQ(reused->id, 7);
+    CHECK(pool.Acquire("h264_720p") == nullptr);
+    CHECK_EQ(counters.closed.load(), 0);
+}
+
+TEST(EvictsOldestOverCapacity)
+{
+    Counters counters;
+    SessionPool<FakeSession> pool(CloserOf(counters));
+    pool.SetCapacity(2);
+    for (int i = 0; i < 3; ++i) {
+        std::unique_ptr<FakeSession> session(new FakeSession());
+        session->id = i;
+        pool.Release("key" + std::to_string(i), std::move(session));
+    }
+    CHECK_EQ(counters.closed.load(), 1);
+    CHECK(pool.Acquire("key0") == nullptr);
+    CHECK(pool.Acquire("key2") != nullptr);
+    pool.SetCapacity(0);
+    CHECK_EQ(counters.closed.load(), 2);
+    // 上限为0时归还即关闭
+    pool.Release("key3", std::unique_ptr<FakeSession>(new FakeSession()));
+    CHECK_EQ(counters.closed.load(), 3);
+}
+
+TEST(PrewarmIsBoundedByCapacity)
+{
+    Counters counters;
+    SessionPool<FakeSession> pool(CloserOf(counters));
+    pool.SetCapacity(2);
+    for (int i = 0; i < 5; ++i) {
+        pool.Prewarm("key" + std::to_string(i), OpenerOf(counters));
+    }
+    CHECK(WaitOpened(counters, 2));
+    // 预热的会话已占满会话池，之后的预热请求全部忽略
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            pool.Prewarm("key" + std::to_string(i), OpenerOf(counters));
+        }
+    }
+    pool.Drain();
+    CHECK_EQ(counters.opened.load(), 2);
+    CHECK_EQ(counters.closed.load(), 2);
+}
+
+TEST(PrewarmSkipsKeyAlreadyIdle)
+{
+    Counters counters;
+    SessionPool<FakeSession> pool(CloserOf(counters));
+    pool.SetCapacity(4);
+    pool.Release("key", std::unique_ptr<FakeSession>(new FakeSession()));
+    pool.Prewarm("key", OpenerOf(counters));
+    pool.Drain();
+    CHECK_EQ(counters.opened.load(), 0);
+    CHECK_EQ(counters.closed.load(), 1);
+}
+
+TEST(DrainClosesEverythingAndAllowsRestart)
+{
+    Counters counters;
+    SessionPool<FakeSession> pool(CloserOf(counters));
+    pool.SetCapacity(2);
+    pool.Prewarm("key", OpenerOf(counters));
+    CHECK(WaitOpened(counters, 1));
+    pool.Drain();
+    // 排空后预热线程已退出，预热的会话已关闭，库函数不会再被调用
+    CHECK(pool.Acquire("key") == nullptr);
+    CHECK_EQ(counters.closed.load(), 1);
+    pool.Prewarm("key", OpenerOf(counters));
+    CHECK(WaitOpened(counters, 2));
+    pool.Drain();
+    CHECK_EQ(counters.closed.load(), 2);
+}
+
+TEST(DestructorClosesIdleSessions)
+{
+    Counters counters;
+    {
+        SessionPool<FakeSession> pool(CloserOf(counters));
+        pool.SetCapacity(2);
+        pool.Release("a", std::unique_ptr<FakeSession>(new FakeSession()));
+        pool.Release("b", std::unique_ptr<FakeSession>(new FakeSession()));
+    }
+    CHECK_EQ(counters.closed.load(), 2);
+}
@@ -0,0 +1,160 @@
+/*
+ * 功能说明: SpsParser单元测试，以字节级的参数集覆盖H.264裁剪、场编码与VUI帧率，
+ *           H.265 conformance window、帧间预测的短期参考图像集与10bit，以及超出支持范围的参数
+ */
+
+#include <cstdint>
+#include <vector>
+#include "SpsParser.h"
+#include "UnitTest.h"
+
+namespace {
+    // H.264 High，120x68宏块，frame_cropping底部4（4:2:0单位2行）：1920x1088裁剪为1920x1080
+    const std::vector<uint8_t> H264_1080P_CROP = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x28, 0xAC, 0xDA, 0x01, 0xE0, 0x08, 0x9F, 0x95
+    };
+
+    // H.264 Main场编码，frame_mbs_only_flag=0，34个场映射单元（帧高68宏块），底部裁剪2（场编码单位4行）
+    const std::vector<uint8_t> H264_1080I_FIELD = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x4D, 0x00, 0x28, 0xED, 0x00, 0xF0, 0x08, 0x9F, 0xB4
+    };
+
+    // H.264 Baseline 1280x720，VUI带SAR、视频信号类型与timing_info：num_units_in_tick=1001，time_scale=120000
+    const std::vector<uint8_t> H264_720P_VUI_TIMING = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x28, 0xED, 0x00, 0xA0, 0x0B, 0x77, 0xFE, 0x00, 0x02,
+        0x00, 0x02, 0xD4, 0x04, 0x04, 0x05, 0x00, 0x00, 0x03, 0x03, 0xE9, 0x00, 0x01, 0xD4, 0xC0, 0x84
+    };
+
+    // 同上，num_units_in_tick与time_scale均为0xFFFFFFF0，二者相加超出32位
+    const std::vector<uint8_t> H264_VUI_TIMING_OVERFLOW = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x28, 0xED, 0x00, 0xA0, 0x0B, 0x77, 0xFE, 0x00, 0x02,
+        0x00, 0x02, 0xD4, 0x04, 0x04, 0x05, 0xFF, 0xFF, 0xFF, 0xF0, 0xFF, 0xFF, 0xFF, 0xF0, 0x84
+    };
+
+    // 同上，num_units_in_tick=1，time_scale=2000，帧率1000
+    const std::vector<uint8_t> H264_VUI_TIMING_TOO_FAST = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x28, 0xED, 0x00, 0xA0, 0x0B, 0x77, 0xFE, 0x00, 0x02,
+        0x00, 0x02, 0xD4, 0x04, 0x04, 0x05, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x07, 0xD0, 0x84
+    };
+
+    // H.264 Baseline，1024x45宏块，宽16384超出上限
+    const std::vector<uint8_t> H264_OVERSIZED = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x28, 0xED, 0x00, 0x08, 0x00, 0x0B, 0x72
+    };
+
+    // H.264 High 4:4:4，bit_depth_luma_minus8=4，1280x720 12bit
+    const std::vector<uint8_t> H264_12BIT = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0xF4, 0x00, 0x28, 0xA2, 0x94, 0xDA, 0x01, 0x40, 0x16, 0xE4
+    };
+
+    // H.265 VPS（vps_timing_info 1/30）与Main SPS：1920x1088，conformance_window底部4（4:2:0单位2行），无VUI
+    const std::vector<uint8_t> H265_1080P_CONFORMANCE_WINDOW = {
+        0x00, 0x00, 0x00, 0x01, 0x40, 0x01, 0x0C, 0x01, 0xFF, 0xFF, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00,
+        0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x78, 0x97, 0x03, 0x00, 0x00, 0x03, 0x00, 0x01,
+        0x00, 0x00, 0x03, 0x00, 0x1E, 0x50, 0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, 0x01, 0x60, 0x00,
+        0x00, 0x03, 0x00, 0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x78, 0xA0, 0x03, 0xC0, 0x80,
+        0x11, 0x07, 0xCB, 0x96, 0x5E, 0x49, 0x1B, 0x6B, 0x20
+    };
+
+    // H.265 Main 1280x720，3个短期参考图像集，后两个为帧间预测的参考图像集，之后VUI中vui_timing_info 1/60
+    const std::vector<uint8_t> H265_INTER_RPS_VUI_TIMING = {
+        0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x03, 0x00, 0x78, 0xA0, 0x02, 0x80, 0x80, 0x2D, 0x16, 0x59, 0x79, 0x24, 0x6D,
+        0x88, 0xFF, 0x69, 0xAC, 0x70, 0x08, 0x00, 0x00, 0x03, 0x00, 0x08, 0x00, 0x00, 0x03, 0x01, 0xE0, 0x40
+    };
+
+    // H.265 Main10 3840x2160，bit_depth_luma_minus8=2
+    const std::vector<uint8_t> H265_10BIT = {
+        0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x03, 0x00, 0x78, 0xA0, 0x01, 0xE0, 0x20, 0x02, 0x1C, 0x4D, 0x96, 0x5E, 0x49,
+        0x1B, 0x6B, 0x20
+    };
+    bool Parse(const std::vector<uint8_t> &stream, bool h264, SpsParser::StreamInfo &info)
+    {
+        return SpsParser::Parse(stream.data(), stream.size(), h264, info);
+    }
+}
+
+TEST(H264FrameCropping)
+{
+    SpsParser::StreamInfo info;
+    CHECK(Parse(H264_1080P_CROP, true, info));
+    CHECK_EQ(info.codedWidth, 1920u);
+    CHECK_EQ(info.codedHeight, 1088u);
+    CHECK_EQ(info.width, 1920u);
+    CHECK_EQ(info.height, 1080u);
+    CHECK_EQ(info.bitDepth, 8u);
+    CHECK_EQ(info.frameRate, 0u);
+}
+
+TEST(H264FieldCoding)
+{
+    SpsParser::StreamInfo info;
+    CHECK(Parse(H264_1080I_FIELD, true, info));
+    CHECK_EQ(info.codedHeight, 1088u);
+    CHECK_EQ(info.height, 1080u);
+}
+
+TEST(H264VuiTiming)
+{
+    SpsParser::StreamInfo info;
+    CHECK(Parse(H264_720P_VUI_TIMING, true, info));
+    CHECK_EQ(info.width, 1280u);
+    CHECK_EQ(info.height, 720u);
+    // 帧率 = time_scale / (2 * num_units_in_tick)，四舍五入
+    CHECK_EQ(info.frameRate, 60u);
+    CHECK(Parse(H264_VUI_TIMING_OVERFLOW, true, info));
+    CHECK_EQ(info.frameRate, 1u);
+}
+
+TEST(H264OutOfRangeFallsBack)
+{
+    SpsParser::StreamInfo info;
+    info.width = 640;
+    CHECK(!Parse(H264_OVERSIZED, true, info));
+    CHECK(!Parse(H264_12BIT, true, info));
+    // 解析失败时不修改info，由调用方使用配置的参数
+    CHECK_EQ(info.width, 640u);
+    // 帧率超出范围时视为码流未携带，尺寸仍然可用
+    CHECK(Parse(H264_VUI_TIMING_TOO_FAST, true, info));
+    CHECK_EQ(info.width, 1280u);
+    CHECK_EQ(info.frameRate, 0u);
+}
+
+TEST(H265ConformanceWindowAndVpsTiming)
+{
+    SpsParser::StreamInfo info;
+    CHECK(Parse(H265_1080P_CONFORMANCE_WINDOW, false, info));
+    CHECK_EQ(info.codedWidth, 1920u);
+    CHECK_EQ(info.codedHeight, 1088u);
+    CHECK_EQ(info.width, 1920u);
+    CHECK_EQ(info.height, 1080u);
+    // SPS不带VUI时使用VPS中的帧率
+    CHECK_EQ(info.frameRate, 30u);
+}
+
+TEST(H265InterPredictedRefPicSets)
+{
+    // 参考图像集解析错位时无法读到VUI中的帧率
+    SpsParser::StreamInfo info;
+    CHECK(Parse(H265_INTER_RPS_VUI_TIMING, false, info));
+    CHECK_EQ(info.width, 1280u);
+    CHECK_EQ(info.height, 720u);
+    CHECK_EQ(info.frameRate, 60u);
+}
+
+TEST(H265TenBit)
+{
+    SpsParser::StreamInfo info;
+    CHECK(Parse(H265_10BIT, false, info));
+    CHECK_EQ(info.width, 3840u);
+    CHECK_EQ(info.height, 2160u);
+    CHECK_EQ(info.bitDepth, 10u);
+}
+
+TEST(TruncatedSpsIsRejected)
+{
+    SpsParser::StreamInfo info;
+    std::vector<uint8_t> truncated(H264_720P_VUI_TIMING.begin(), H264_720P_VUI_TIMING.begin() + 10);
+    CHECK(!Parse(truncated, true, info));
+}
@@ -0,0 +1,74 @@
+/*
+ * 功能说明: 单元测试的断言与用例注册，不依赖测试框架；每个测试程序包含本头文件并以TEST定义用例，
+ *           main依次执行全部用例，有断言失败时返回非0
+ */
+#ifndef UNIT_TEST_H
+#define UNIT_TEST_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace UnitTest {
+    struct Case {
+        const char *name;
+        std::function<void()> body;
+    };
+
+    inline std::vector<Case> &Cases()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline int &Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    struct Registrar {
+        Registrar(const char *name, std::function<void()> body)
+        {
+            Cases().push_back({name, std::move(body)});
+        }
+    };
+}
+
+#define TEST(name)                                                          \
+    static void name();                                                     \
+    static UnitTest::Registrar g_registrar_##name(#name, name);             \
+    static void name()
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++UnitTest::Failures();                                         \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                          \
+    do {                                                                    \
+        auto actualValue = (actual);                                        \
+        auto expectedValue = (expected);                                    \
+        if (!(actualValue == expectedValue)) {                              \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, \
+                #expected, static_cast<long long>(actualValue), static_cast<long long>(expectedValue)); \
+            ++UnitTest::Failures();                                         \
+        }                                                                   \
+    } while (0)
+
+int main()
+{
+    for (const auto &item : UnitTest::Cases()) {
+        int before = UnitTest::Failures();
+        item.body();
+        printf("[%s] %s\n", (UnitTest::Failures() == before) ? "  OK  " : "FAILED", item.name);
+    }
+    return (UnitTest::Failures() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif  // UNIT_TEST_H
@@ -16,10 +16,41 @@ enum EncoderType : uint32_t {
     ENCODER_TYPE_NETINTH264 = 1,  // NETINT h.264硬件编码器
     ENCODER_TYPE_NETINTH265 = 2   // NETINT h.265硬件编码器
 };
+
+// 置1时开启异步日志，编码线程不再同步执行日志输出
+const char *const PROP_LOG_ASYNC = "persist.vmi.video.log.async";
+// 全局日志级别，取值同MediaLogLevel
+const char *const PROP_LOG_LEVEL = "persist.vmi.video.log.level";
+// 标签日志级别，格式为Tag=level，多个标签以逗号分隔，如VideoEncoderNetint=0,VideoCodecApi=2
+const char *const PROP_LOG_TAG_LEVEL = "persist.vmi.video.log.tag_level";
+
+void ApplyLogProperties()
+{
+    if (GetIntEncParam(PROP_LOG_ASYNC) == 1) {
+        SetMediaLogAsync(true);
+    }
+    int32_t level = GetIntEncParam(PROP_LOG_LEVEL);
+    if (level >= LOG_LEVEL_DEBUG) {
+        SetMediaLogLevel(level);
+    }
+    std::string tagLevels = GetStrEncParam(PROP_LOG_TAG_LEVEL);
+    size_t start = 0;
+    while (start < tagLevels.size()) {
+        size_t end = tagLevels.find(',', start);
+        end = (end == std::string::npos) ? tagLevels.size() : end;
+        std::string item = tagLevels.substr(start, end - start);
+        size_t sep = item.find('=');
+        if (sep != std::string::npos && sep > 0) {
+            SetMediaLogTagLevel(item.substr(0, sep).c_str(), StrToInt(item.substr(sep + 1)));
+        }
+        start = end + 1;
+    }
+}
 }
 
 EncoderRetCode CreateVideoEncoder(VideoEncoder **encoder)
 {
+    ApplyLogProperties();
     uint32_t encType = GetIntEncParam("ro.vmi.demo.video.encode.format");
     INFO("create video encoder: encoder type %u", encType);
     switch (encType) {
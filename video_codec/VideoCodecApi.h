@@ -16,7 +16,22 @@ enum EncoderRetCode : uint32_t {
     VIDEO_ENCODER_REGISTER_FAIL          = 0x07,  // 注册函数失败
     VIDEO_ENCODER_RESET_FAIL             = 0x08,  // 重置编码器失败
     VIDEO_ENCODER_FORCE_KEY_FRAME_FAIL   = 0x09,  // 强制I帧失败
-    VIDEO_ENCODER_SET_ENCODE_PARAMS_FAIL = 0x0A   // 设置编码参数失败
+    VIDEO_ENCODER_SET_ENCODE_PARAMS_FAIL = 0x0A,  // 设置编码参数失败
+    VIDEO_ENCODER_QUEUE_FULL             = 0x0B,  // 在途帧已达上限，需先取出编码输出
+    VIDEO_ENCODER_NO_OUTPUT              = 0x0C   // 暂无可取出的编码输出
+};
+
+constexpr uint32_t VIDEO_ENCODER_MAX_PLANES = 3;
+
+// 编码器持有的输入缓冲区，生产者按平面跨度与偏移直接写入一帧I420数据
+struct EncoderInputBuffer {
+    uint32_t index = 0;                                  // 缓冲区编号，QueueInputBuffer时原样传回
+    uint8_t *data = nullptr;                             // 缓冲区起始地址
+    uint32_t capacity = 0;                               // 缓冲区大小(Byte)
+    uint32_t planeNum = 0;                               // 平面个数
+    uint32_t stride[VIDEO_ENCODER_MAX_PLANES] = {0};     // 各平面跨度(Byte)
+    uint32_t offset[VIDEO_ENCODER_MAX_PLANES] = {0};     // 各平面相对data的偏移(Byte)
+    uint32_t height[VIDEO_ENCODER_MAX_PLANES] = {0};     // 各平面行数
 };
 
 class VideoEncoder {
@@ -58,7 +73,7 @@ public:
         uint8_t **outputData, uint32_t *outputSize) = 0;
 
     /**
-     * @功能描述: 停止编码器
+     * @功能描述: 停止编码器，排空设备中的在途帧
      * @返回值: VIDEO_ENCODER_SUCCESS 成功
      *          VIDEO_ENCODER_STOP_FAIL 停止编码器失败
      */
@@ -75,6 +90,49 @@ public:
      *          VIDEO_ENCODER_RESET_FAIL 重置编码器失败
      */
     virtual EncoderRetCode ResetEncoder() = 0;
+
+    // 以下为流水线与输入缓冲区接口，追加在原有虚函数之后，已编译的调用方使用的虚函数表布局不变
+
+    /**
+     * @功能描述: 提交一帧待编码数据，不等待编码输出（流水线模式），需与PollPacket在同一线程调用
+     * @参数 [in] inputData: 编码输入数据地址，函数返回后即可复用
+     * @参数 [in] inputSize: 编码输入数据大小
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 在途帧已达上限，需先调用PollPacket取出编码输出
+     *          VIDEO_ENCODER_ENCODE_FAIL 提交失败
+     */
+    virtual EncoderRetCode SubmitFrame(const uint8_t *inputData, uint32_t inputSize) = 0;
+
+    /**
+     * @功能描述: 按提交顺序取出一帧编码输出（流水线模式），停止编码器后可继续取出排空的剩余输出，
+     *           销毁或重置编码器时丢弃未取出的剩余输出
+     * @参数 [out] outputData: 编码输出数据地址，在下一次调用PollPacket/EncodeOneFrame前有效
+     * @参数 [out] outputSize: 编码输出数据大小
+     * @参数 [in] wait: true 等待在途帧编码完成；false 无输出时立即返回
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_NO_OUTPUT 暂无编码输出
+     *          VIDEO_ENCODER_ENCODE_FAIL 获取编码输出失败
+     */
+    virtual EncoderRetCode PollPacket(uint8_t **outputData, uint32_t *outputSize, bool wait) = 0;
+
+    /**
+     * @功能描述: 申请一块编码器持有的输入缓冲区，生产者填充后调用QueueInputBuffer送编，可避免输入数据的额外拷贝
+     * @参数 [out] buffer: 输入缓冲区描述，包含各平面跨度与偏移
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 暂无空闲缓冲区，需先调用PollPacket取出编码输出
+     *          VIDEO_ENCODER_ENCODE_FAIL 申请失败
+     */
+    virtual EncoderRetCode DequeueInputBuffer(EncoderInputBuffer *buffer) = 0;
+
+    /**
+     * @功能描述: 提交已填充的输入缓冲区进行编码，语义同SubmitFrame，编码输出通过PollPacket取出
+     * @参数 [in] buffer: DequeueInputBuffer返回的输入缓冲区描述
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 在途帧已达上限，缓冲区仍归调用者所有，可稍后重新提交
+     *          VIDEO_ENCODER_ENCODE_FAIL 提交失败；编码器因分辨率或档位变化待重置时，已申请缓冲区的布局失效，
+     *                                    缓冲区被收回，需重新申请
+     */
+    virtual EncoderRetCode QueueInputBuffer(const EncoderInputBuffer &buffer) = 0;
 };
 
 extern "C" {
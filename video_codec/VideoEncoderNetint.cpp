@@ -5,6 +5,8 @@
 #define LOG_TAG "VideoEncoderNetint"
 #include "VideoEncoderNetint.h"
 #include <dlfcn.h>
+#include <unistd.h>
+#include <sys/file.h>
 #include <algorithm>
 #include <cstring>
 #include <string>
@@ -23,7 +25,10 @@ namespace {
     const std::string NI_ENCODER_INIT_DEFAULT_PARAMS = "ni_encoder_init_default_params";
     const std::string NI_ENCODER_PARAMS_SET_VALUE = "ni_encoder_params_set_value";
     const std::string NI_RSRC_ALLOCATE_AUTO = "ni_rsrc_allocate_auto";
+    const std::string NI_RSRC_ALLOCATE_DIRECT = "ni_rsrc_allocate_direct";
     const std::string NI_RSRC_RELEASE_RESOURCE = "ni_rsrc_release_resource";
+    const std::string NI_RSRC_LIST_DEVICES = "ni_rsrc_list_devices";
+    const std::string NI_RSRC_UPDATE_DEVICE_LOAD = "ni_rsrc_update_device_load";
     const std::string NI_RSRC_FREE_DEVICE_CONTEXT = "ni_rsrc_free_device_context";
     const std::string NI_DEVICE_OPEN = "ni_device_open";
     const std::string NI_DEVICE_CLOSE = "ni_device_close";
@@ -46,6 +51,12 @@ namespace {
         ni_retcode_t (*)(ni_encoder_params_t *params, const char *name, const char *value);
     using NiRsrcAllocateAutoFunc = ni_device_context_t* (*)(ni_device_type_t devType, ni_alloc_rule_t rule,
         ni_codec_t codec, int width, int height, int framerate, unsigned long *load);
+    using NiRsrcAllocateDirectFunc = ni_device_context_t* (*)(ni_device_type_t devType, int guid,
+        ni_codec_t codec, int width, int height, int framerate, unsigned long *load);
+    using NiRsrcListDevicesFunc = ni_retcode_t (*)(ni_device_type_t devType, ni_device_info_t *devInfo,
+        int *devCount);
+    using NiRsrcUpdateDeviceLoadFunc = int (*)(ni_device_context_t *devCtx, int load,
+        int swInstanceCnt, const ni_sw_instance_info_t swInstanceInfo[]);
     using NiRsrcReleaseResourceFunc = void (*)(ni_device_context_t *devCtx, ni_codec_t codec, unsigned long load);
     using NiRsrcFreeDeviceContextFunc = void (*)(ni_device_context_t *devCtx);
     using NiDeviceOpenFunc = ni_device_handle_t (*)(const char *dev, uint32_t *maxIoSizeOut);
@@ -76,7 +87,10 @@ namespace {
         { NI_ENCODER_INIT_DEFAULT_PARAMS, nullptr },
         { NI_ENCODER_PARAMS_SET_VALUE, nullptr },
         { NI_RSRC_ALLOCATE_AUTO, nullptr },
+        { NI_RSRC_ALLOCATE_DIRECT, nullptr },
         { NI_RSRC_RELEASE_RESOURCE, nullptr },
+        { NI_RSRC_LIST_DEVICES, nullptr },
+        { NI_RSRC_UPDATE_DEVICE_LOAD, nullptr },
         { NI_RSRC_FREE_DEVICE_CONTEXT, nullptr },
         { NI_DEVICE_OPEN, nullptr },
         { NI_DEVICE_CLOSE, nullptr },
@@ -100,11 +114,30 @@ namespace {
         {"high", "100"}};
 
     const std::string SHARED_LIB_NAME = "libxcoder.so";
+    const std::string PROP_PARAM_ADJUSTING = "persist.vmi.video.encode.param_adjusting";
+    const std::string PROP_KEYFRAME = "persist.vmi.video.encode.keyframe";
+    // 强制I帧结果：0 已受理，IDR随下一个写入的帧下发；1 该帧的输出为带参数集的IDR；-1 设备未输出IDR
+    const std::string PROP_KEYFRAME_RESULT = "persist.vmi.video.encode.keyframe_result";
+    const std::string PROP_PIPELINE_DEPTH = "persist.vmi.video.encode.pipeline_depth";
+    const std::string PROP_SESSION_POOL_SIZE = "persist.vmi.video.encode.session_pool_size";
+    // 为1时每次初始化后在后台为同一配置预热一个备用会话，占用额外的设备实例，数量受会话池上限约束
+    const std::string PROP_SESSION_PREWARM = "persist.vmi.video.encode.session_prewarm";
+    constexpr uint32_t SESSION_POOL_SIZE_MAX = 4;
+    const std::string PROP_SCHED_POLICY = "persist.vmi.video.encode.sched_policy";
+    const std::string PROP_MIGRATE_THRESHOLD = "persist.vmi.video.encode.migrate_threshold";
+    constexpr int DEVICE_NUM_MAX = NI_MAX_HW_ENCODER_COUNT;  // 资源池共享内存中的设备数上限
+    constexpr useconds_t READ_RETRY_INTERVAL_US = 500;
+    constexpr useconds_t READ_TIMEOUT_US = 1000000;
+    constexpr int VBV_DELAY_DEFAULT_MS = 1000;
+    constexpr uint64_t MS_PER_SECOND = 1000;
+    constexpr uint64_t BITS_PER_BYTE = 8;
+    constexpr uint32_t PACKET_CAPACITY_GROW_FACTOR = 2;
     std::atomic<bool> g_netintLoaded = { false };
     void *g_libHandle = nullptr;
 }
 
 VideoEncoderNetint::VideoEncoderNetint(NiCodecType codecType)
+    : m_paramAdjustingWatcher(PROP_PARAM_ADJUSTING.c_str()), m_keyframeWatcher(PROP_KEYFRAME.c_str())
 {
     if (codecType == NI_CODEC_TYPE_H264) {
         m_codec = EN_H264;
@@ -198,31 +231,74 @@ EncoderRetCode VideoEncoderNetint::InitEncoder()
         return VIDEO_ENCODER_INIT_FAIL;
     }
     m_encParams = m_tmpEncParams;
+    m_pipelineDepth = GetPipelineDepth();
+    int32_t threshold = GetIntEncParam(PROP_MIGRATE_THRESHOLD.c_str());
+    m_migrateThreshold = (threshold > 0 && threshold <= static_cast<int32_t>(DeviceScheduler::LOAD_FULL)) ?
+        static_cast<uint32_t>(threshold) : 0;
     if (!LoadNetintSharedLib()) {
         ERR("init encoder failed: load NETINT so error");
         return VIDEO_ENCODER_INIT_FAIL;
     }
     m_width = static_cast<int>(m_encParams.width);
     m_height = static_cast<int>(m_encParams.height);
-    const int align = (m_codec == EN_H264) ? 16 : 8;  // h.264: 16-aligned, h.265: 8-aligned
-    m_widthAlign = std::max(((m_width + align - 1) / align) * align, NI_MIN_WIDTH);
-    m_heightAlign = std::max(((m_height + align - 1) / align) * align, NI_MIN_HEIGHT);
-    if (!InitCodec()) {
-        ERR("init encoder failed: init codec error");
-        return VIDEO_ENCODER_INIT_FAIL;
+    SessionPool<NetintEncoderSession> &pool = GetSessionPool();
+    pool.SetCapacity(GetSessionPoolSize());
+    SessionConfig config = { m_codec, m_encParams, m_pipelineDepth };
+    const std::string key = SessionKey(config);
+    m_sessionKey = key;
+    // 迁移时不取用会话池中的会话，以免取回仍位于原设备的会话
+    if (m_migrateGuid < 0) {
+        m_session = pool.Acquire(key);
     }
-    auto deviceSessionOpen = reinterpret_cast<NiDeviceSessionOpenFunc>(g_funcMap[NI_DEVICE_SESSION_OPEN]);
-    ni_retcode_t ret = (*deviceSessionOpen)(&m_sessionCtx, NI_DEVICE_TYPE_ENCODER);
-    if (ret != NI_RETCODE_SUCCESS) {
-        ERR("init encoder failed: device session open error %d", ret);
+    config.guid = m_migrateGuid;
+    m_migrateGuid = -1;
+    bool reused = (m_session != nullptr);
+    if (!reused) {
+        m_session = OpenSession(config);
+        if (m_session == nullptr) {
+            ERR("init encoder failed: open session error");
+            return VIDEO_ENCODER_INIT_FAIL;
+        }
+    }
+    config.guid = -1;
+    if (GetIntEncParam(PROP_SESSION_PREWARM.c_str()) == 1) {
+        pool.Prewarm(key, [config]() { return OpenSession(config); });
+    }
+    if (!InitFramePool()) {
+        ERR("init encoder failed: init frame pool error");
+        ReleaseFramePool();
+        CloseSession(*m_session);
+        m_session.reset();
         return VIDEO_ENCODER_INIT_FAIL;
     }
-    m_frame.data.frame.start_of_stream = 1;
+    m_inFlight = 0;
+    m_framesSent = 0;
+    m_packetsRead = 0;
+    m_forcedKeyFrame = 0;
+    // 新会话首帧即为带参数集的IDR；复用的会话需强制IDR并重发参数集，切断与之前码流的参考关系
+    m_keyFramePending = reused;
+    m_packetCapacity = EstimatePacketCapacity();
+    m_sessionFramerate = m_encParams.framerate;
+    m_reconfigPending = false;
+    if (reused && (m_session->encParams.bitrate != static_cast<int>(m_encParams.bitrate) ||
+        m_session->encParams.hevc_enc_params.intra_period != static_cast<int>(m_encParams.gopsize))) {
+        PrepareReconfig();
+    }
     m_isInited = true;
-    INFO("init encoder success");
+    INFO("init encoder success, %s session %s, pipeline depth %u, packet capacity %u",
+        reused ? "reused" : "opened", key.c_str(), m_pipelineDepth, m_packetCapacity);
     return VIDEO_ENCODER_SUCCESS;
 }
 
+uint32_t VideoEncoderNetint::GetPipelineDepth()
+{
+    int32_t depth = GetIntEncParam(PROP_PIPELINE_DEPTH.c_str());
+    if (depth < static_cast<int32_t>(PIPELINE_DEPTH_MIN) || depth > static_cast<int32_t>(PIPELINE_DEPTH_MAX)) {
+        return PIPELINE_DEPTH_MIN;
+    }
+    return static_cast<uint32_t>(depth);
+}
+
 bool VideoEncoderNetint::VerifyEncodeRoParams(int32_t width, int32_t height, int32_t framerate)
 {
     bool isEncodeParamsTrue = true;
@@ -286,48 +362,237 @@ bool VideoEncoderNetint::LoadNetintSharedLib()
     return true;
 }
 
-bool VideoEncoderNetint::InitCodec()
+std::unique_ptr<NetintEncoderSession> VideoEncoderNetint::OpenSession(const SessionConfig &config)
 {
-    if (!InitCtxParams()) {
+    auto session = std::make_unique<NetintEncoderSession>();
+    if (!InitCtxParams(*session, config)) {
         ERR("init context params failed");
-        return false;
+        return nullptr;
     }
+    ni_session_context_t &sessionCtx = session->sessionCtx;
     auto deviceSessionContextInit =
         reinterpret_cast<NiDeviceSessionContextInitFunc>(g_funcMap[NI_DEVICE_SESSION_CONTEXT_INIT]);
-    (*deviceSessionContextInit)(&m_sessionCtx);
-    m_sessionCtx.session_id = NI_INVALID_SESSION_ID;
-    m_sessionCtx.codec_format = (m_codec == EN_H264) ? NI_CODEC_FORMAT_H264 : NI_CODEC_FORMAT_H265;
-    auto rsrcAllocateAuto = reinterpret_cast<NiRsrcAllocateAutoFunc>(g_funcMap[NI_RSRC_ALLOCATE_AUTO]);
-    m_devCtx = (*rsrcAllocateAuto)(NI_DEVICE_TYPE_ENCODER, EN_ALLOC_LEAST_LOAD, m_codec,
-        m_encParams.width, m_encParams.height, m_encParams.framerate, &m_load);
-    if (m_devCtx == nullptr) {
-        ERR("rsrc allocate auto failed");
-        return false;
+    (*deviceSessionContextInit)(&sessionCtx);
+    sessionCtx.session_id = NI_INVALID_SESSION_ID;
+    sessionCtx.codec_format = (config.codec == EN_H264) ? NI_CODEC_FORMAT_H264 : NI_CODEC_FORMAT_H265;
+    sessionCtx.device_handle = NI_INVALID_DEVICE_HANDLE;
+    sessionCtx.blk_io_handle = NI_INVALID_DEVICE_HANDLE;
+    if (!AllocateDevice(*session, config)) {
+        ERR("rsrc allocate failed");
+        CloseSession(*session);
+        return nullptr;
     }
-    std::string xcoderId = m_devCtx->p_device_info->blk_name;
-    INFO("netint xcoder id: %s", xcoderId.c_str());
+    std::string xcoderId = session->devCtx->p_device_info->blk_name;
+    INFO("netint xcoder id: %s, guid %d", xcoderId.c_str(), session->guid);
     auto deviceOpen = reinterpret_cast<NiDeviceOpenFunc>(g_funcMap[NI_DEVICE_OPEN]);
-    ni_device_handle_t devHandle = (*deviceOpen)(xcoderId.c_str(), &m_sessionCtx.max_nvme_io_size);
-    ni_device_handle_t blkHandle = (*deviceOpen)(xcoderId.c_str(), &m_sessionCtx.max_nvme_io_size);
-    if ((devHandle == NI_INVALID_DEVICE_HANDLE) || (blkHandle == NI_INVALID_DEVICE_HANDLE)) {
+    sessionCtx.device_handle = (*deviceOpen)(xcoderId.c_str(), &sessionCtx.max_nvme_io_size);
+    sessionCtx.blk_io_handle = (*deviceOpen)(xcoderId.c_str(), &sessionCtx.max_nvme_io_size);
+    if ((sessionCtx.device_handle == NI_INVALID_DEVICE_HANDLE) ||
+        (sessionCtx.blk_io_handle == NI_INVALID_DEVICE_HANDLE)) {
         ERR("device open falied");
-        return false;
+        CloseSession(*session);
+        return nullptr;
+    }
+    sessionCtx.hw_id = 0;
+    sessionCtx.p_session_config = &session->encParams;
+    sessionCtx.src_bit_depth = BIT_DEPTH;
+    sessionCtx.src_endian = NI_LITTLE_ENDIAN_PLATFORM;
+    sessionCtx.bit_depth_factor = 1;
+    auto deviceSessionOpen = reinterpret_cast<NiDeviceSessionOpenFunc>(g_funcMap[NI_DEVICE_SESSION_OPEN]);
+    ni_retcode_t ret = (*deviceSessionOpen)(&sessionCtx, NI_DEVICE_TYPE_ENCODER);
+    if (ret != NI_RETCODE_SUCCESS) {
+        ERR("device session open error %d", ret);
+        CloseSession(*session);
+        return nullptr;
     }
-    m_sessionCtx.device_handle = devHandle;
-    m_sessionCtx.blk_io_handle = blkHandle;
-    m_sessionCtx.hw_id = 0;
-    m_sessionCtx.p_session_config = &m_niEncParams;
-    m_sessionCtx.src_bit_depth = BIT_DEPTH;
-    m_sessionCtx.src_endian = NI_LITTLE_ENDIAN_PLATFORM;
-    m_sessionCtx.bit_depth_factor = 1;
+    return session;
+}
+
+void VideoEncoderNetint::CloseSession(NetintEncoderSession &session)
+{
+    ni_session_context_t &sessionCtx = session.sessionCtx;
+    if (sessionCtx.session_id != NI_INVALID_SESSION_ID && g_funcMap[NI_DEVICE_SESSION_CLOSE] != nullptr) {
+        auto deviceSessionClose = reinterpret_cast<NiDeviceSessionCloseFunc>(g_funcMap[NI_DEVICE_SESSION_CLOSE]);
+        ni_retcode_t ret = (*deviceSessionClose)(&sessionCtx, 1, NI_DEVICE_TYPE_ENCODER);
+        if (ret != NI_RETCODE_SUCCESS) {
+            WARN("device session close failed: ret = %d", ret);
+        }
+    }
+    if (g_funcMap[NI_DEVICE_CLOSE] != nullptr) {
+        auto deviceClose = reinterpret_cast<NiDeviceCloseFunc>(g_funcMap[NI_DEVICE_CLOSE]);
+        if (sessionCtx.device_handle != NI_INVALID_DEVICE_HANDLE) {
+            (*deviceClose)(sessionCtx.device_handle);
+        }
+        if (sessionCtx.blk_io_handle != NI_INVALID_DEVICE_HANDLE) {
+            (*deviceClose)(sessionCtx.blk_io_handle);
+        }
+    }
+    if (session.devCtx != nullptr) {
+        INFO("destroy rsrc start");
+        PublishDeviceLoad(session, false);
+        if (g_funcMap[NI_RSRC_RELEASE_RESOURCE] != nullptr) {
+            auto rsrcReleaseResource = reinterpret_cast<NiRsrcReleaseResourceFunc>(g_funcMap[NI_RSRC_RELEASE_RESOURCE]);
+            (*rsrcReleaseResource)(session.devCtx, session.codec, session.load);
+        }
+        if (g_funcMap[NI_RSRC_FREE_DEVICE_CONTEXT] != nullptr) {
+            auto rsrcFreeDeviceContext =
+            reinterpret_cast<NiRsrcFreeDeviceContextFunc>(g_funcMap[NI_RSRC_FREE_DEVICE_CONTEXT]);
+            (*rsrcFreeDeviceContext)(session.devCtx);
+        }
+        session.devCtx = nullptr;
+        INFO("destroy rsrc done");
+    }
+    if (g_funcMap[NI_DEVICE_SESSION_CONTEXT_FREE] != nullptr) {
+        auto deviceSessionContextFree =
+            reinterpret_cast<NiDeviceSessionContextFreeFunc>(g_funcMap[NI_DEVICE_SESSION_CONTEXT_FREE]);
+        (*deviceSessionContextFree)(&sessionCtx);
+    }
+}
+
+std::vector<DeviceLoad> VideoEncoderNetint::CollectDeviceLoads()
+{
+    std::vector<DeviceLoad> devices;
+    auto rsrcListDevices = reinterpret_cast<NiRsrcListDevicesFunc>(g_funcMap[NI_RSRC_LIST_DEVICES]);
+    if (rsrcListDevices == nullptr) {
+        return devices;
+    }
+    std::vector<ni_device_info_t> infos(DEVICE_NUM_MAX);
+    int count = 0;
+    if ((*rsrcListDevices)(NI_DEVICE_TYPE_ENCODER, infos.data(), &count) != NI_RETCODE_SUCCESS) {
+        WARN("list encoder devices failed");
+        return devices;
+    }
+    count = std::min(std::max(count, 0), DEVICE_NUM_MAX);
+    // 设备guid取自设备信息中的module_id，与列表中的下标无关，分配与迁移均按guid指定设备
+    for (int i = 0; i < count; ++i) {
+        const ni_device_info_t &info = infos[i];
+        DeviceLoad device;
+        device.guid = info.module_id;
+        device.capacity = DeviceScheduler::Capacity(info.max_fps_1080p);
+        device.instances = info.active_num_inst;
+        device.maxInstances = info.max_instance_cnt;
+        // 设备上报负载有延迟，同时参考按已分配会话帧率 × 分辨率累计的像素负载
+        uint64_t pixelLoad = (device.capacity != 0) ?
+            static_cast<uint64_t>(info.xcode_load_pixel) * DeviceScheduler::LOAD_FULL / device.capacity : 0;
+        uint64_t load = std::max<uint64_t>(std::max({ info.load, info.model_load, 0 }), pixelLoad);
+        device.loadPercent = static_cast<uint32_t>(std::min<uint64_t>(load, DeviceScheduler::LOAD_FULL));
+        devices.push_back(device);
+    }
+    return devices;
+}
+
+bool VideoEncoderNetint::AllocateDevice(NetintEncoderSession &session, const SessionConfig &config)
+{
+    const EncodeParams &params = config.params;
+    session.pixelRate = static_cast<uint64_t>(params.width) * params.height * params.framerate;
+    std::vector<DeviceLoad> devices = CollectDeviceLoads();
+    int guid = config.guid;
+    if (guid < 0) {
+        PlacementPolicy policy = DeviceScheduler::ParsePolicy(GetStrEncParam(PROP_SCHED_POLICY.c_str()));
+        guid = DeviceScheduler::Select(devices, session.pixelRate, policy);
+    }
+    if (guid >= 0) {
+        auto rsrcAllocateDirect = reinterpret_cast<NiRsrcAllocateDirectFunc>(g_funcMap[NI_RSRC_ALLOCATE_DIRECT]);
+        session.devCtx = (*rsrcAllocateDirect)(NI_DEVICE_TYPE_ENCODER, guid, config.codec,
+            params.width, params.height, params.framerate, &session.load);
+    }
+    if (session.devCtx == nullptr) {
+        WARN("rsrc allocate direct on guid %d failed, fallback to auto allocation", guid);
+        auto rsrcAllocateAuto = reinterpret_cast<NiRsrcAllocateAutoFunc>(g_funcMap[NI_RSRC_ALLOCATE_AUTO]);
+        session.devCtx = (*rsrcAllocateAuto)(NI_DEVICE_TYPE_ENCODER, EN_ALLOC_LEAST_LOAD, config.codec,
+            params.width, params.height, params.framerate, &session.load);
+        if (session.devCtx == nullptr) {
+            return false;
+        }
+    }
+    session.guid = session.devCtx->p_device_info->module_id;
+    for (const auto &device : devices) {
+        if (device.guid == session.guid) {
+            session.loadPercent = DeviceScheduler::SessionLoad(device, session.pixelRate);
+        }
+    }
+    PublishDeviceLoad(session, true);
     return true;
 }
 
-bool VideoEncoderNetint::InitCtxParams()
+void VideoEncoderNetint::PublishDeviceLoad(NetintEncoderSession &session, bool add)
+{
+    auto updateDeviceLoad = reinterpret_cast<NiRsrcUpdateDeviceLoadFunc>(g_funcMap[NI_RSRC_UPDATE_DEVICE_LOAD]);
+    if (updateDeviceLoad == nullptr || session.devCtx == nullptr || session.loadPercent == 0) {
+        return;
+    }
+    // 设备上报负载会周期性覆盖该值，此处仅让其他进程在上报前感知会话的打开与关闭；
+    // 负载与实例数的读取和写回在设备共享锁内完成，避免多个进程同时打开或关闭会话时互相覆盖
+    ni_lock_handle_t devLock = session.devCtx->lock;
+    bool locked = (devLock != NI_INVALID_LOCK_HANDLE) && (flock(devLock, LOCK_EX) == 0);
+    if (!locked) {
+        WARN("lock device %d failed, publish load without lock", session.guid);
+    }
+    const ni_device_info_t &info = *session.devCtx->p_device_info;
+    int delta = add ? 1 : -1;
+    int load = info.load + delta * static_cast<int>(session.loadPercent);
+    load = std::min(std::max(load, 0), static_cast<int>(DeviceScheduler::LOAD_FULL));
+    int swInstanceCnt = std::min(std::max(info.active_num_inst + delta, 0), NI_MAX_SW_INSTANCE_COUNT);
+    // 库函数内部会对同一文件描述符加锁并在写回后解锁，此处的解锁仅在库函数未解锁时生效
+    if ((*updateDeviceLoad)(session.devCtx, load, swInstanceCnt, info.sw_instance) != NI_RETCODE_SUCCESS) {
+        WARN("update load of device %d failed", session.guid);
+    }
+    if (locked) {
+        (void) flock(devLock, LOCK_UN);
+    }
+}
+
+void VideoEncoderNetint::CheckMigration()
+{
+    if (m_migrateThreshold == 0 || m_resetFlag || m_session == nullptr || m_framesSent == 0) {
+        return;
+    }
+    bool idrDue = m_keyFramePending || (m_encParams.gopsize != 0 && m_framesSent % m_encParams.gopsize == 0);
+    if (!idrDue) {
+        return;
+    }
+    int target = DeviceScheduler::MigrationTarget(CollectDeviceLoads(), m_session->guid, m_session->pixelRate,
+        m_migrateThreshold);
+    if (target < 0) {
+        return;
+    }
+    INFO("device load imbalance over %u%%, migrate session from device %d to %d",
+        m_migrateThreshold, m_session->guid, target);
+    m_migrateGuid = target;
+    m_resetFlag = true;
+}
+
+std::string VideoEncoderNetint::SessionKey(const SessionConfig &config)
 {
+    // 会话打开后分辨率、档位、帧率与低延时模式不可更改，码率与关键帧间隔在取出后通过重配置调整
+    return std::string((config.codec == EN_H264) ? "h264_" : "h265_") + std::to_string(config.params.width) + "x" +
+        std::to_string(config.params.height) + "_" + config.params.profile + "_" +
+        std::to_string(config.params.framerate) + ((config.pipelineDepth > 1) ? "_pipelined" : "_lowdelay");
+}
+
+SessionPool<NetintEncoderSession> &VideoEncoderNetint::GetSessionPool()
+{
+    static SessionPool<NetintEncoderSession> pool(CloseSession);
+    return pool;
+}
+
+uint32_t VideoEncoderNetint::GetSessionPoolSize()
+{
+    int32_t size = GetIntEncParam(PROP_SESSION_POOL_SIZE.c_str());
+    if (size < 0 || size > static_cast<int32_t>(SESSION_POOL_SIZE_MAX)) {
+        return 0;
+    }
+    return static_cast<uint32_t>(size);
+}
+
+bool VideoEncoderNetint::InitCtxParams(NetintEncoderSession &session, const SessionConfig &config)
+{
+    const EncodeParams &params = config.params;
+    ni_encoder_params_t &niEncParams = session.encParams;
+    session.codec = config.codec;
     auto encInitDefaultParams = reinterpret_cast<NiEncInitDefaultParamsFunc>(g_funcMap[NI_ENCODER_INIT_DEFAULT_PARAMS]);
     ni_retcode_t ret = (*encInitDefaultParams)(
-        &m_niEncParams, m_encParams.framerate, 1, m_encParams.bitrate, m_encParams.width, m_encParams.height);
+        &niEncParams, params.framerate, 1, params.bitrate, params.width, params.height);
     if (ret != NI_RETCODE_SUCCESS) {
         ERR("encoder init default params error %d", ret);
         return false;
@@ -339,36 +604,43 @@ bool VideoEncoderNetint::InitCtxParams()
     const std::string lowDelayPocTypeOpt = "useLowDelayPocType";
     const std::string noBframeOption = "2";
     const std::string enableOption = "1";
+    const std::string disableOption = "0";
 
     std::unordered_map<std::string, std::string> xcoderParams = {
         { gopPresetOpt, noBframeOption },   // GOP: IPPP...
-        { lowDelayOpt, enableOption },      // enable low delay mode
+        // low delay mode returns each packet before accepting the next frame, disable it when pipelining
+        { lowDelayOpt, (config.pipelineDepth > 1) ? disableOption : enableOption },
         { rateControlOpt, enableOption },   // rate control enable
-        { profileOpt, m_encParams.profile },     // profile: Baseline(h.264), Main(h.265)
+        { profileOpt, params.profile },     // profile: Baseline(h.264), Main(h.265)
         { lowDelayPocTypeOpt, enableOption} // enable lowDelayPoc
     };
     auto encParamsSetValue = reinterpret_cast<NiEncParamsSetValueFunc>(g_funcMap[NI_ENCODER_PARAMS_SET_VALUE]);
     for (const auto &xParam : xcoderParams) {
-        ret = (*encParamsSetValue)(&m_niEncParams, xParam.first.c_str(), xParam.second.c_str());
+        ret = (*encParamsSetValue)(&niEncParams, xParam.first.c_str(), xParam.second.c_str());
         if (ret != NI_RETCODE_SUCCESS) {
             ERR("encoder params set value error %d: name %s : value %s",
                 ret, xParam.first.c_str(), xParam.second.c_str());
             return false;
         }
     }
-    if (m_widthAlign > m_width) {
-        m_niEncParams.hevc_enc_params.conf_win_right += m_widthAlign - m_width;
+    const int width = static_cast<int>(params.width);
+    const int height = static_cast<int>(params.height);
+    const int align = (config.codec == EN_H264) ? 16 : 8;  // h.264: 16-aligned, h.265: 8-aligned
+    const int widthAlign = std::max(((width + align - 1) / align) * align, NI_MIN_WIDTH);
+    const int heightAlign = std::max(((height + align - 1) / align) * align, NI_MIN_HEIGHT);
+    if (widthAlign > width) {
+        niEncParams.hevc_enc_params.conf_win_right += widthAlign - width;
         INFO("YUV width aligned adjustment, from %d to %d, win rignt = %d",
-            m_width, m_widthAlign, m_niEncParams.hevc_enc_params.conf_win_right);
-        m_niEncParams.source_width = m_widthAlign;
+            width, widthAlign, niEncParams.hevc_enc_params.conf_win_right);
+        niEncParams.source_width = widthAlign;
     }
-    if (m_heightAlign > m_height) {
-        m_niEncParams.hevc_enc_params.conf_win_bottom += m_heightAlign - m_height;
+    if (heightAlign > height) {
+        niEncParams.hevc_enc_params.conf_win_bottom += heightAlign - height;
         INFO("YUV height aligned adjustment, from %d to %d, win bottom = %d",
-            m_height, m_heightAlign, m_niEncParams.hevc_enc_params.conf_win_bottom);
-        m_niEncParams.source_height = m_heightAlign;
+            height, heightAlign, niEncParams.hevc_enc_params.conf_win_bottom);
+        niEncParams.source_height = heightAlign;
     }
-    m_niEncParams.hevc_enc_params.intra_period = m_encParams.gopsize;
+    niEncParams.hevc_enc_params.intra_period = params.gopsize;
     return true;
 }
 
@@ -380,46 +652,147 @@ EncoderRetCode VideoEncoderNetint::StartEncoder()
 
 EncoderRetCode VideoEncoderNetint::EncodeOneFrame(const uint8_t *inputData, uint32_t inputSize,
     uint8_t **outputData, uint32_t *outputSize)
+{
+    EncoderRetCode ret = SubmitFrame(inputData, inputSize);
+    if (ret != VIDEO_ENCODER_SUCCESS) {
+        return ret;
+    }
+    return PollPacket(outputData, outputSize, true);
+}
+
+EncoderRetCode VideoEncoderNetint::SubmitFrame(const uint8_t *inputData, uint32_t inputSize)
 {
     uint32_t frameSize = static_cast<uint32_t>(m_width * m_height * NUM_OF_PLANES / COMPRESS_RATIO);
     if (inputSize < frameSize) {
-        ERR("input size error: size(%u) < frame size(%u)", inputSize, frameSize);
+        ERR_LIMITED("input size error: size(%u) < frame size(%u)", inputSize, frameSize);
         return VIDEO_ENCODER_ENCODE_FAIL;
     }
+    if (m_inFlight >= m_pipelineDepth) {
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    EncoderRetCode ret = PrepareSession();
+    if (ret != VIDEO_ENCODER_SUCCESS) {
+        return ret;
+    }
+    ni_session_data_io_t *frame = InitFrameData(inputData);
+    if (frame == nullptr) {
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    return WriteFrame(frame);
+}
 
-    std::string isParamChange = GetStrEncParam( "persist.vmi.video.encode.param_adjusting");
-    if (isParamChange == "1") {
-        if ((!GetRoEncParam()) || (!GetPersistEncParam())) {
-            ERR("init encoder failed: GetEncParam failed");
-            return VIDEO_ENCODER_INIT_FAIL;
-        }
-        SetEncodeParams();
-        SetEncParam("persist.vmi.video.encode.param_adjusting", "0");
-    } else if (isParamChange != "0") {
-        WARN("Invalid property value[%s] for encode param adjusting", isParamChange.c_str());
-        SetEncParam("persist.vmi.video.encode.param_adjusting", "0");
+EncoderRetCode VideoEncoderNetint::DequeueInputBuffer(EncoderInputBuffer *buffer)
+{
+    if (buffer == nullptr) {
+        ERR("input buffer descriptor is null");
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    if (!m_isInited) {
+        ERR("dequeue input buffer failed: encoder is not initialized");
+        return VIDEO_ENCODER_ENCODE_FAIL;
     }
+    if (m_inFlight >= m_pipelineDepth) {
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    EncoderRetCode ret = PrepareSession();
+    if (ret != VIDEO_ENCODER_SUCCESS) {
+        return ret;
+    }
+    uint32_t index = 0;
+    ni_session_data_io_t *frame = NextFreeFrame(&index);
+    if (frame == nullptr) {
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    ni_frame_t *dataFrame = &(frame->data.frame);
+    uint8_t *base = static_cast<uint8_t *>(dataFrame->p_buffer);
+    *buffer = {};
+    buffer->index = index;
+    buffer->data = base;
+    buffer->capacity = dataFrame->data_len[Y_INDEX] + dataFrame->data_len[U_INDEX] + dataFrame->data_len[V_INDEX];
+    buffer->planeNum = NUM_OF_PLANES;
+    for (int i = 0; i < NUM_OF_PLANES; ++i) {
+        buffer->stride[i] = static_cast<uint32_t>(m_hwPlaneStride[i]);
+        buffer->offset[i] = static_cast<uint32_t>(static_cast<uint8_t *>(dataFrame->p_data[i]) - base);
+        buffer->height[i] = dataFrame->data_len[i] / static_cast<uint32_t>(m_hwPlaneStride[i]);
+    }
+    m_frameDequeued[index] = true;
+    ++m_dequeuedCount;
+    return VIDEO_ENCODER_SUCCESS;
+}
+
+EncoderRetCode VideoEncoderNetint::QueueInputBuffer(const EncoderInputBuffer &buffer)
+{
+    if (!m_isInited) {
+        ERR("queue input buffer failed: encoder is not initialized");
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    if (buffer.index >= m_frames.size() || !m_frameDequeued[buffer.index] ||
+        buffer.data != m_frames[buffer.index].data.frame.p_buffer) {
+        ERR("queue input buffer failed: buffer %u is not dequeued", buffer.index);
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    if (m_resetFlag) {
+        // 重置会按新参数重建输入帧池，申请时返回的平面布局已失效，归还缓冲区由调用者重新申请
+        m_frameDequeued[buffer.index] = false;
+        --m_dequeuedCount;
+        ERR_LIMITED("queue input buffer failed: buffer %u is invalidated by pending reset", buffer.index);
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    if (m_inFlight >= m_pipelineDepth) {
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    ni_session_data_io_t *frame = &m_frames[buffer.index];
+    ResetFrameFields(&(frame->data.frame));
+    EncoderRetCode ret = WriteFrame(frame);
+    if (ret != VIDEO_ENCODER_QUEUE_FULL) {
+        m_frameDequeued[buffer.index] = false;
+        --m_dequeuedCount;
+    }
+    return ret;
+}
 
+EncoderRetCode VideoEncoderNetint::PrepareSession()
+{
+    if (m_paramAdjustingWatcher.Update() && !HandleParamAdjusting()) {
+        return VIDEO_ENCODER_INIT_FAIL;
+    }
+
+    CheckMigration();
     if (m_resetFlag) {
+        // 重置会释放输入帧池，未提交的输入缓冲区随之失效
+        if (m_dequeuedCount != 0) {
+            WARN("reset encoder invalidates %u dequeued input buffers", m_dequeuedCount);
+            m_frameDequeued.assign(m_frameDequeued.size(), false);
+            m_dequeuedCount = 0;
+        }
+        // 重置会关闭会话，先取回在途帧的编码输出；这些输出属于同一码流，重置后仍由PollPacket交付
+        DrainEncoder();
+        std::deque<std::vector<uint8_t>> drained = std::move(m_drainedPackets);
         if (ResetEncoder() != VIDEO_ENCODER_SUCCESS) {
             ERR("reset encoder failed while encoding");
             return VIDEO_ENCODER_ENCODE_FAIL;
         }
+        m_drainedPackets = std::move(drained);
         m_resetFlag = false;
     }
+    return VIDEO_ENCODER_SUCCESS;
+}
 
-    std::string isKeyframeChange = GetStrEncParam("persist.vmi.video.encode.keyframe");
-    if (isKeyframeChange == "1") {
-        INFO("Encoder set key frame");
-        ForceKeyFrame();
-        SetEncParam("persist.vmi.video.encode.keyframe", "0");
-    } else if (isKeyframeChange != "0") {
-        WARN("Invalid property value[%s] for property[keyFrame], set to [0]", isKeyframeChange.c_str());
-        SetEncParam("persist.vmi.video.encode.keyframe", "0");
+EncoderRetCode VideoEncoderNetint::WriteFrame(ni_session_data_io_t *frame)
+{
+    if (m_keyframeWatcher.Update()) {
+        HandleKeyframeRequest();
     }
 
-    if (!InitFrameData(inputData)) {
-        return VIDEO_ENCODER_ENCODE_FAIL;
+    if (m_reconfigPending) {
+        AttachReconfig(&(frame->data.frame));
+    }
+    // 强制IDR时同时要求重发SPS/PPS(/VPS)，并仅对该帧开启帧类型强制，其余帧仍由设备按GOP决定帧类型
+    if (m_keyFramePending) {
+        frame->data.frame.force_key_frame = 1;
+        frame->data.frame.force_headers = 1;
+        frame->data.frame.ni_pict_type = PIC_TYPE_IDR;
+        m_session->sessionCtx.force_frame_type = 1;
     }
 
     DBG("===> encoder send data begin <===");
@@ -428,37 +801,102 @@ EncoderRetCode VideoEncoderNetint::EncodeOneFrame(const uint8_t *inputData, uint
     uint32_t sentCnt = 0;
     constexpr int maxSentTimes = 3;
     while (oneSent == 0 && sentCnt < maxSentTimes) {
-        oneSent = (*deviceSessionWrite)(&m_sessionCtx, &m_frame, NI_DEVICE_TYPE_ENCODER);
+        oneSent = (*deviceSessionWrite)(&m_session->sessionCtx, frame, NI_DEVICE_TYPE_ENCODER);
         ++sentCnt;
     }
-    if (oneSent < 0 || sentCnt == maxSentTimes) {
-        ERR("device session write error, return sent size = %d", oneSent);
+    m_session->sessionCtx.force_frame_type = 0;
+    if (oneSent == 0 && m_inFlight > 0) {
+        DBG("device input queue full, %u frames in flight", m_inFlight);
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    if (oneSent <= 0) {
+        ERR_LIMITED("device session write error, return sent size = %d", oneSent);
         return VIDEO_ENCODER_ENCODE_FAIL;
     }
-    ni_frame_t dataFrame = m_frame.data.frame;
+    ++m_inFlight;
+    ++m_framesSent;
+    const ni_frame_t &dataFrame = frame->data.frame;
+    if (dataFrame.force_key_frame != 0) {
+        m_keyFramePending = false;
+        m_forcedKeyFrame = m_framesSent;
+    }
+    if (dataFrame.reconf_len != 0) {
+        // 会话参数与设备保持一致，会话归还会话池后据此判断是否需要重配置
+        m_session->encParams.bitrate = m_changeParams.bitRate;
+        m_session->encParams.hevc_enc_params.intra_period = m_changeParams.intraPeriod;
+        m_reconfigPending = false;
+        INFO("encoder reconfig applied: [bitrate, gopsize, framerate] = [%u,%u,%u], target rate %d",
+            m_encParams.bitrate, m_encParams.gopsize, m_encParams.framerate, m_changeParams.bitRate);
+    }
     uint32_t sentBytes = dataFrame.data_len[Y_INDEX] + dataFrame.data_len[U_INDEX] + dataFrame.data_len[V_INDEX];
-    DBG("encoder send data success, total sent data size = %u", sentBytes);
+    DBG("encoder send data success, total sent data size = %u, in flight = %u", sentBytes, m_inFlight);
+    return VIDEO_ENCODER_SUCCESS;
+}
+
+EncoderRetCode VideoEncoderNetint::PollPacket(uint8_t **outputData, uint32_t *outputSize, bool wait)
+{
+    if (!m_drainedPackets.empty()) {
+        m_drainedPacket = std::move(m_drainedPackets.front());
+        m_drainedPackets.pop_front();
+        *outputData = m_drainedPacket.data();
+        *outputSize = static_cast<uint32_t>(m_drainedPacket.size());
+        return VIDEO_ENCODER_SUCCESS;
+    }
+    if (m_inFlight == 0) {
+        return VIDEO_ENCODER_NO_OUTPUT;
+    }
+    return ReadPacket(outputData, outputSize, wait);
+}
 
+EncoderRetCode VideoEncoderNetint::ReadPacket(uint8_t **outputData, uint32_t *outputSize, bool wait)
+{
     DBG("===> encoder receive data begin <===");
-    ni_packet_t *dataPacket = &(m_packet.data.packet);
-    auto packetBufferAlloc = reinterpret_cast<NiPacketBufferAllocFunc>(g_funcMap[NI_PACKET_BUFFER_ALLOC]);
-    ni_retcode_t ret = (*packetBufferAlloc)(dataPacket, frameSize);
-    if (ret != NI_RETCODE_SUCCESS) {
-        ERR("packet buffer alloc error %d", ret);
+    ni_session_data_io_t *packet = AcquirePacket();
+    if (packet == nullptr) {
         return VIDEO_ENCODER_ENCODE_FAIL;
     }
+    ni_packet_t *dataPacket = &(packet->data.packet);
     auto deviceSessionRead = reinterpret_cast<NiDeviceSessionReadFunc>(g_funcMap[NI_DEVICE_SESSION_READ]);
-    int oneRead = (*deviceSessionRead)(&m_sessionCtx, &m_packet, NI_DEVICE_TYPE_ENCODER);
-    DBG("encoder receive data: total received data size = %d", oneRead);
     const int metaDataSize = NI_FW_ENC_BITSTREAM_META_DATA_SIZE;
-    if (oneRead > metaDataSize) {
-        if (m_sessionCtx.pkt_num == 0) {
-            m_sessionCtx.pkt_num = 1;
+    int oneRead = 0;
+    for (uint32_t waitTime = 0; ; waitTime += READ_RETRY_INTERVAL_US) {
+        oneRead = (*deviceSessionRead)(&m_session->sessionCtx, packet, NI_DEVICE_TYPE_ENCODER);
+        if (oneRead != 0 || !wait || waitTime >= READ_TIMEOUT_US) {
+            break;
+        }
+        (void) usleep(READ_RETRY_INTERVAL_US);
+    }
+    DBG("encoder receive data: total received data size = %d", oneRead);
+    if (oneRead == 0) {
+        if (wait) {
+            ERR("encoder receive data timeout, %u frames in flight", m_inFlight);
+            return VIDEO_ENCODER_ENCODE_FAIL;
         }
-    } else if (oneRead != 0) {
-        ERR("received %d bytes <= metadata size %d", oneRead, metaDataSize);
+        return VIDEO_ENCODER_NO_OUTPUT;
+    }
+    if (oneRead <= metaDataSize) {
+        ERR_LIMITED("received %d bytes <= metadata size %d", oneRead, metaDataSize);
         return VIDEO_ENCODER_ENCODE_FAIL;
     }
+    if (m_session->sessionCtx.pkt_num == 0) {
+        m_session->sessionCtx.pkt_num = 1;
+    }
+    --m_inFlight;
+    ++m_packetsRead;
+    if (m_packetsRead == m_forcedKeyFrame) {
+        m_forcedKeyFrame = 0;
+        if (dataPacket->frame_type == PIC_TYPE_I) {
+            INFO("forced key frame delivered on packet %llu", static_cast<unsigned long long>(m_packetsRead));
+            SetEncParam(PROP_KEYFRAME_RESULT.c_str(), "1");
+        } else {
+            WARN_LIMITED("forced key frame not honored, packet %llu frame type %u",
+                static_cast<unsigned long long>(m_packetsRead), dataPacket->frame_type);
+            SetEncParam(PROP_KEYFRAME_RESULT.c_str(), "-1");
+        }
+    }
+    if (dataPacket->data_len + NI_MAX_PACKET_SZ > m_packetCapacity) {
+        GrowPacketCapacity();
+    }
     DBG("encoder receive data success");
 
     *outputData = static_cast<uint8_t *>(dataPacket->p_data) + metaDataSize;
@@ -466,33 +904,175 @@ EncoderRetCode VideoEncoderNetint::EncodeOneFrame(const uint8_t *inputData, uint
     return VIDEO_ENCODER_SUCCESS;
 }
 
-bool VideoEncoderNetint::InitFrameData(const uint8_t *src)
+uint32_t VideoEncoderNetint::EstimatePacketCapacity() const
 {
-    if (src == nullptr) {
-        ERR("input data buffer is null");
-        return false;
+    // 单帧码流上限取VBV缓冲大小（码率 * 缓冲时长），且不超过原始YUV帧大小
+    uint64_t frameSize = static_cast<uint64_t>(m_width) * m_height * NUM_OF_PLANES / COMPRESS_RATIO;
+    int vbvDelayMs = m_session->encParams.hevc_enc_params.rc.rc_init_delay;
+    if (vbvDelayMs <= 0) {
+        vbvDelayMs = VBV_DELAY_DEFAULT_MS;
+    }
+    uint64_t vbvBytes = static_cast<uint64_t>(m_encParams.bitrate) * vbvDelayMs / MS_PER_SECOND / BITS_PER_BYTE;
+    uint64_t capacity = std::max<uint64_t>(std::min(vbvBytes, frameSize), NI_MAX_PACKET_SZ);
+    return static_cast<uint32_t>(capacity + NI_FW_ENC_BITSTREAM_META_DATA_SIZE);
+}
+
+void VideoEncoderNetint::GrowPacketCapacity()
+{
+    uint32_t maxCapacity = static_cast<uint32_t>(m_width * m_height * NUM_OF_PLANES / COMPRESS_RATIO) +
+        NI_FW_ENC_BITSTREAM_META_DATA_SIZE;
+    if (m_packetCapacity >= maxCapacity) {
+        return;
+    }
+    m_packetCapacity = std::min(m_packetCapacity * PACKET_CAPACITY_GROW_FACTOR, maxCapacity);
+    INFO("output packet capacity grown to %u bytes", m_packetCapacity);
+}
+
+ni_session_data_io_t *VideoEncoderNetint::AcquirePacket()
+{
+    if (m_packets.empty()) {
+        m_packets.resize(m_pipelineDepth);
+        m_packetIndex = 0;
+    }
+    ni_session_data_io_t *packet = &m_packets[m_packetIndex];
+    m_packetIndex = (m_packetIndex + 1) % m_packets.size();
+    ni_packet_t *dataPacket = &(packet->data.packet);
+    if (dataPacket->p_buffer != nullptr && dataPacket->buffer_size >= m_packetCapacity) {
+        dataPacket->p_data = dataPacket->p_buffer;
+        dataPacket->data_len = m_packetCapacity;
+        return packet;
+    }
+    auto packetBufferFree = reinterpret_cast<NiPacketBufferFreeFunc>(g_funcMap[NI_PACKET_BUFFER_FREE]);
+    (void) (*packetBufferFree)(dataPacket);
+    auto packetBufferAlloc = reinterpret_cast<NiPacketBufferAllocFunc>(g_funcMap[NI_PACKET_BUFFER_ALLOC]);
+    ni_retcode_t ret = (*packetBufferAlloc)(dataPacket, m_packetCapacity);
+    if (ret != NI_RETCODE_SUCCESS) {
+        ERR("packet buffer alloc error %d", ret);
+        return nullptr;
+    }
+    DBG("output packet buffer allocated: %u bytes", dataPacket->buffer_size);
+    return packet;
+}
+
+void VideoEncoderNetint::ReleasePackets()
+{
+    if (g_funcMap[NI_PACKET_BUFFER_FREE] != nullptr) {
+        auto packetBufferFree = reinterpret_cast<NiPacketBufferFreeFunc>(g_funcMap[NI_PACKET_BUFFER_FREE]);
+        for (auto &packet : m_packets) {
+            ni_retcode_t ret = (*packetBufferFree)(&(packet.data.packet));
+            if (ret != NI_RETCODE_SUCCESS) {
+                WARN("packet buffer free failed: ret = %d", ret);
+            }
+        }
+    }
+    m_packets.clear();
+    m_packetIndex = 0;
+}
+
+void VideoEncoderNetint::DrainEncoder()
+{
+    if (m_inFlight == 0) {
+        return;
+    }
+    INFO("drain encoder: %u frames in flight", m_inFlight);
+    while (m_inFlight > 0) {
+        uint8_t *outputData = nullptr;
+        uint32_t outputSize = 0;
+        if (ReadPacket(&outputData, &outputSize, true) != VIDEO_ENCODER_SUCCESS) {
+            WARN("drain encoder failed, drop %u frames in flight", m_inFlight);
+            m_inFlight = 0;
+            break;
+        }
+        m_drainedPackets.emplace_back(outputData, outputData + outputSize);
+    }
+}
+
+bool VideoEncoderNetint::InitFramePool()
+{
+    auto getHwYuv420pDim = reinterpret_cast<NiGetHwYuv420pDimFunc>(g_funcMap[NI_GET_HW_YUV420P_DIM]);
+    (*getHwYuv420pDim)(m_width, m_height, m_session->sessionCtx.bit_depth_factor,
+        m_session->sessionCtx.codec_format == NI_CODEC_FORMAT_H264, m_hwPlaneStride, m_hwPlaneHeight);
+
+    auto frameBufferAllocV3 = reinterpret_cast<NiFrameBufferAllocV3Func>(g_funcMap[NI_FRAME_BUFFER_ALLOC_V3]);
+    m_frames.resize(m_pipelineDepth);
+    m_frameDequeued.assign(m_pipelineDepth, false);
+    m_dequeuedCount = 0;
+    m_frameIndex = 0;
+    for (auto &frame : m_frames) {
+        ni_frame_t *dataFrame = &(frame.data.frame);
+        ni_retcode_t ret = (*frameBufferAllocV3)(dataFrame, m_width, m_height, m_hwPlaneStride,
+            m_session->sessionCtx.codec_format == NI_CODEC_FORMAT_H264,
+            NI_APP_ENC_FRAME_META_DATA_SIZE + sizeof(ni_encoder_change_params_t));
+        if (ret != NI_RETCODE_SUCCESS || dataFrame->p_data[Y_INDEX] == nullptr) {
+            ERR("frame buffer alloc failed: ret = %d", ret);
+            return false;
+        }
+    }
+    INFO("input frame pool ready: %zu frames, hw stride [%d, %d, %d]", m_frames.size(),
+        m_hwPlaneStride[Y_INDEX], m_hwPlaneStride[U_INDEX], m_hwPlaneStride[V_INDEX]);
+    return true;
+}
+
+void VideoEncoderNetint::ReleaseFramePool()
+{
+    if (g_funcMap[NI_FRAME_BUFFER_FREE] != nullptr) {
+        auto frameBufferFree = reinterpret_cast<NiFrameBufferFreeFunc>(g_funcMap[NI_FRAME_BUFFER_FREE]);
+        for (auto &frame : m_frames) {
+            ni_retcode_t ret = (*frameBufferFree)(&(frame.data.frame));
+            if (ret != NI_RETCODE_SUCCESS) {
+                WARN("frame buffer free failed: ret = %d", ret);
+            }
+        }
+    }
+    m_frames.clear();
+    m_frameDequeued.clear();
+    m_dequeuedCount = 0;
+    m_frameIndex = 0;
+}
+
+ni_session_data_io_t *VideoEncoderNetint::NextFreeFrame(uint32_t *index)
+{
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        uint32_t cur = m_frameIndex;
+        m_frameIndex = (m_frameIndex + 1) % m_frames.size();
+        if (!m_frameDequeued[cur]) {
+            if (index != nullptr) {
+                *index = cur;
+            }
+            return &m_frames[cur];
+        }
     }
-    ni_frame_t *dataFrame = &(m_frame.data.frame);
+    return nullptr;
+}
+
+void VideoEncoderNetint::ResetFrameFields(ni_frame_t *dataFrame) const
+{
     dataFrame->start_of_stream = 0;
     dataFrame->end_of_stream = 0;
     dataFrame->force_key_frame = 0;
+    dataFrame->force_headers = 0;
+    dataFrame->ni_pict_type = PIC_TYPE_P;
     dataFrame->video_width = m_width;
     dataFrame->video_height = m_height;
+    dataFrame->reconf_len = 0;
     dataFrame->extra_data_len = NI_APP_ENC_FRAME_META_DATA_SIZE;
+}
 
-    int dstPlaneStride[NUM_OF_PLANES] = {0};
-    int dstPlaneHeight[NUM_OF_PLANES] = {0};
-    auto getHwYuv420pDim = reinterpret_cast<NiGetHwYuv420pDimFunc>(g_funcMap[NI_GET_HW_YUV420P_DIM]);
-    (*getHwYuv420pDim)(m_width, m_height, m_sessionCtx.bit_depth_factor,
-        m_sessionCtx.codec_format == NI_CODEC_FORMAT_H264, dstPlaneStride, dstPlaneHeight);
-
-    auto frameBufferAllocV3 = reinterpret_cast<NiFrameBufferAllocV3Func>(g_funcMap[NI_FRAME_BUFFER_ALLOC_V3]);
-    ni_retcode_t ret = (*frameBufferAllocV3)(dataFrame, m_width, m_height, dstPlaneStride,
-        m_sessionCtx.codec_format == NI_CODEC_FORMAT_H264, dataFrame->extra_data_len);
-    if (ret != NI_RETCODE_SUCCESS || !dataFrame->p_data[Y_INDEX]) {
-        ERR("frame buffer alloc failed: ret = %d", ret);
-        return false;
+ni_session_data_io_t *VideoEncoderNetint::InitFrameData(const uint8_t *src)
+{
+    if (src == nullptr) {
+        ERR("input data buffer is null");
+        return nullptr;
+    }
+    ni_session_data_io_t *frame = NextFreeFrame(nullptr);
+    if (frame == nullptr) {
+        ERR_LIMITED("no free frame in input frame pool");
+        return nullptr;
     }
+    ni_frame_t *dataFrame = &(frame->data.frame);
+    ResetFrameFields(dataFrame);
+
+    // 调用者数据为只读，设备会在帧尾写入元数据，始终拷贝到池内缓冲；免拷贝输入使用DequeueInputBuffer
     int srcPlaneStride[NUM_OF_PLANES] = { m_width, m_width / COMPRESS_RATIO, m_width / COMPRESS_RATIO };
     int srcPlaneHeight[NUM_OF_PLANES] = { m_height, m_height / COMPRESS_RATIO, m_height / COMPRESS_RATIO };
     uint8_t *srcPlanes[NUM_OF_PLANES];
@@ -501,13 +1081,16 @@ bool VideoEncoderNetint::InitFrameData(const uint8_t *src)
     srcPlanes[V_INDEX] = srcPlanes[U_INDEX] + srcPlaneStride[U_INDEX] * srcPlaneHeight[U_INDEX];
 
     auto copyHwYuv420p = reinterpret_cast<NiCopyHwYuv420pFunc>(g_funcMap[NI_COPY_HW_YUV420P]);
-    (*copyHwYuv420p)((uint8_t**)(dataFrame->p_data), srcPlanes, m_width, m_height, m_sessionCtx.bit_depth_factor,
-        dstPlaneStride, dstPlaneHeight, srcPlaneStride, srcPlaneHeight);
-    return true;
+    (*copyHwYuv420p)((uint8_t**)(dataFrame->p_data), srcPlanes, m_width, m_height, m_session->sessionCtx.bit_depth_factor,
+        m_hwPlaneStride, m_hwPlaneHeight, srcPlaneStride, srcPlaneHeight);
+    return frame;
 }
 
 EncoderRetCode VideoEncoderNetint::StopEncoder()
 {
+    if (m_isInited) {
+        DrainEncoder();
+    }
     INFO("stop encoder success");
     return VIDEO_ENCODER_SUCCESS;
 }
@@ -529,60 +1112,34 @@ void VideoEncoderNetint::DestroyEncoder()
         return;
     }
     INFO("destroy encoder start");
+    // StopEncoder排空后未取走的输出属于本次会话，不能交给重置后的下一次会话
+    m_drainedPackets.clear();
+    m_drainedPacket.clear();
     if (g_libHandle == nullptr) {
         WARN("encoder has been destroyed");
         return;
     }
     CheckFuncPtr();
-    ni_retcode_t ret;
-    if (g_funcMap[NI_DEVICE_SESSION_CLOSE] != nullptr) {
-        auto deviceSessionClose = reinterpret_cast<NiDeviceSessionCloseFunc>(g_funcMap[NI_DEVICE_SESSION_CLOSE]);
-        ret = (*deviceSessionClose)(&m_sessionCtx, 1, NI_DEVICE_TYPE_ENCODER);
-        if (ret != NI_RETCODE_SUCCESS) {
-            WARN("device session close failed: ret = %d", ret);
-        }
-    }
-    if (g_funcMap[NI_DEVICE_CLOSE] != nullptr) {
-        auto deviceClose = reinterpret_cast<NiDeviceCloseFunc>(g_funcMap[NI_DEVICE_CLOSE]);
-        (*deviceClose)(m_sessionCtx.device_handle);
-        (*deviceClose)(m_sessionCtx.blk_io_handle);
-    }
-    if (m_devCtx != nullptr) {
-        INFO("destroy rsrc start");
-        if (g_funcMap[NI_RSRC_RELEASE_RESOURCE] != nullptr) {
-            auto rsrcReleaseResource = reinterpret_cast<NiRsrcReleaseResourceFunc>(g_funcMap[NI_RSRC_RELEASE_RESOURCE]);
-            (*rsrcReleaseResource)(m_devCtx, m_codec, m_load);
-        }
-        if (g_funcMap[NI_RSRC_FREE_DEVICE_CONTEXT] != nullptr) {
-            auto rsrcFreeDeviceContext =
-            reinterpret_cast<NiRsrcFreeDeviceContextFunc>(g_funcMap[NI_RSRC_FREE_DEVICE_CONTEXT]);
-            (*rsrcFreeDeviceContext)(m_devCtx);
-        }
-        m_devCtx = nullptr;
-        INFO("destroy rsrc done");
-    }
-    if (g_funcMap[NI_DEVICE_SESSION_CONTEXT_FREE] != nullptr) {
-        auto deviceSessionContextFree =
-            reinterpret_cast<NiDeviceSessionContextFreeFunc>(g_funcMap[NI_DEVICE_SESSION_CONTEXT_FREE]);
-        (*deviceSessionContextFree)(&m_sessionCtx);
-    }
-    if (g_funcMap[NI_FRAME_BUFFER_FREE] != nullptr) {
-        auto frameBufferFree = reinterpret_cast<NiFrameBufferFreeFunc>(g_funcMap[NI_FRAME_BUFFER_FREE]);
-        ret = (*frameBufferFree)(&(m_frame.data.frame));
-        if (ret != NI_RETCODE_SUCCESS) {
-            WARN("device session close failed: ret = %d", ret);
+    if (m_session != nullptr) {
+        // 取回在途帧后会话可供复用，归还会话池；会话池未启用或已满时由会话池关闭
+        if (m_inFlight != 0) {
+            DrainEncoder();
+            m_drainedPackets.clear();
         }
-    }
-    if (g_funcMap[NI_PACKET_BUFFER_FREE] != nullptr) {
-        auto packetBufferFree = reinterpret_cast<NiPacketBufferFreeFunc>(g_funcMap[NI_PACKET_BUFFER_FREE]);
-        ret = (*packetBufferFree)(&(m_packet.data.packet));
-        if (ret != NI_RETCODE_SUCCESS) {
-            WARN("device session close failed: ret = %d", ret);
+        SessionPool<NetintEncoderSession> &pool = GetSessionPool();
+        if (m_inFlight == 0 && !m_FunPtrError && m_migrateGuid < 0) {
+            pool.Release(m_sessionKey, std::move(m_session));
+        } else {
+            CloseSession(*m_session);
         }
+        m_session.reset();
     }
+    ReleaseFramePool();
+    ReleasePackets();
     if (m_FunPtrError) {
         UnLoadNetintSharedLib();
     }
+    m_inFlight = 0;
     m_isInited = false;
     INFO("destroy encoder done");
 }
@@ -590,6 +1147,8 @@ void VideoEncoderNetint::DestroyEncoder()
 void VideoEncoderNetint::UnLoadNetintSharedLib()
 {
     INFO("UnLoadNetintSharedLib");
+    // 会话池中的会话与预热线程都通过库函数关闭或打开，须在卸载前全部结束
+    GetSessionPool().Drain();
     for (auto &symbol : g_funcMap) {
         symbol.second = nullptr;
     }
@@ -619,20 +1178,90 @@ EncoderRetCode VideoEncoderNetint::ResetEncoder()
 
 EncoderRetCode VideoEncoderNetint::ForceKeyFrame()
 {
-    INFO("force key frame success");
+    if (!m_isInited) {
+        ERR("force key frame failed: encoder is not initialized");
+        return VIDEO_ENCODER_FORCE_KEY_FRAME_FAIL;
+    }
+    // 已送入设备的帧无法修改，IDR标记随下一个写入的帧下发
+    m_keyFramePending = true;
+    SetEncParam(PROP_KEYFRAME_RESULT.c_str(), "0");
+    INFO("force key frame accepted, IDR on frame %llu", static_cast<unsigned long long>(m_framesSent + 1));
     return VIDEO_ENCODER_SUCCESS;
 }
 
 EncoderRetCode VideoEncoderNetint::SetEncodeParams()
 {
     if (EncodeParamsChange()) {
+        // 分辨率与档位只能在重建会话时生效，码率、关键帧间隔与帧率在会话内重配置
+        bool needReset = (m_tmpEncParams.width != m_encParams.width) ||
+            (m_tmpEncParams.height != m_encParams.height) || (m_tmpEncParams.profile != m_encParams.profile);
         m_encParams = m_tmpEncParams;
-        m_resetFlag = true;
-        INFO("Handle encoder config change: [bitrate, gopsize, profile] = [%u,%u,%s]",
-            m_encParams.bitrate, m_encParams.gopsize, m_encParams.profile.c_str());
+        if (needReset || !m_isInited || m_resetFlag) {
+            m_resetFlag = true;
+        } else {
+            PrepareReconfig();
+        }
+        INFO("Handle encoder config change: [bitrate, gopsize, profile] = [%u,%u,%s], %s",
+            m_encParams.bitrate, m_encParams.gopsize, m_encParams.profile.c_str(),
+            m_resetFlag ? "reset session" : "reconfig in session");
     } else {
         INFO("Using encoder config: [bitrate, gopsize, profile] = [%u,%u,%s]",
             m_encParams.bitrate, m_encParams.gopsize, m_encParams.profile.c_str());
     }
     return VIDEO_ENCODER_SUCCESS;
 }
+
+void VideoEncoderNetint::PrepareReconfig()
+{
+    // 会话帧率在打开时固定，帧率变化通过按比例换算目标码率保持每帧比特预算
+    uint64_t targetRate = static_cast<uint64_t>(m_encParams.bitrate) * m_sessionFramerate / m_encParams.framerate;
+    m_changeParams = {};
+    m_changeParams.enable_option = NI_SET_CHANGE_PARAM_RC_TARGET_RATE | NI_SET_CHANGE_PARAM_INTRA_PARAM;
+    m_changeParams.bitRate = static_cast<int32_t>(std::min<uint64_t>(targetRate, INT32_MAX));
+    m_changeParams.intraQP = m_session->encParams.hevc_enc_params.rc.intra_qp;
+    m_changeParams.intraPeriod = static_cast<int32_t>(m_encParams.gopsize);
+    m_changeParams.repeatHeaders = m_session->encParams.hevc_enc_params.forced_header_enable;
+    m_packetCapacity = std::max(m_packetCapacity, EstimatePacketCapacity());
+    m_reconfigPending = true;
+}
+
+void VideoEncoderNetint::AttachReconfig(ni_frame_t *dataFrame)
+{
+    // 重配置参数紧随帧元数据之后，随帧写入设备
+    uint8_t *extraData = static_cast<uint8_t *>(dataFrame->p_data[V_INDEX]) + dataFrame->data_len[V_INDEX];
+    std::copy_n(reinterpret_cast<const uint8_t *>(&m_changeParams), sizeof(m_changeParams),
+        extraData + NI_APP_ENC_FRAME_META_DATA_SIZE);
+    dataFrame->reconf_len = sizeof(m_changeParams);
+    dataFrame->extra_data_len = NI_APP_ENC_FRAME_META_DATA_SIZE + sizeof(m_changeParams);
+}
+
+bool VideoEncoderNetint::HandleParamAdjusting()
+{
+    if (m_paramAdjustingWatcher.ValueEquals("1")) {
+        if ((!GetRoEncParam()) || (!GetPersistEncParam())) {
+            ERR("init encoder failed: GetEncParam failed");
+            return false;
+        }
+        SetEncodeParams();
+        SetEncParam(PROP_PARAM_ADJUSTING.c_str(), "0");
+    } else if (!m_paramAdjustingWatcher.ValueEquals("0")) {
+        WARN("Invalid property value[%s] for encode param adjusting", m_paramAdjustingWatcher.GetValue());
+        SetEncParam(PROP_PARAM_ADJUSTING.c_str(), "0");
+    }
+    // 参数读取失败时不确认，下一帧重新读取
+    m_paramAdjustingWatcher.Commit();
+    return true;
+}
+
+void VideoEncoderNetint::HandleKeyframeRequest()
+{
+    if (m_keyframeWatcher.ValueEquals("1")) {
+        INFO("Encoder set key frame");
+        ForceKeyFrame();
+        SetEncParam(PROP_KEYFRAME.c_str(), "0");
+    } else if (!m_keyframeWatcher.ValueEquals("0")) {
+        WARN("Invalid property value[%s] for property[keyFrame], set to [0]", m_keyframeWatcher.GetValue());
+        SetEncParam(PROP_KEYFRAME.c_str(), "0");
+    }
+    m_keyframeWatcher.Commit();
+}
@@ -7,7 +7,13 @@
 #include <string>
 #include <unordered_map>
 #include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
 #include "VideoCodecApi.h"
+#include "Property.h"
+#include "SessionPool.h"
+#include "DeviceScheduler.h"
 #include "ni_device_api.h"
 #include "ni_defs.h"
 #include "ni_rsrc_api.h"
@@ -31,8 +37,22 @@ namespace {
     const std::string ENCODE_PROFILE_BASELINE = "baseline";
     const std::string ENCODE_PROFILE_MAIN = "main";
     const std::string ENCODE_PROFILE_HIGH = "high";
+    constexpr uint32_t PIPELINE_DEPTH_MIN = 1;
+    constexpr uint32_t PIPELINE_DEPTH_MAX = 8;
 }
 
+// NETINT编码会话：资源上下文、设备句柄与已打开的固件会话，可在会话池中复用
+struct NetintEncoderSession {
+    ni_session_context_t sessionCtx = {};
+    ni_encoder_params_t encParams = {};  // 会话配置，sessionCtx.p_session_config指向该成员
+    ni_device_context_t *devCtx = nullptr;
+    ni_codec_t codec = EN_H264;
+    unsigned long load = 0;
+    int guid = -1;               // 所在设备
+    uint64_t pixelRate = 0;      // 宽 × 高 × 帧率
+    uint32_t loadPercent = 0;    // 打开会话时计入设备负载的值，关闭时扣除
+};
+
 class VideoEncoderNetint : public VideoEncoder {
 public:
     /**
@@ -71,6 +91,45 @@ public:
     EncoderRetCode EncodeOneFrame(const uint8_t *inputData, uint32_t inputSize,
         uint8_t **outputData, uint32_t *outputSize) override;
 
+    /**
+     * @功能描述: 提交一帧待编码数据，不等待编码输出（流水线模式）
+     * @参数 [in] inputData: 编码输入数据地址
+     * @参数 [in] inputSize: 编码输入数据大小
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 在途帧已达上限
+     *          VIDEO_ENCODER_ENCODE_FAIL 提交失败
+     */
+    EncoderRetCode SubmitFrame(const uint8_t *inputData, uint32_t inputSize) override;
+
+    /**
+     * @功能描述: 按提交顺序取出一帧编码输出（流水线模式）
+     * @参数 [out] outputData: 编码输出数据地址
+     * @参数 [out] outputSize: 编码输出数据大小
+     * @参数 [in] wait: 是否等待在途帧编码完成
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_NO_OUTPUT 暂无编码输出
+     *          VIDEO_ENCODER_ENCODE_FAIL 获取编码输出失败
+     */
+    EncoderRetCode PollPacket(uint8_t **outputData, uint32_t *outputSize, bool wait) override;
+
+    /**
+     * @功能描述: 申请一块编码器持有的输入缓冲区
+     * @参数 [out] buffer: 输入缓冲区描述
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 暂无空闲缓冲区
+     *          VIDEO_ENCODER_ENCODE_FAIL 申请失败
+     */
+    EncoderRetCode DequeueInputBuffer(EncoderInputBuffer *buffer) override;
+
+    /**
+     * @功能描述: 提交已填充的输入缓冲区进行编码
+     * @参数 [in] buffer: 输入缓冲区描述
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 在途帧已达上限
+     *          VIDEO_ENCODER_ENCODE_FAIL 提交失败
+     */
+    EncoderRetCode QueueInputBuffer(const EncoderInputBuffer &buffer) override;
+
     /**
      * @功能描述: 停止编码器
      * @返回值: VIDEO_ENCODER_SUCCESS 成功
@@ -91,8 +150,8 @@ public:
     EncoderRetCode ResetEncoder() override;
 
     /**
-     * @功能描述: 强制I帧
-     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     * @功能描述: 强制I帧，下一个写入设备的帧编码为IDR并重发参数集，输出结果写入keyframe_result属性
+     * @返回值: VIDEO_ENCODER_SUCCESS 请求已受理
      *          VIDEO_ENCODER_FORCE_KEY_FRAME_FAIL 强制I帧失败
      */
     EncoderRetCode ForceKeyFrame();
@@ -126,6 +185,14 @@ private:
         }
     };
 
+    // 打开会话所需的配置，在会话池预热线程中使用，不引用编码器成员
+    struct SessionConfig {
+        ni_codec_t codec;
+        EncodeParams params;
+        uint32_t pipelineDepth;
+        int guid = -1;   // 指定设备，-1时按调度策略选卡
+    };
+
     /**
      * @功能描述: 获取ro编码参数
      * @返回值: true 成功
@@ -156,6 +223,67 @@ private:
      */
     bool VerifyEncodeParams(std::string &bitrate, std::string &gopsize, std::string &profile);
 
+    /**
+     * @功能描述: 处理编码参数调整属性变化，必要时重置编码器
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_INIT_FAIL 获取编码参数失败
+     *          VIDEO_ENCODER_ENCODE_FAIL 重置编码器失败
+     */
+    EncoderRetCode PrepareSession();
+
+    /**
+     * @功能描述: 处理强制I帧请求后将输入帧写入编码器
+     * @参数 [in] frame: 输入帧
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 设备输入队列已满
+     *          VIDEO_ENCODER_ENCODE_FAIL 写入失败
+     */
+    EncoderRetCode WriteFrame(ni_session_data_io_t *frame);
+
+    /**
+     * @功能描述: 获取流水线深度（最大在途帧数）配置
+     * @返回值: 流水线深度，配置非法时为PIPELINE_DEPTH_MIN
+     */
+    uint32_t GetPipelineDepth();
+
+    /**
+     * @功能描述: 从设备读取一帧编码输出
+     * @参数 [out] outputData: 编码输出数据地址
+     * @参数 [out] outputSize: 编码输出数据大小
+     * @参数 [in] wait: 是否等待编码完成
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_NO_OUTPUT 暂无编码输出
+     *          VIDEO_ENCODER_ENCODE_FAIL 读取失败
+     */
+    EncoderRetCode ReadPacket(uint8_t **outputData, uint32_t *outputSize, bool wait);
+
+    /**
+     * @功能描述: 根据码率与VBV缓冲估算单个编码输出包的容量
+     * @返回值: 输出包容量(Byte)，包含码流元数据
+     */
+    uint32_t EstimatePacketCapacity() const;
+
+    /**
+     * @功能描述: 编码输出接近包容量时扩大后续申请的包容量，上限为原始帧大小
+     */
+    void GrowPacketCapacity();
+
+    /**
+     * @功能描述: 从输出包池中轮转取出一个输出包，容量不足时重新申请
+     * @返回值: 输出包，申请失败时返回nullptr
+     */
+    ni_session_data_io_t *AcquirePacket();
+
+    /**
+     * @功能描述: 释放输出包池
+     */
+    void ReleasePackets();
+
+    /**
+     * @功能描述: 读空设备中的在途帧，编码输出暂存至m_drainedPackets供PollPacket取出
+     */
+    void DrainEncoder();
+
     /**
      * @功能描述: 加载NETINT动态库
      * @返回值: true 成功
@@ -164,26 +292,126 @@ private:
     bool LoadNetintSharedLib();
 
     /**
-     * @功能描述: 初始化编码器资源
+     * @功能描述: 分配设备资源、打开设备句柄并打开编码会话
+     * @参数 [in] config: 会话配置
+     * @返回值: 已打开的会话，失败时返回nullptr
+     */
+    static std::unique_ptr<NetintEncoderSession> OpenSession(const SessionConfig &config);
+
+    /**
+     * @功能描述: 关闭编码会话、设备句柄并释放设备资源，可用于部分打开的会话
+     * @参数 [in] session: 会话
+     */
+    static void CloseSession(NetintEncoderSession &session);
+
+    /**
+     * @功能描述: 读取本机各编码设备的负载
+     * @返回值: 各卡负载，按guid排列
+     */
+    static std::vector<DeviceLoad> CollectDeviceLoads();
+
+    /**
+     * @功能描述: 为会话分配设备资源：按调度策略选卡，无法选卡或分配失败时回退为自动分配
+     * @参数 [in] session: 会话
+     * @参数 [in] config: 会话配置
      * @返回值: true 成功
      *          false 失败
      */
-    bool InitCodec();
+    static bool AllocateDevice(NetintEncoderSession &session, const SessionConfig &config);
+
+    /**
+     * @功能描述: 更新会话所在设备的负载，使其他进程在设备上报负载前即可感知
+     * @参数 [in] session: 会话
+     * @参数 [in] add: true 计入会话负载，false 扣除会话负载
+     */
+    static void PublishDeviceLoad(NetintEncoderSession &session, bool add);
+
+    /**
+     * @功能描述: 即将编码IDR帧时检查设备负载是否失衡，失衡超过阈值时标记重置以将会话迁移至其他设备，
+     *            新会话的首帧即为IDR
+     */
+    void CheckMigration();
 
     /**
      * @功能描述: 初始化编码器上下文参数
+     * @参数 [in] session: 会话
+     * @参数 [in] config: 会话配置
      * @返回值: true 成功
      *          false 失败
      */
-    bool InitCtxParams();
+    static bool InitCtxParams(NetintEncoderSession &session, const SessionConfig &config);
+
+    /**
+     * @功能描述: 生成会话池键，键相同的会话可直接复用
+     * @参数 [in] config: 会话配置
+     */
+    static std::string SessionKey(const SessionConfig &config);
+
+    /**
+     * @功能描述: 获取进程级编码会话池
+     */
+    static SessionPool<NetintEncoderSession> &GetSessionPool();
+
+    /**
+     * @功能描述: 获取会话池空闲会话数量上限配置
+     * @返回值: 空闲会话数量上限，未配置或非法时为0（不缓存会话）
+     */
+    static uint32_t GetSessionPoolSize();
 
     /**
-     * @功能描述: 拷贝一帧数据到编码器
+     * @功能描述: 按硬件平面跨度预申请输入帧池
+     * @返回值: true 成功
+     *          false 失败
+     */
+    bool InitFramePool();
+
+    /**
+     * @功能描述: 释放输入帧池
+     */
+    void ReleaseFramePool();
+
+    /**
+     * @功能描述: 从输入帧池轮转取出一个未被调用者持有的帧
+     * @参数 [out] index: 帧在池中的编号，可为nullptr
+     * @返回值: 空闲帧，无空闲帧时返回nullptr
+     */
+    ni_session_data_io_t *NextFreeFrame(uint32_t *index);
+
+    /**
+     * @功能描述: 重置输入帧的逐帧属性
+     * @参数 [in] dataFrame: 输入帧
+     */
+    void ResetFrameFields(ni_frame_t *dataFrame) const;
+
+    /**
+     * @功能描述: 从输入帧池取出一帧并拷贝待编码数据
      * @参数 [in] src: 待编码数据地址
+     * @返回值: 填充好的输入帧，失败时返回nullptr
+     */
+    ni_session_data_io_t *InitFrameData(const uint8_t *src);
+
+    /**
+     * @功能描述: 根据新的码率、关键帧间隔与帧率生成会话内重配置参数，随下一帧下发
+     */
+    void PrepareReconfig();
+
+    /**
+     * @功能描述: 将待下发的重配置参数附加到输入帧的扩展数据中
+     * @参数 [in] dataFrame: 输入帧，需为池内缓冲
+     */
+    void AttachReconfig(ni_frame_t *dataFrame);
+
+    /**
+     * @功能描述: 处理编码参数调整属性变化
      * @返回值: true 成功
      *          false 失败
      */
-    bool InitFrameData(const uint8_t *src);
+    bool HandleParamAdjusting();
+
+    /**
+     * @功能描述: 处理强制I帧属性变化
+     */
+    void HandleKeyframeRequest();
 
     /**
      * @功能描述: 卸载NETINT动态库
@@ -203,18 +431,41 @@ private:
         static_cast<uint32_t>(GOPSIZE_MIN), ENCODE_PROFILE_BASELINE, static_cast<uint32_t>(DEFAULT_WIDTH),
         static_cast<uint32_t>(DEFAULT_HEIGHT)};
     std::atomic<bool> m_resetFlag = { false };
-    ni_encoder_params_t m_niEncParams = {};
-    ni_session_context_t m_sessionCtx = {};
-    ni_device_context_t *m_devCtx = nullptr;
-    ni_session_data_io_t m_frame = {};
-    ni_session_data_io_t m_packet = {};
+    // 会话内重配置参数，随下一帧写入设备后生效
+    ni_encoder_change_params_t m_changeParams = {};
+    bool m_reconfigPending = false;
+    uint32_t m_sessionFramerate = 0;
+    PropertyWatcher m_paramAdjustingWatcher;
+    PropertyWatcher m_keyframeWatcher;
+    std::unique_ptr<NetintEncoderSession> m_session = nullptr;
+    std::string m_sessionKey = "";
+    // 多卡迁移：负载差阈值(%)，为0时不迁移；迁移目标设备，-1表示无待迁移
+    uint32_t m_migrateThreshold = 0;
+    int m_migrateGuid = -1;
+    // 输入帧池，按硬件平面跨度预申请，逐帧轮转复用
+    std::vector<ni_session_data_io_t> m_frames {};
+    uint32_t m_frameIndex = 0;
+    std::vector<bool> m_frameDequeued {};
+    uint32_t m_dequeuedCount = 0;
+    int m_hwPlaneStride[NI_MAX_NUM_DATA_POINTERS] = {0};
+    int m_hwPlaneHeight[NI_MAX_NUM_DATA_POINTERS] = {0};
+    // 输出包池，按流水线深度轮转复用，PollPacket返回的数据在之后m_pipelineDepth次读取内有效
+    std::vector<ni_session_data_io_t> m_packets {};
+    uint32_t m_packetIndex = 0;
+    uint32_t m_packetCapacity = 0;
     int m_width = DEFAULT_WIDTH;
     int m_height = DEFAULT_HEIGHT;
-    int m_widthAlign = DEFAULT_WIDTH;
-    int m_heightAlign = DEFAULT_HEIGHT;
-    unsigned long m_load = 0;
     bool m_FunPtrError = false;
     bool m_isInited = false;
+    uint32_t m_pipelineDepth = PIPELINE_DEPTH_MIN;
+    uint32_t m_inFlight = 0;
+    // 强制I帧：待下发标记，以及携带IDR标记的帧序号（按写入顺序从1计数，0表示无）
+    bool m_keyFramePending = false;
+    uint64_t m_framesSent = 0;
+    uint64_t m_packetsRead = 0;
+    uint64_t m_forcedKeyFrame = 0;
+    std::deque<std::vector<uint8_t>> m_drainedPackets {};
+    std::vector<uint8_t> m_drainedPacket {};
 };
 
 #endif  // VIDEO_ENCODER_NETINT_H
@@ -6,9 +6,13 @@
 #include "VideoEncoderOpenH264.h"
 #include <string>
 #include <dlfcn.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <atomic>
+#include <utility>
 #include "MediaLog.h"
 #include "Property.h"
 
@@ -44,11 +48,24 @@ namespace {
     WelsCreateSVCEncoderFuncPtr g_welsCreateSVCEncoder = nullptr;
     WelsDestroySVCEncoderFuncPtr g_welsDestroySVCEncoder = nullptr;
     const std::string SHARED_LIB_NAME = "libopenh264.so";
+    const std::string PROP_PARAM_ADJUSTING = "persist.vmi.video.encode.param_adjusting";
+    const std::string PROP_KEYFRAME = "persist.vmi.video.encode.keyframe";
+    // 单会话编码线程数。线程预算只统计本进程内的会话，不感知同一主机上其他进程（如其他云手机实例）的编码线程，
+    // 多实例部署时应通过cpuset为各实例划分核，或显式配置较小的线程数
+    const std::string PROP_THREAD_NUM = "persist.vmi.video.encode.thread_num";
+    const std::string PROP_SLICE_NUM = "persist.vmi.video.encode.slice_num";
+    constexpr uint32_t THREAD_NUM_MAX = 4;  // OpenH264内部线程数上限MAX_THREADS_NUM
+    constexpr uint32_t MB_SIZE = 16;
+    constexpr uint32_t PIXELS_720P = 1280 * 720;
+    constexpr uint32_t PIXELS_1080P = 1920 * 1080;
+    // 进程内所有OpenH264会话占用的编码线程总数，用于限制多会话时的线程超订，预算为进程可用的核数
+    std::atomic<uint32_t> g_threadsInUse = { 0 };
     std::atomic<bool> g_openH264Loaded = { false };
     void *g_libHandle = nullptr;
 }
 
 VideoEncoderOpenH264::VideoEncoderOpenH264()
+    : m_paramAdjustingWatcher(PROP_PARAM_ADJUSTING.c_str()), m_keyframeWatcher(PROP_KEYFRAME.c_str())
 {
     INFO("VideoEncoderOpenH264 constructor");
 }
@@ -244,7 +261,7 @@ bool VideoEncoderOpenH264::InitParams()
     m_paramExt.sSpatialLayers[0].iVideoHeight = m_encParams.height;
     m_paramExt.sSpatialLayers[0].fFrameRate = m_encParams.framerate;
     m_paramExt.sSpatialLayers[0].iSpatialBitrate = m_paramExt.iTargetBitrate;
-    m_paramExt.sSpatialLayers[0].sSliceArgument.uiSliceMode = SM_SINGLE_SLICE;
+    InitThreadParams();
     if (m_encParams.profile == ENCODE_PROFILE_HIGH) {
         m_paramExt.sSpatialLayers[0].uiProfileIdc = EProfileIdc::PRO_HIGH;
     } else if (m_encParams.profile == ENCODE_PROFILE_MAIN) {
@@ -295,6 +312,70 @@ void VideoEncoderOpenH264::InitParamExt()
     m_paramExt.iLoopFilterDisableIdc = 0;
 }
 
+uint32_t VideoEncoderOpenH264::AvailableCores()
+{
+    // 容器通过cpuset限定实例可用的核，优先按本进程的CPU亲和性计数，取不到时退回在线核数
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0 && CPU_COUNT(&cpuSet) > 0) {
+        return static_cast<uint32_t>(CPU_COUNT(&cpuSet));
+    }
+    return static_cast<uint32_t>(std::max(sysconf(_SC_NPROCESSORS_ONLN), 1L));
+}
+
+void VideoEncoderOpenH264::InitThreadParams()
+{
+    ReleaseThreads();
+    uint32_t cores = AvailableCores();
+    uint32_t threadNum = GetEncodeNum(PROP_THREAD_NUM, DefaultThreadNum(), std::min(THREAD_NUM_MAX, cores));
+
+    // 按核数为进程内会话分配线程预算，预算耗尽后新会话退化为单线程
+    uint32_t inUse = g_threadsInUse.load();
+    uint32_t granted = 0;
+    do {
+        granted = (inUse < cores) ? std::min(threadNum, cores - inUse) : 1;
+    } while (!g_threadsInUse.compare_exchange_weak(inUse, inUse + granted));
+    m_threadNum = granted;
+
+    uint32_t mbRows = (m_encParams.height + MB_SIZE - 1) / MB_SIZE;
+    uint32_t sliceNum = GetEncodeNum(PROP_SLICE_NUM, m_threadNum, std::min<uint32_t>(MAX_SLICES_NUM_TMP, mbRows));
+    m_paramExt.iMultipleThreadIdc = static_cast<int>(m_threadNum);
+    if (sliceNum > 1) {
+        m_paramExt.sSpatialLayers[0].sSliceArgument.uiSliceMode = SM_FIXEDSLCNUM_SLICE;
+        m_paramExt.sSpatialLayers[0].sSliceArgument.uiSliceNum = sliceNum;
+    } else {
+        m_paramExt.sSpatialLayers[0].sSliceArgument.uiSliceMode = SM_SINGLE_SLICE;
+    }
+    INFO("encoder threads %u (requested %u, cores %u, in use %u), slices %u",
+        m_threadNum, threadNum, cores, inUse, sliceNum);
+}
+
+uint32_t VideoEncoderOpenH264::DefaultThreadNum() const
+{
+    uint32_t pixels = m_encParams.width * m_encParams.height;
+    if (pixels <= PIXELS_720P) {
+        return 1;
+    }
+    return (pixels <= PIXELS_1080P) ? 2 : THREAD_NUM_MAX;
+}
+
+uint32_t VideoEncoderOpenH264::GetEncodeNum(const std::string &prop, uint32_t defaultNum, uint32_t maxNum) const
+{
+    int32_t num = GetIntEncParam(prop.c_str());
+    if (num <= 0) {
+        num = static_cast<int32_t>(defaultNum);
+    }
+    return std::max(std::min(static_cast<uint32_t>(num), maxNum), 1U);
+}
+
+void VideoEncoderOpenH264::ReleaseThreads()
+{
+    if (m_threadNum != 0) {
+        g_threadsInUse -= m_threadNum;
+        m_threadNum = 0;
+    }
+}
+
 EncoderRetCode VideoEncoderOpenH264::StartEncoder()
 {
     INFO("start encoder success");
@@ -305,21 +386,12 @@ EncoderRetCode VideoEncoderOpenH264::EncodeOneFrame(const uint8_t *inputData, ui
     uint8_t **outputData, uint32_t *outputSize)
 {
     if (inputSize < static_cast<size_t>(m_frameSize)) {
-        ERR("input size error: input size(%u) < frame size(%u)", inputSize, m_frameSize);
+        ERR_LIMITED("input size error: input size(%u) < frame size(%u)", inputSize, m_frameSize);
         return VIDEO_ENCODER_ENCODE_FAIL;
     }
 
-    std::string isParamChange = GetStrEncParam( "persist.vmi.video.encode.param_adjusting");
-    if (isParamChange == "1") {
-        if (!GetPersistEncParam()) {
-            ERR("init encoder failed: GetEncParam failed");
-            return VIDEO_ENCODER_INIT_FAIL;
-        }
-        SetEncodeParams();
-        SetEncParam("persist.vmi.video.encode.param_adjusting", "0");
-    } else if (isParamChange != "0") {
-        WARN("Invalid property value[%s] for encode param adjusting", isParamChange.c_str());
-        SetEncParam("persist.vmi.video.encode.param_adjusting", "0");
+    if (m_paramAdjustingWatcher.Update() && !HandleParamAdjusting()) {
+        return VIDEO_ENCODER_INIT_FAIL;
     }
 
     if (m_resetFlag) {
@@ -330,20 +402,14 @@ EncoderRetCode VideoEncoderOpenH264::EncodeOneFrame(const uint8_t *inputData, ui
         m_resetFlag = false;
     }
 
-    std::string isKeyframeChange = GetStrEncParam( "persist.vmi.video.encode.keyframe");
-    if (isKeyframeChange == "1") {
-        INFO("Encoder set key frame");
-        ForceKeyFrame();
-        SetEncParam("persist.vmi.video.encode.keyframe", "0");
-    } else if (isKeyframeChange != "0") {
-        WARN("Invalid property value[%s] for property[keyFrame], set to [0]", isKeyframeChange.c_str());
-        SetEncParam("persist.vmi.video.encode.keyframe", "0");
+    if (m_keyframeWatcher.Update()) {
+        HandleKeyframeRequest();
     }
 
     InitSrcPic(inputData);
     int rc = m_encoder->EncodeFrame(&m_srcPic, &m_frameBSInfo);
     if (rc != 0) {
-        ERR("encoder encode frame failed, rc = %d", rc);
+        ERR_LIMITED("encoder encode frame failed, rc = %d", rc);
         return VIDEO_ENCODER_ENCODE_FAIL;
     }
     *outputData = m_frameBSInfo.sLayerInfo->pBsBuf;
@@ -351,6 +417,79 @@ EncoderRetCode VideoEncoderOpenH264::EncodeOneFrame(const uint8_t *inputData, ui
     return VIDEO_ENCODER_SUCCESS;
 }
 
+EncoderRetCode VideoEncoderOpenH264::SubmitFrame(const uint8_t *inputData, uint32_t inputSize)
+{
+    // 软件编码在调用线程内同步完成，仅支持一帧在途
+    if (m_hasPendingOutput) {
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    uint8_t *outputData = nullptr;
+    uint32_t outputSize = 0;
+    EncoderRetCode ret = EncodeOneFrame(inputData, inputSize, &outputData, &outputSize);
+    if (ret != VIDEO_ENCODER_SUCCESS) {
+        return ret;
+    }
+    m_hasPendingOutput = true;
+    return VIDEO_ENCODER_SUCCESS;
+}
+
+EncoderRetCode VideoEncoderOpenH264::PollPacket(uint8_t **outputData, uint32_t *outputSize, bool wait)
+{
+    (void) wait;
+    if (!m_hasPendingOutput) {
+        return VIDEO_ENCODER_NO_OUTPUT;
+    }
+    m_hasPendingOutput = false;
+    *outputData = m_frameBSInfo.sLayerInfo->pBsBuf;
+    *outputSize = static_cast<uint32_t>(m_frameBSInfo.iFrameSizeInBytes);
+    return VIDEO_ENCODER_SUCCESS;
+}
+
+EncoderRetCode VideoEncoderOpenH264::DequeueInputBuffer(EncoderInputBuffer *buffer)
+{
+    if (buffer == nullptr) {
+        ERR("input buffer descriptor is null");
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    if (m_hasPendingOutput || m_inputDequeued) {
+        return VIDEO_ENCODER_QUEUE_FULL;
+    }
+    if (m_inputBuffer.size() < m_frameSize) {
+        m_inputBuffer.resize(m_frameSize);
+    }
+    // 与InitSrcPic的I420平面布局保持一致，编码时直接引用该缓冲区
+    uint32_t width = m_encParams.width;
+    uint32_t height = m_encParams.height;
+    *buffer = {};
+    buffer->data = m_inputBuffer.data();
+    buffer->capacity = static_cast<uint32_t>(m_inputBuffer.size());
+    buffer->planeNum = PRIMARY_COLOURS;
+    buffer->stride[0] = width;
+    buffer->stride[1] = width / COMPRESS_RATIO;
+    buffer->stride[COMPRESS_RATIO] = width / COMPRESS_RATIO;
+    buffer->height[0] = height;
+    buffer->height[1] = height / COMPRESS_RATIO;
+    buffer->height[COMPRESS_RATIO] = height / COMPRESS_RATIO;
+    buffer->offset[0] = 0;
+    buffer->offset[1] = m_yLength;
+    buffer->offset[COMPRESS_RATIO] = m_yLength + (m_yLength >> COMPRESS_RATIO);
+    m_inputDequeued = true;
+    return VIDEO_ENCODER_SUCCESS;
+}
+
+EncoderRetCode VideoEncoderOpenH264::QueueInputBuffer(const EncoderInputBuffer &buffer)
+{
+    if (!m_inputDequeued || buffer.data != m_inputBuffer.data()) {
+        ERR("queue input buffer failed: buffer %u is not dequeued", buffer.index);
+        return VIDEO_ENCODER_ENCODE_FAIL;
+    }
+    EncoderRetCode ret = SubmitFrame(buffer.data, buffer.capacity);
+    if (ret != VIDEO_ENCODER_QUEUE_FULL) {
+        m_inputDequeued = false;
+    }
+    return ret;
+}
+
 void VideoEncoderOpenH264::InitSrcPic(const uint8_t *inputData)
 {
     m_srcPic.iPicWidth = m_paramExt.iPicWidth;
@@ -378,11 +517,13 @@ void VideoEncoderOpenH264::DestroyEncoder()
 
 void VideoEncoderOpenH264::Release()
 {
+    m_hasPendingOutput = false;
     if (m_encoder != nullptr) {
         (void) m_encoder->Uninitialize();
         (*g_welsDestroySVCEncoder)(m_encoder);
         m_encoder = nullptr;
     }
+    ReleaseThreads();
 }
 
 EncoderRetCode VideoEncoderOpenH264::ResetEncoder()
@@ -417,13 +558,89 @@ EncoderRetCode VideoEncoderOpenH264::ForceKeyFrame()
 EncoderRetCode VideoEncoderOpenH264::SetEncodeParams()
 {
     if (EncodeParamsChange()) {
+        // 分辨率与档位变化需重建编码器，码率、关键帧间隔与帧率通过SetOption在线生效
+        bool needReset = (m_tmpEncParams.width != m_encParams.width) ||
+            (m_tmpEncParams.height != m_encParams.height) || (m_tmpEncParams.profile != m_encParams.profile);
+        if (needReset || m_encoder == nullptr || m_resetFlag || !ApplyRuntimeParams(m_tmpEncParams)) {
+            m_resetFlag = true;
+        }
         m_encParams = m_tmpEncParams;
-        m_resetFlag = true;
-        INFO("Handle encoder config change: [bitrate, gopsize, profile] = [%u,%u,%s]",
-            m_encParams.bitrate, m_encParams.gopsize, m_encParams.profile.c_str());
+        INFO("Handle encoder config change: [bitrate, gopsize, profile] = [%u,%u,%s], %s",
+            m_encParams.bitrate, m_encParams.gopsize, m_encParams.profile.c_str(),
+            m_resetFlag ? "reset encoder" : "set option");
     } else {
         INFO("Using encoder config: [bitrate, gopsize, profile] = [%u,%u,%s]",
             m_encParams.bitrate, m_encParams.gopsize, m_encParams.profile.c_str());
     }
     return VIDEO_ENCODER_SUCCESS;
 }
+
+bool VideoEncoderOpenH264::ApplyRuntimeParams(const EncodeParams &params)
+{
+    int rc = 0;
+    if (params.framerate != m_encParams.framerate) {
+        float frameRate = static_cast<float>(params.framerate);
+        rc = m_encoder->SetOption(ENCODER_OPTION_FRAME_RATE, &frameRate);
+        if (rc != 0) {
+            ERR("encoder set option frame rate %u failed, rc = %d", params.framerate, rc);
+            return false;
+        }
+    }
+    if (params.bitrate != m_encParams.bitrate) {
+        // 目标码率不能超过最大码率：升码率时先调最大码率，降码率时先调目标码率
+        SBitrateInfo bitrateInfo = { SPATIAL_LAYER_ALL, static_cast<int>(params.bitrate) };
+        ENCODER_OPTION first = ENCODER_OPTION_MAX_BITRATE;
+        ENCODER_OPTION second = ENCODER_OPTION_BITRATE;
+        if (params.bitrate < m_encParams.bitrate) {
+            std::swap(first, second);
+        }
+        rc = m_encoder->SetOption(first, &bitrateInfo);
+        if (rc == 0) {
+            rc = m_encoder->SetOption(second, &bitrateInfo);
+        }
+        if (rc != 0) {
+            ERR("encoder set option bitrate %u failed, rc = %d", params.bitrate, rc);
+            return false;
+        }
+    }
+    if (params.gopsize != m_encParams.gopsize) {
+        int intraPeriod = static_cast<int>(params.gopsize);
+        rc = m_encoder->SetOption(ENCODER_OPTION_IDR_INTERVAL, &intraPeriod);
+        if (rc != 0) {
+            ERR("encoder set option idr interval %u failed, rc = %d", params.gopsize, rc);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VideoEncoderOpenH264::HandleParamAdjusting()
+{
+    if (m_paramAdjustingWatcher.ValueEquals("1")) {
+        if (!GetPersistEncParam()) {
+            ERR("init encoder failed: GetEncParam failed");
+            return false;
+        }
+        SetEncodeParams();
+        SetEncParam(PROP_PARAM_ADJUSTING.c_str(), "0");
+    } else if (!m_paramAdjustingWatcher.ValueEquals("0")) {
+        WARN("Invalid property value[%s] for encode param adjusting", m_paramAdjustingWatcher.GetValue());
+        SetEncParam(PROP_PARAM_ADJUSTING.c_str(), "0");
+    }
+    // 参数读取失败时不确认，下一帧重新读取
+    m_paramAdjustingWatcher.Commit();
+    return true;
+}
+
+void VideoEncoderOpenH264::HandleKeyframeRequest()
+{
+    if (m_keyframeWatcher.ValueEquals("1")) {
+        INFO("Encoder set key frame");
+        ForceKeyFrame();
+        SetEncParam(PROP_KEYFRAME.c_str(), "0");
+    } else if (!m_keyframeWatcher.ValueEquals("0")) {
+        WARN("Invalid property value[%s] for property[keyFrame], set to [0]", m_keyframeWatcher.GetValue());
+        SetEncParam(PROP_KEYFRAME.c_str(), "0");
+    }
+    m_keyframeWatcher.Commit();
+}
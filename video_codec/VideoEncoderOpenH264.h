@@ -6,7 +6,9 @@
 
 #include <string>
 #include <atomic>
+#include <vector>
 #include "VideoCodecApi.h"
+#include "Property.h"
 #include "codec_api.h"
 
 namespace OpenH264 {
@@ -62,6 +64,45 @@ public:
     EncoderRetCode EncodeOneFrame(const uint8_t *inputData, uint32_t inputSize,
         uint8_t **outputData, uint32_t *outputSize) override;
 
+    /**
+     * @功能描述: 提交一帧待编码数据，不等待编码输出（流水线模式）
+     * @参数 [in] inputData: 编码输入数据地址
+     * @参数 [in] inputSize: 编码输入数据大小
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 在途帧已达上限
+     *          VIDEO_ENCODER_ENCODE_FAIL 提交失败
+     */
+    EncoderRetCode SubmitFrame(const uint8_t *inputData, uint32_t inputSize) override;
+
+    /**
+     * @功能描述: 按提交顺序取出一帧编码输出（流水线模式）
+     * @参数 [out] outputData: 编码输出数据地址
+     * @参数 [out] outputSize: 编码输出数据大小
+     * @参数 [in] wait: 是否等待在途帧编码完成
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_NO_OUTPUT 暂无编码输出
+     *          VIDEO_ENCODER_ENCODE_FAIL 获取编码输出失败
+     */
+    EncoderRetCode PollPacket(uint8_t **outputData, uint32_t *outputSize, bool wait) override;
+
+    /**
+     * @功能描述: 申请一块编码器持有的输入缓冲区
+     * @参数 [out] buffer: 输入缓冲区描述
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 暂无空闲缓冲区
+     *          VIDEO_ENCODER_ENCODE_FAIL 申请失败
+     */
+    EncoderRetCode DequeueInputBuffer(EncoderInputBuffer *buffer) override;
+
+    /**
+     * @功能描述: 提交已填充的输入缓冲区进行编码
+     * @参数 [in] buffer: 输入缓冲区描述
+     * @返回值: VIDEO_ENCODER_SUCCESS 成功
+     *          VIDEO_ENCODER_QUEUE_FULL 在途帧已达上限
+     *          VIDEO_ENCODER_ENCODE_FAIL 提交失败
+     */
+    EncoderRetCode QueueInputBuffer(const EncoderInputBuffer &buffer) override;
+
     /**
      * @功能描述: 停止编码器
      * @返回值: VIDEO_ENCODER_SUCCESS 成功
@@ -160,12 +201,63 @@ private:
      */
     void InitParamExt();
 
+    /**
+     * @功能描述: 初始化多线程与分片参数，线程数受进程内线程预算限制
+     */
+    void InitThreadParams();
+
+    /**
+     * @功能描述: 获取本进程可用的核数，作为进程内线程预算
+     * @返回值: 可用核数
+     */
+    static uint32_t AvailableCores();
+
+    /**
+     * @功能描述: 根据分辨率选择默认编码线程数
+     * @返回值: 默认编码线程数
+     */
+    uint32_t DefaultThreadNum() const;
+
+    /**
+     * @功能描述: 读取线程数/分片数配置，未配置或非法时使用默认值
+     * @参数 [in] prop: 属性名
+     * @参数 [in] defaultNum: 默认值
+     * @参数 [in] maxNum: 上限
+     * @返回值: 取值范围为[1, maxNum]的配置值
+     */
+    uint32_t GetEncodeNum(const std::string &prop, uint32_t defaultNum, uint32_t maxNum) const;
+
+    /**
+     * @功能描述: 归还本会话占用的线程预算
+     */
+    void ReleaseThreads();
+
     /**
      * @功能描述: 初始化源数据
      * @参数 [in] inputData: 编码输入数据地址
      */
     void InitSrcPic(const uint8_t *inputData);
 
+    /**
+     * @功能描述: 通过SetOption在线调整码率、关键帧间隔与帧率，不重建编码器
+     * @参数 [in] params: 新编码参数
+     * @返回值: true 成功
+     *          false 失败，需重置编码器
+     */
+    bool ApplyRuntimeParams(const EncodeParams &params);
+
+    /**
+     * @功能描述: 处理编码参数调整属性变化
+     * @返回值: true 成功
+     *          false 失败
+     */
+    bool HandleParamAdjusting();
+
+    /**
+     * @功能描述: 处理强制I帧属性变化
+     */
+    void HandleKeyframeRequest();
+
     /**
      * @功能描述: 资源释放
      */
@@ -191,12 +283,18 @@ private:
         static_cast<uint32_t>(OpenH264::DEFAULT_WIDTH),
         static_cast<uint32_t>(OpenH264::DEFAULT_HEIGHT)};
     std::atomic<bool> m_resetFlag = { false };
+    PropertyWatcher m_paramAdjustingWatcher;
+    PropertyWatcher m_keyframeWatcher;
     ISVCEncoder *m_encoder = nullptr;
     SEncParamExt m_paramExt = {};
     SSourcePicture m_srcPic = {};
     SFrameBSInfo m_frameBSInfo = {};
     uint32_t m_yLength = 0;
     uint32_t m_frameSize = 0;
+    bool m_hasPendingOutput = false;
+    uint32_t m_threadNum = 0;
+    std::vector<uint8_t> m_inputBuffer {};
+    bool m_inputDequeued = false;
 };
 
 #endif  // VIDEO_ENCODER_OPEN_H264_H
@@ -14,6 +14,10 @@ LOCAL_C_INCLUDES := \
     $(LOCAL_PATH) \
     $(LOCAL_PATH)/include \
     system/core/liblog/include \
+    $(LOCAL_PATH)/../common/bitstream \
+    $(LOCAL_PATH)/../common/image \
+    $(LOCAL_PATH)/../common/log \
+    $(LOCAL_PATH)/../common/pool \
     $(LOCAL_PATH)/../vendor/netintV310
 
 LOCAL_SHARED_LIBRARIES := liblog libutils
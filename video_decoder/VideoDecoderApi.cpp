@@ -3,6 +3,7 @@
  */
 
 #define LOG_TAG "VideoDecoderApi"
+#include <memory>
 #include <utils/Log.h>
 #include "VideoDecoder.h"
 #include "VideoDecoderNetint.h"
@@ -5,19 +5,30 @@
 #define LOG_TAG "VideoDecoderNetint"
 #include "VideoDecoderNetint.h"
 #include <string>
+#include <climits>
+#include <cstdlib>
 #include <algorithm>
+#include <new>
 #include <unordered_map>
 #include <chrono>
 #include <dlfcn.h>
 #include <unistd.h>
 #include <utils/Log.h>
+#include <sys/file.h>
 #include <sys/time.h>
+#include <sys/system_properties.h>
+#include "LogRateLimiter.h"
+#include "SpsParser.h"
+#include "StartCodeScanner.h"
 
 namespace MediaCore {
 namespace {
     const std::string NI_DECODER_INIT_DEFAULT_PARAMS  = "ni_logan_decoder_init_default_params";
     const std::string NI_RSRC_ALLOCATE_AUTO           = "ni_logan_rsrc_allocate_auto";
+    const std::string NI_RSRC_ALLOCATE_DIRECT         = "ni_logan_rsrc_allocate_direct";
     const std::string NI_RSRC_RELEASE_RESOURCE        = "ni_logan_rsrc_release_resource";
+    const std::string NI_RSRC_LIST_DEVICES            = "ni_logan_rsrc_list_devices";
+    const std::string NI_RSRC_UPDATE_DEVICE_LOAD      = "ni_logan_rsrc_update_device_load";
     const std::string NI_RSRC_FREE_DEVICE_CONTEXT     = "ni_logan_rsrc_free_device_context";
     const std::string NI_DEVICE_OPEN                  = "ni_logan_device_open";
     const std::string NI_DEVICE_CLOSE                 = "ni_logan_device_close";
@@ -29,9 +40,7 @@ namespace {
     const std::string NI_DEVICE_DEC_SESSION_SAVE_HDRS = "ni_logan_device_dec_session_save_hdrs";
     const std::string NI_DEVICE_SESSION_WRITE         = "ni_logan_device_session_write";
     const std::string NI_DEVICE_SESSION_CLOSE         = "ni_logan_device_session_close";
-    const std::string NI_PACKET_BUFFER_ALLOC          = "ni_logan_packet_buffer_alloc";
     const std::string NI_PACKET_COPY                  = "ni_logan_packet_copy";
-    const std::string NI_PACKET_BUFFER_FREE           = "ni_logan_packet_buffer_free";
     const std::string NI_DECODER_FRAME_BUFFER_ALLOC   = "ni_logan_decoder_frame_buffer_alloc";
     const std::string NI_DECODER_FRAME_BUFFER_FREE    = "ni_logan_decoder_frame_buffer_free";
 
@@ -40,6 +49,12 @@ namespace {
 
     using NiRsrcAllocateAutoFunc = ni_logan_device_context_t* (*)(ni_logan_device_type_t devType, ni_alloc_rule_t rule,
         ni_codec_t codec, int width, int height, int frameRate, unsigned long *load);
+    using NiRsrcAllocateDirectFunc = ni_logan_device_context_t* (*)(ni_logan_device_type_t devType, int guid,
+        ni_codec_t codec, int width, int height, int frameRate, unsigned long *load);
+    using NiRsrcListDevicesFunc = ni_logan_retcode_t (*)(ni_logan_device_type_t devType,
+        ni_logan_device_info_t *devInfo, int *devCount);
+    using NiRsrcUpdateDeviceLoadFunc = int (*)(ni_logan_device_context_t *devCtx, int load,
+        int swInstanceCnt, const ni_logan_sw_instance_info_t swInstanceInfo[]);
     using NiRsrcReleaseResourceFunc = void (*)(ni_logan_device_context_t *devCtx, ni_codec_t codec, unsigned long load);
     using NiRsrcFreeDeviceContextFunc = void (*)(ni_logan_device_context_t *devCtx);
 
@@ -60,10 +75,8 @@ namespace {
     using NiDeviceSessionCloseFunc =
         ni_logan_retcode_t (*)(ni_logan_session_context_t *sessionCtx, int eosRecieved, ni_logan_device_type_t devType);
 
-    using NiPacketBufferAllocFunc = ni_logan_retcode_t (*)(ni_logan_packet_t *packet, int packetSize);
     using NiPacketCopyFunc =
         int (*)(void *destination, const void * const source, int curSize, void *leftover, int *prevSize);
-    using NiPacketBufferFreeFunc = ni_logan_retcode_t (*)(ni_logan_packet_t *packet);
 
     using NiDecoderFrameBufferAllocFunc = ni_logan_retcode_t (*)(ni_logan_buf_pool_t *pool, ni_logan_frame_t *frame,
         int allocMem, int videoWidth, int videoHeight, int alignment, int factor);
@@ -72,7 +85,10 @@ namespace {
     std::unordered_map<std::string, void*> g_funcMap = {
         { NI_DECODER_INIT_DEFAULT_PARAMS, nullptr },
         { NI_RSRC_ALLOCATE_AUTO, nullptr },
+        { NI_RSRC_ALLOCATE_DIRECT, nullptr },
         { NI_RSRC_RELEASE_RESOURCE, nullptr },
+        { NI_RSRC_LIST_DEVICES, nullptr },
+        { NI_RSRC_UPDATE_DEVICE_LOAD, nullptr },
         { NI_RSRC_FREE_DEVICE_CONTEXT, nullptr },
         { NI_DEVICE_OPEN, nullptr },
         { NI_DEVICE_CLOSE, nullptr },
@@ -84,9 +100,7 @@ namespace {
         { NI_DEVICE_DEC_SESSION_SAVE_HDRS, nullptr },
         { NI_DEVICE_SESSION_WRITE, nullptr },
         { NI_DEVICE_SESSION_CLOSE, nullptr },
-        { NI_PACKET_BUFFER_ALLOC, nullptr },
         { NI_PACKET_COPY, nullptr },
-        { NI_PACKET_BUFFER_FREE, nullptr },
         { NI_DECODER_FRAME_BUFFER_ALLOC, nullptr },
         { NI_DECODER_FRAME_BUFFER_FREE, nullptr }
     };
@@ -186,10 +200,23 @@ namespace {
     constexpr uint32_t NETINT_HEIGHT_ALIGN_H265 = 8;
     constexpr long DEFAULT_BITRATE = 2000000; // 2Mbps
     constexpr uint32_t NAL_START_CODE_MIN_LEN = 3;
-    constexpr uint32_t NAL_START_CODE_1ST_BYTE = 0;
-    constexpr uint32_t NAL_START_CODE_2ST_BYTE = 1;
+    constexpr int CONVERT_BIT_DEPTH = 8;    // 内置输出格式转换支持的位深
+    constexpr uint32_t FRAME_QUEUE_DEPTH_DEFAULT = 4;
+    constexpr uint32_t FRAME_QUEUE_DEPTH_MAX = 16;
+    constexpr uint32_t FRAME_POOL_DEPTH_DEFAULT = 2;    // 2: 一帧读取中，一帧由调用方处理
+    constexpr uint32_t FRAME_POOL_DEPTH_MAX = 32;
+    constexpr uint32_t PAGE_SIZE = 4096;                // 预触发缺页时的写入步长
+    constexpr std::chrono::microseconds READ_POLL_INTERVAL(500);   // 设备暂无解码帧时的轮询间隔
     constexpr uint32_t NAL_START_CODE_3ST_BYTE = 2;
-    constexpr uint32_t NAL_START_CODE_4ST_BYTE = 3;
+    constexpr uint32_t PIXELS_720P = 1280 * 720;
+    constexpr uint32_t PIXELS_1080P = 1920 * 1080;
+    constexpr long SESSION_POOL_SIZE_MAX = 4;
+    const std::string PROP_SESSION_POOL_SIZE = "persist.vmi.video.decode.session_pool_size";
+    // 为1时每次初始化后在后台为同一配置预热一个备用会话，占用额外的设备实例，数量受会话池上限约束
+    const std::string PROP_SESSION_PREWARM = "persist.vmi.video.decode.session_prewarm";
+    const std::string PROP_SCHED_POLICY = "persist.vmi.video.decode.sched_policy";
+    const std::string PROP_MIGRATE_THRESHOLD = "persist.vmi.video.decode.migrate_threshold";
+    constexpr int DEVICE_NUM_MAX = 128;  // 资源池共享内存中的设备数上限
     const std::string SHARED_LIB_NAME = "libxcoder_logan.so";
     std::atomic<bool> g_netintLoaded = { false };
     void *g_libHandle = nullptr;
@@ -198,6 +225,28 @@ namespace {
     {
         return (val + (align - 1)) & ~(align - 1);
     }
+
+    // 设备按NI_LOGAN_MEM_PAGE_ALIGNMENT对齐读取数据包，地址与大小均对齐时才能直接发送调用方缓冲
+    inline bool IsDeviceAligned(const uint8_t *data, uint32_t size)
+    {
+        return size > 0 && reinterpret_cast<uintptr_t>(data) % NI_LOGAN_MEM_PAGE_ALIGNMENT == 0 &&
+            size % NI_LOGAN_MEM_PAGE_ALIGNMENT == 0;
+    }
+
+    // 读取十进制整数属性，未配置、非法或超出[minValue, maxValue]时返回defaultValue
+    long GetLongProperty(const std::string &name, long minValue, long maxValue, long defaultValue)
+    {
+        char value[PROP_VALUE_MAX] = {'\0'};
+        if (__system_property_get(name.c_str(), value) <= 0) {
+            return defaultValue;
+        }
+        char *end = nullptr;
+        long result = strtol(value, &end, 10); // 10: 十进制
+        if (end == value || *end != '\0' || result < minValue || result > maxValue) {
+            return defaultValue;
+        }
+        return result;
+    }
 }
 
 VideoDecoderNetint::~VideoDecoderNetint()
@@ -231,23 +280,87 @@ DecoderRetCode VideoDecoderNetint::InitDecoder()
 DecoderRetCode VideoDecoderNetint::SendStreamData(uint8_t *buffer, uint32_t filledLen)
 {
     if (m_stop) {
-        ALOGE("send stream data, stop status.");
+        ALOGE_LIMITED("send stream data, stop status.");
         return VIDEO_DECODER_DECODE_FAIL;
     }
+    if (m_sessionOpenFailed) {
+        ALOGE_LIMITED("send stream data, session open failed, restart the decoder.");
+        return VIDEO_DECODER_START_FAIL;
+    }
+    if (m_session == nullptr) {
+        DecoderRetCode ret = OpenSessionForStream(buffer, filledLen);
+        if (ret != VIDEO_DECODER_SUCCESS) {
+            // 打开失败不再逐包重试，之后的读写均返回同一错误，直到重新启动解码器
+            m_sessionOpenFailed = true;
+            return ret;
+        }
+    }
 
+    if (m_replayHeaders && m_packet.data.packet.data_len == 0 && buffer != nullptr) {
+        // 迁移后的新会话尚未收到码流头信息，补发在当前数据之前
+        m_replayHeaders = false;
+        std::vector<uint8_t> data(m_streamHeaders);
+        data.insert(data.end(), buffer, buffer + filledLen);
+        return DecoderWriteData(data.data(), static_cast<uint32_t>(data.size()));
+    }
     return DecoderWriteData(buffer, filledLen);
 }
 
 DecoderRetCode VideoDecoderNetint::RetrieveFrameData(uint8_t *buffer, uint32_t maxLen, uint32_t *filledLen)
 {
     if (m_stop) {
-        ALOGE("retrieve frame data, stop status.");
+        ALOGE_LIMITED("retrieve frame data, stop status.");
         return VIDEO_DECODER_DECODE_FAIL;
     }
 
     return DecoderReadData(buffer, maxLen, filledLen);
 }
 
+DecoderRetCode VideoDecoderNetint::RetrieveFrameData(uint8_t *buffer, uint32_t maxLen, uint32_t *filledLen,
+    int32_t timeoutMs)
+{
+    bool infinite = timeoutMs < 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+    while (true) {
+        DecoderRetCode ret = RetrieveFrameData(buffer, maxLen, filledLen);
+        if (ret != VIDEO_DECODER_READ_UNDERFLOW || (!infinite && std::chrono::steady_clock::now() >= deadline)) {
+            return ret;
+        }
+        WaitForFrame(deadline, infinite);
+    }
+}
+
+DecoderRetCode VideoDecoderNetint::AcquireFrame(DecodedFrame *frame)
+{
+    if (frame == nullptr) {
+        ALOGE("acquire frame, frame is nullptr.");
+        return VIDEO_DECODER_DECODE_FAIL;
+    }
+    if (m_stop) {
+        ALOGE_LIMITED("acquire frame, stop status.");
+        return VIDEO_DECODER_DECODE_FAIL;
+    }
+
+    DecoderRetCode ret = DecoderReadFrame();
+    if (ret != VIDEO_DECODER_SUCCESS) {
+        return ret;
+    }
+    if (CheckPicSizeChange()) {
+        return VIDEO_DECODER_BAD_PIC_SIZE;
+    }
+    return DecoderHandoutFrame(*frame);
+}
+
+DecoderRetCode VideoDecoderNetint::ReleaseFrame(DecodedFrame *frame)
+{
+    if (frame == nullptr) {
+        ALOGE("release frame, frame is nullptr.");
+        return VIDEO_DECODER_DECODE_FAIL;
+    }
+    *frame = DecodedFrame();
+    return VIDEO_DECODER_SUCCESS;
+}
+
 DecoderRetCode VideoDecoderNetint::SetCallbacks(std::function<void(DecodeEventIndex, uint32_t, void *)> eventCallBack)
 {
     m_eventCallBack = eventCallBack;
@@ -272,6 +385,49 @@ DecoderRetCode VideoDecoderNetint::SetDecodeParams(DecodeParamsIndex index, void
             m_writeWidth = params->width;
             m_writeHeight = params->height;
             m_stride = params->stride;
+            m_displayWidth = (params->cropWidth != 0) ? params->cropWidth : params->width;
+            m_displayHeight = (params->cropHeight != 0) ? params->cropHeight : params->height;
+            m_picChangeNotified = false;
+            break;
+        }
+        case INDEX_ASYNC_MODE_INFO: {
+            auto params = static_cast<AsyncModeParams *>(decParams);
+            if (!m_stop) {
+                ALOGE("set decode params, async mode can only be set before start.");
+                return VIDEO_DECODER_SET_DECODE_PARAMS_FAIL;
+            }
+            m_asyncMode = params->enable;
+            m_queueDepth = (params->queueDepth == 0) ? FRAME_QUEUE_DEPTH_DEFAULT :
+                std::min(params->queueDepth, FRAME_QUEUE_DEPTH_MAX);
+            ALOGI("set decode params, async mode %d, queue depth %u", m_asyncMode, m_queueDepth);
+            break;
+        }
+        case INDEX_FRAME_POOL_INFO: {
+            auto params = static_cast<FramePoolParams *>(decParams);
+            if (!m_stop) {
+                ALOGE("set decode params, frame pool can only be set before start.");
+                return VIDEO_DECODER_SET_DECODE_PARAMS_FAIL;
+            }
+            m_framePoolDepth = std::min(params->depth, FRAME_POOL_DEPTH_MAX);
+            ALOGI("set decode params, frame pool depth %u", m_framePoolDepth);
+            break;
+        }
+        case INDEX_PORT_FORMAT_INFO: {
+            auto params = static_cast<PortFormatParams *>(decParams);
+            if (params->port != OUT_PORT) {
+                break;
+            }
+            // NV12/NV21/RGBA由解码器内置转换，仅支持8bit输出；YUV420P交由CopyFrame钩子拷贝
+            auto format = static_cast<MediaPixelFormat>(params->format);
+            bool builtin = format == PIXEL_FORMAT_NV12 || format == PIXEL_FORMAT_NV21 ||
+                format == PIXEL_FORMAT_RGBA_8888;
+            bool hook = format == PIXEL_FORMAT_YUV_420P || format == PIXEL_FORMAT_FLEX_YUV_420P;
+            if (!(builtin && m_bitDepth == CONVERT_BIT_DEPTH) && !hook) {
+                ALOGE("set decode params, output format %d not supported, bit depth %d", params->format, m_bitDepth);
+                return VIDEO_DECODER_SET_DECODE_PARAMS_FAIL;
+            }
+            ALOGI("set decode params, output format %d", params->format);
+            m_outputFormat = format;
             break;
         }
         default:
@@ -289,12 +445,14 @@ DecoderRetCode VideoDecoderNetint::GetDecodeParams(DecodeParamsIndex index, void
             params->width = m_writeWidth;
             params->stride = static_cast<int32_t>(m_writeWidth);
             params->height = params->scanLines = m_writeHeight;
+            params->cropWidth = m_displayWidth;
+            params->cropHeight = m_displayHeight;
             break;
         }
         case INDEX_PORT_FORMAT_INFO: {
             auto params = static_cast<PortFormatParams *>(decParams);
             if (params->port == OUT_PORT) {
-                params->format = PIXEL_FORMAT_FLEX_YUV_420P;
+                params->format = m_outputFormat;
             } else if (params->port == IN_PORT) {
                 params->format = m_codec;
             } else {
@@ -302,6 +460,17 @@ DecoderRetCode VideoDecoderNetint::GetDecodeParams(DecodeParamsIndex index, void
             }
             break;
         }
+        case INDEX_ASYNC_MODE_INFO: {
+            auto params = static_cast<AsyncModeParams *>(decParams);
+            params->enable = m_asyncMode;
+            params->queueDepth = m_queueDepth;
+            break;
+        }
+        case INDEX_FRAME_POOL_INFO: {
+            auto params = static_cast<FramePoolParams *>(decParams);
+            params->depth = FramePoolDepth();
+            break;
+        }
         case INDEX_ALIGN_INFO: {
             auto params = static_cast<AlignInfoParams *>(decParams);
             params->widthAlign = NETINT_WIDTH_ALIGN;
@@ -323,13 +492,30 @@ DecoderRetCode VideoDecoderNetint::GetDecodeParams(DecodeParamsIndex index, void
 DecoderRetCode VideoDecoderNetint::Flush()
 {
     ALOGI("decoder flush.");
-    auto deviceDecSessionFlush =
-        reinterpret_cast<NiDeviceDecSessionFlushFunc>(g_funcMap[NI_DEVICE_DEC_SESSION_FLUSH]);
-    ni_logan_retcode_t ret = (*deviceDecSessionFlush)(&m_sessionCtx);
-    if (ret != NI_LOGAN_RETCODE_SUCCESS) {
-        ALOGE("device dec session flush error.");
+    if (m_stop) {
+        ALOGE("decoder flush, decoder is not started.");
         return VIDEO_DECODER_RESET_FAIL;
     }
+    if (m_session == nullptr) {
+        ALOGI("decoder flush, session not opened yet.");
+        return VIDEO_DECODER_SUCCESS;
+    }
+    // 读取线程停止后再操作会话，队列中的解码帧与等待重新配置的帧随之丢弃
+    StopReader();
+    m_framePending = false;
+    m_picChangeNotified = false;
+    if (!MigrateSession()) {
+        auto deviceDecSessionFlush =
+            reinterpret_cast<NiDeviceDecSessionFlushFunc>(g_funcMap[NI_DEVICE_DEC_SESSION_FLUSH]);
+        ni_logan_retcode_t ret = (*deviceDecSessionFlush)(&m_session->sessionCtx);
+        if (ret != NI_LOGAN_RETCODE_SUCCESS) {
+            ALOGE("device dec session flush error.");
+            return VIDEO_DECODER_RESET_FAIL;
+        }
+    }
+    if (m_asyncMode) {
+        StartReader();
+    }
     return VIDEO_DECODER_SUCCESS;
 }
 
@@ -341,14 +527,15 @@ DecoderRetCode VideoDecoderNetint::StartDecoder()
         ALOGE("load netint so error.");
         return VIDEO_DECODER_START_FAIL;
     }
-
-    if (!InitContext()) {
-        ALOGE("init context error.");
+    if (CollectDeviceLoads().empty()) {
+        ALOGE("start decoder, no decoder device available.");
         return VIDEO_DECODER_START_FAIL;
     }
 
+    // 会话在首包数据到达、解析出码流参数后打开
+    m_sessionOpenFailed = false;
     m_stop = false;
-    ALOGI("start decoder success");
+    ALOGI("start decoder success, session opens with the first packet.");
     return VIDEO_DECODER_SUCCESS;
 }
 
@@ -361,8 +548,9 @@ DecoderRetCode VideoDecoderNetint::StopDecoder()
 
     m_packet.data.packet.end_of_stream = 1;
     ALOGI("stop decoder, session ctx ready to close is %u, frame end of stream is %u",
-        m_sessionCtx.ready_to_close, m_frame.data.frame.end_of_stream);
+        (m_session != nullptr) ? m_session->sessionCtx.ready_to_close : 0, m_frame.data.frame.end_of_stream);
 
+    StopReader();
     DestroyContext();
 
     m_stop = true;
@@ -418,77 +606,367 @@ bool VideoDecoderNetint::LoadNetintSharedLib() const
 bool VideoDecoderNetint::InitContext()
 {
     ALOGI("init context start.");
-    if (!InitCtxParams()) {
-        ALOGE("init context params failed.");
-        return false;
-    }
-
     m_packet = {};
     m_frame = {};
     m_startOfStream = 1;
+    m_sessionBroken = false;
+    m_streamHeaders.clear();
+    m_replayHeaders = false;
+    m_poolWidth = 0;
+    m_poolHeight = 0;
+    m_framePending = false;
+    m_picChangeNotified = false;
+
+    SessionPool<NetintDecoderSession> &pool = GetSessionPool();
+    pool.SetCapacity(GetSessionPoolSize());
+    const SessionConfig config = { m_codec, m_sessionWidth, m_sessionHeight, m_frameRate, m_bitDepth };
+    m_sessionKey = SessionKey(config);
+    m_session = pool.Acquire(m_sessionKey);
+    if (m_session != nullptr) {
+        // 复用的会话已经过ni_logan_device_dec_session_flush，与Flush后继续解码的处理一致；
+        // 已保存的参数集属于之前的码流，清空后由新码流的参数集重新保存
+        m_startOfStream = 0;
+        m_session->savedHeaders.clear();
+        ALOGI("init context, reuse session %s.", m_sessionKey.c_str());
+    } else {
+        m_session = OpenSession(config);
+        if (m_session == nullptr) {
+            ALOGE("init context, open session failed.");
+            return false;
+        }
+    }
+    m_frameOwner = std::make_shared<FrameOwner>();
+    if (GetLongProperty(PROP_SESSION_PREWARM, 0, 1, 0) == 1) {
+        pool.Prewarm(m_sessionKey, [config]() { return OpenSession(config); });
+    }
+    return true;
+}
 
+DecoderRetCode VideoDecoderNetint::OpenSessionForStream(const uint8_t *buffer, uint32_t filledLen)
+{
+    m_sessionWidth = m_writeWidth;
+    m_sessionHeight = m_writeHeight;
+    uint32_t codedWidth = m_writeWidth;
+    uint32_t codedHeight = m_writeHeight;
+    bool notified = false;
+    SpsParser::StreamInfo info;
+    if (buffer != nullptr && SpsParser::Parse(buffer, filledLen, m_codec == EN_H264, info)) {
+        ALOGI("stream info %ux%u, coded %ux%u, %u bit, %u fps", info.width, info.height, info.codedWidth,
+            info.codedHeight, info.bitDepth, info.frameRate);
+        bool builtin = m_outputFormat == PIXEL_FORMAT_NV12 || m_outputFormat == PIXEL_FORMAT_NV21 ||
+            m_outputFormat == PIXEL_FORMAT_RGBA_8888;
+        if (builtin && static_cast<int>(info.bitDepth) != CONVERT_BIT_DEPTH) {
+            ALOGE("open session, output format %u not supported, stream bit depth %u", m_outputFormat, info.bitDepth);
+            return VIDEO_DECODER_START_FAIL;
+        }
+        m_sessionWidth = info.width;
+        m_sessionHeight = info.height;
+        codedWidth = info.codedWidth;
+        codedHeight = info.codedHeight;
+        m_bitDepth = static_cast<int>(info.bitDepth);
+        if (info.frameRate > 0) {
+            m_frameRate = static_cast<int>(info.frameRate);
+        }
+        if (info.width != m_displayWidth || info.height != m_displayHeight) {
+            uint32_t heightAlign = (m_codec == EN_H264) ? NETINT_HEIGHT_ALIGN_H264 : NETINT_HEIGHT_ALIGN_H265;
+            PicInfoParams decParams = {
+                .width = AlignUp(info.codedWidth, NETINT_WIDTH_ALIGN),
+                .height = AlignUp(info.codedHeight, heightAlign),
+                .stride = static_cast<int32_t>(AlignUp(info.codedWidth, NETINT_WIDTH_ALIGN)),
+                .scanLines = AlignUp(info.codedHeight, heightAlign),
+                .cropWidth = info.width,
+                .cropHeight = info.height
+            };
+            ALOGI("stream size %ux%u differs from configured %ux%u, notify before decoding.",
+                info.width, info.height, m_displayWidth, m_displayHeight);
+            if (m_eventCallBack) {
+                m_eventCallBack(INDEX_PIC_INFO_CHANGE, 0, &decParams);
+            }
+            notified = true;
+        }
+    } else {
+        ALOGW("open session, no usable parameter set in the first packet, use configured size %ux%u.",
+            m_writeWidth, m_writeHeight);
+    }
+
+    if (!InitContext()) {
+        ALOGE("init context error.");
+        return VIDEO_DECODER_START_FAIL;
+    }
+    // 已在解码前通知过码流尺寸，上层未重新配置时首帧保留等待，不重复通知
+    m_picChangeNotified = notified;
+    ReserveFramePool(codedWidth, codedHeight);
+    if (m_asyncMode) {
+        StartReader();
+    }
+    return VIDEO_DECODER_SUCCESS;
+}
+
+VideoDecoderNetint::FrameOwner::~FrameOwner()
+{
+    if (session != nullptr) {
+        ALOGI("all handed out frames released, close session.");
+        CloseSession(*session);
+    }
+}
+
+void VideoDecoderNetint::CloseCurrentSession()
+{
+    // 只有解码器持有FrameOwner时不存在未归还的帧
+    if (m_frameOwner != nullptr && m_frameOwner.use_count() > 1) {
+        ALOGI("frames still handed out, close session after they are released.");
+        m_frameOwner->session = std::move(m_session);
+    } else {
+        CloseSession(*m_session);
+    }
+    m_frameOwner.reset();
+}
+
+std::unique_ptr<NetintDecoderSession> VideoDecoderNetint::OpenSession(const SessionConfig &config)
+{
+    ALOGI("init ctx params start.");
+    auto session = std::make_unique<NetintDecoderSession>();
+    session->codec = config.codec;
+    auto decInitDefaultParams = reinterpret_cast<NiDecInitDefaultParamsFunc>(g_funcMap[NI_DECODER_INIT_DEFAULT_PARAMS]);
+    ni_logan_retcode_t ret = (*decInitDefaultParams)(&session->decApiParams, config.frameRate, 1, DEFAULT_BITRATE,
+        config.width, config.height);
+    if (ret != NI_LOGAN_RETCODE_SUCCESS) {
+        ALOGE("decoder init default params error %d", ret);
+        return nullptr;
+    }
+
+    ni_logan_session_context_t &sessionCtx = session->sessionCtx;
     auto deviceSessionContextInit =
         reinterpret_cast<NiDeviceSessionContextInitFunc>(g_funcMap[NI_DEVICE_SESSION_CONTEXT_INIT]);
-    (*deviceSessionContextInit)(&m_sessionCtx);
+    (*deviceSessionContextInit)(&sessionCtx);
 
-    m_sessionCtx.p_session_config = nullptr;
-    m_sessionCtx.session_id = NI_LOGAN_INVALID_SESSION_ID;
-    m_sessionCtx.codec_format = (m_codec == EN_H264) ? NI_LOGAN_CODEC_FORMAT_H264 : NI_LOGAN_CODEC_FORMAT_H265;
+    sessionCtx.p_session_config = nullptr;
+    sessionCtx.session_id = NI_LOGAN_INVALID_SESSION_ID;
+    sessionCtx.codec_format = (config.codec == EN_H264) ? NI_LOGAN_CODEC_FORMAT_H264 : NI_LOGAN_CODEC_FORMAT_H265;
+    sessionCtx.device_handle = NI_INVALID_DEVICE_HANDLE;
+    sessionCtx.blk_io_handle = NI_INVALID_DEVICE_HANDLE;
 
-    auto rsrcAllocateAuto = reinterpret_cast<NiRsrcAllocateAutoFunc>(g_funcMap[NI_RSRC_ALLOCATE_AUTO]);
-    m_devCtx = (*rsrcAllocateAuto)( NI_LOGAN_DEVICE_TYPE_DECODER, EN_ALLOC_LEAST_INSTANCE, m_codec, m_writeWidth,
-        m_writeHeight, m_frameRate, &m_load);
-    if (m_devCtx == nullptr) {
-        ALOGE("rsrc allocate auto failed.");
-        return false;
+    if (!AllocateDevice(*session, config)) {
+        ALOGE("rsrc allocate failed.");
+        return nullptr;
     }
 
-    std::string xcoderGuid = m_devCtx->p_device_info->dev_name;
-    std::string xcoderNsid = m_devCtx->p_device_info->blk_name;
-    ALOGI("netint xcoder Guid: %s", xcoderGuid.c_str());
+    std::string xcoderGuid = session->devCtx->p_device_info->dev_name;
+    std::string xcoderNsid = session->devCtx->p_device_info->blk_name;
+    ALOGI("netint xcoder Guid: %s, module id %d", xcoderGuid.c_str(), session->guid);
     ALOGI("netint xcoder Nsid: %s", xcoderNsid.c_str());
 
     auto deviceOpen = reinterpret_cast<NiDeviceOpenFunc>(g_funcMap[NI_DEVICE_OPEN]);
-    ni_device_handle_t devHandle = (*deviceOpen)(xcoderNsid.c_str(), &m_sessionCtx.max_nvme_io_size);
-    ni_device_handle_t blkHandle = (*deviceOpen)(xcoderNsid.c_str(), &m_sessionCtx.max_nvme_io_size);
-    if ((devHandle == NI_INVALID_DEVICE_HANDLE) || (blkHandle == NI_INVALID_DEVICE_HANDLE)) {
+    sessionCtx.device_handle = (*deviceOpen)(xcoderNsid.c_str(), &sessionCtx.max_nvme_io_size);
+    sessionCtx.blk_io_handle = (*deviceOpen)(xcoderNsid.c_str(), &sessionCtx.max_nvme_io_size);
+    if ((sessionCtx.device_handle == NI_INVALID_DEVICE_HANDLE) ||
+        (sessionCtx.blk_io_handle == NI_INVALID_DEVICE_HANDLE)) {
         ALOGE("init context, device open failed.");
-        return false;
+        CloseSession(*session);
+        return nullptr;
     }
 
-    m_sessionCtx.device_handle = devHandle;
-    m_sessionCtx.blk_io_handle = blkHandle;
-    m_sessionCtx.hw_id = 0;
-    m_sessionCtx.p_session_config = &m_decApiParams;
-    m_sessionCtx.src_bit_depth = m_bitDepth;
-    m_sessionCtx.src_endian = NI_LOGAN_FRAME_LITTLE_ENDIAN;
-    m_sessionCtx.bit_depth_factor = 1;
+    sessionCtx.hw_id = 0;
+    sessionCtx.p_session_config = &session->decApiParams;
+    sessionCtx.src_bit_depth = config.bitDepth;
+    sessionCtx.src_endian = NI_LOGAN_FRAME_LITTLE_ENDIAN;
+    sessionCtx.bit_depth_factor = 1;
 
     auto deviceSessionOpen = reinterpret_cast<NiDeviceSessionOpenFunc>(g_funcMap[NI_DEVICE_SESSION_OPEN]);
-    ni_logan_retcode_t ret = (*deviceSessionOpen)(&m_sessionCtx, NI_LOGAN_DEVICE_TYPE_DECODER);
+    ret = (*deviceSessionOpen)(&sessionCtx, NI_LOGAN_DEVICE_TYPE_DECODER);
     if (ret != NI_LOGAN_RETCODE_SUCCESS) {
         ALOGE("init decoder failed: device session open error %d", ret);
-        return false;
+        CloseSession(*session);
+        return nullptr;
     }
 
+    return session;
+}
+
+void VideoDecoderNetint::CloseSession(NetintDecoderSession &session)
+{
+    ni_logan_session_context_t &sessionCtx = session.sessionCtx;
+    if (sessionCtx.session_id != static_cast<uint32_t>(NI_LOGAN_INVALID_SESSION_ID)) {
+        auto deviceSessionFlush = reinterpret_cast<NiDeviceSessionFlushFunc>(g_funcMap[NI_DEVICE_SESSION_FLUSH]);
+        auto deviceSessionClose = reinterpret_cast<NiDeviceSessionCloseFunc>(g_funcMap[NI_DEVICE_SESSION_CLOSE]);
+        (void) (*deviceSessionFlush)(&sessionCtx, NI_LOGAN_DEVICE_TYPE_DECODER);
+        (void) (*deviceSessionClose)(&sessionCtx, 1, NI_LOGAN_DEVICE_TYPE_DECODER);
+    }
+
+    if (session.devCtx != nullptr) {
+        ALOGI("destroy rsrc start.");
+        PublishDeviceLoad(session, false);
+        auto rsrcReleaseResource = reinterpret_cast<NiRsrcReleaseResourceFunc>(g_funcMap[NI_RSRC_RELEASE_RESOURCE]);
+        auto rsrcFreeDeviceContext =
+            reinterpret_cast<NiRsrcFreeDeviceContextFunc>(g_funcMap[NI_RSRC_FREE_DEVICE_CONTEXT]);
+        (*rsrcReleaseResource)(session.devCtx, session.codec, session.load);
+        (*rsrcFreeDeviceContext)(session.devCtx);
+
+        session.devCtx = nullptr;
+        ALOGI("destroy rsrc done.");
+    }
+
+    auto deviceClose = reinterpret_cast<NiDeviceCloseFunc>(g_funcMap[NI_DEVICE_CLOSE]);
+    if (sessionCtx.device_handle != NI_INVALID_DEVICE_HANDLE) {
+        (*deviceClose)(sessionCtx.device_handle);
+    }
+    if (sessionCtx.blk_io_handle != NI_INVALID_DEVICE_HANDLE) {
+        (*deviceClose)(sessionCtx.blk_io_handle);
+    }
+}
+
+std::vector<DeviceLoad> VideoDecoderNetint::CollectDeviceLoads()
+{
+    std::vector<DeviceLoad> devices;
+    auto rsrcListDevices = reinterpret_cast<NiRsrcListDevicesFunc>(g_funcMap[NI_RSRC_LIST_DEVICES]);
+    std::vector<ni_logan_device_info_t> infos(DEVICE_NUM_MAX);
+    int count = 0;
+    if ((*rsrcListDevices)(NI_LOGAN_DEVICE_TYPE_DECODER, infos.data(), &count) != NI_LOGAN_RETCODE_SUCCESS) {
+        ALOGW("list decoder devices failed.");
+        return devices;
+    }
+    count = std::min(std::max(count, 0), DEVICE_NUM_MAX);
+
+    // 设备guid取自设备信息中的module_id，与列表中的下标无关，分配与迁移均按guid指定设备
+    for (int i = 0; i < count; ++i) {
+        const ni_logan_device_info_t &info = infos[i];
+        DeviceLoad device;
+        device.guid = info.module_id;
+        device.capacity = DeviceScheduler::Capacity(info.max_fps_1080p);
+        device.instances = info.active_num_inst;
+        device.maxInstances = info.max_instance_cnt;
+        int load = std::max({ info.load, info.model_load, 0 });
+        device.loadPercent = std::min(static_cast<uint32_t>(load), DeviceScheduler::LOAD_FULL);
+        devices.push_back(device);
+    }
+    return devices;
+}
+
+bool VideoDecoderNetint::AllocateDevice(NetintDecoderSession &session, const SessionConfig &config)
+{
+    session.pixelRate = static_cast<uint64_t>(config.width) * config.height * static_cast<uint64_t>(config.frameRate);
+    std::vector<DeviceLoad> devices = CollectDeviceLoads();
+    int guid = config.guid;
+    if (guid < 0) {
+        char value[PROP_VALUE_MAX] = {'\0'};
+        (void) __system_property_get(PROP_SCHED_POLICY.c_str(), value);
+        PlacementPolicy policy = DeviceScheduler::ParsePolicy(value, PlacementPolicy::LEAST_INSTANCE);
+        guid = DeviceScheduler::Select(devices, session.pixelRate, policy);
+    }
+    if (guid >= 0) {
+        auto rsrcAllocateDirect = reinterpret_cast<NiRsrcAllocateDirectFunc>(g_funcMap[NI_RSRC_ALLOCATE_DIRECT]);
+        session.devCtx = (*rsrcAllocateDirect)(NI_LOGAN_DEVICE_TYPE_DECODER, guid, config.codec,
+            config.width, config.height, config.frameRate, &session.load);
+    }
+    if (session.devCtx == nullptr) {
+        ALOGW("rsrc allocate direct on guid %d failed, fallback to auto allocation.", guid);
+        auto rsrcAllocateAuto = reinterpret_cast<NiRsrcAllocateAutoFunc>(g_funcMap[NI_RSRC_ALLOCATE_AUTO]);
+        session.devCtx = (*rsrcAllocateAuto)(NI_LOGAN_DEVICE_TYPE_DECODER, EN_ALLOC_LEAST_INSTANCE, config.codec,
+            config.width, config.height, config.frameRate, &session.load);
+        if (session.devCtx == nullptr) {
+            return false;
+        }
+    }
+
+    session.guid = session.devCtx->p_device_info->module_id;
+    for (const auto &device : devices) {
+        if (device.guid == session.guid) {
+            session.loadPercent = DeviceScheduler::SessionLoad(device, session.pixelRate);
+        }
+    }
+    PublishDeviceLoad(session, true);
     return true;
 }
 
-bool VideoDecoderNetint::InitCtxParams()
+void VideoDecoderNetint::PublishDeviceLoad(NetintDecoderSession &session, bool add)
 {
-    ALOGI("init ctx params start.");
+    if (session.devCtx == nullptr || session.loadPercent == 0) {
+        return;
+    }
 
-    auto decInitDefaultParams = reinterpret_cast<NiDecInitDefaultParamsFunc>(g_funcMap[NI_DECODER_INIT_DEFAULT_PARAMS]);
-    ni_logan_retcode_t ret =
-        (*decInitDefaultParams)(&m_decApiParams, m_frameRate, 1, DEFAULT_BITRATE, m_writeWidth, m_writeHeight);
-    if (ret != NI_LOGAN_RETCODE_SUCCESS) {
-        ALOGE("decoder init default params error %d", ret);
+    // 设备上报负载会周期性覆盖该值，此处仅让其他进程在上报前感知会话的打开与关闭；
+    // 负载与实例数的读取和写回在设备共享锁内完成，避免多个进程同时打开或关闭会话时互相覆盖
+    ni_lock_handle_t devLock = session.devCtx->lock;
+    bool locked = (devLock != NI_INVALID_LOCK_HANDLE) && (flock(devLock, LOCK_EX) == 0);
+    if (!locked) {
+        ALOGW("lock device %d failed, publish load without lock.", session.guid);
+    }
+    const ni_logan_device_info_t &info = *session.devCtx->p_device_info;
+    int delta = add ? 1 : -1;
+    int load = info.load + delta * static_cast<int>(session.loadPercent);
+    load = std::min(std::max(load, 0), static_cast<int>(DeviceScheduler::LOAD_FULL));
+    int swInstanceCnt = std::min(std::max(info.active_num_inst + delta, 0), NI_LOGAN_MAX_CONTEXTS_PER_HW_INSTANCE);
+    // 库函数内部会对同一文件描述符加锁并在写回后解锁，此处的解锁仅在库函数未解锁时生效
+    auto updateDeviceLoad = reinterpret_cast<NiRsrcUpdateDeviceLoadFunc>(g_funcMap[NI_RSRC_UPDATE_DEVICE_LOAD]);
+    if ((*updateDeviceLoad)(session.devCtx, load, swInstanceCnt, info.sw_instance) != NI_LOGAN_RETCODE_SUCCESS) {
+        ALOGW("update load of device %d failed.", session.guid);
+    }
+    if (locked) {
+        (void) flock(devLock, LOCK_UN);
+    }
+}
+
+bool VideoDecoderNetint::MigrateSession()
+{
+    long threshold = GetLongProperty(PROP_MIGRATE_THRESHOLD, 0, DeviceScheduler::LOAD_FULL, 0);
+    if (threshold == 0 || m_streamHeaders.empty()) {
         return false;
     }
+    int target = DeviceScheduler::MigrationTarget(CollectDeviceLoads(), m_session->guid, m_session->pixelRate,
+        static_cast<uint32_t>(threshold));
+    if (target < 0) {
+        return false;
+    }
+
+    SessionConfig config = { m_codec, m_sessionWidth, m_sessionHeight, m_frameRate, m_bitDepth };
+    config.guid = target;
+    std::unique_ptr<NetintDecoderSession> session = OpenSession(config);
+    if (session == nullptr) {
+        ALOGW("migrate session to device %d failed, keep device %d.", target, m_session->guid);
+        return false;
+    }
+    ALOGI("device load imbalance over %ld%%, migrate session from device %d to %d.",
+        threshold, m_session->guid, target);
 
+    // 待发送的数据包与预留的帧缓冲属于原会话，与原会话一并释放，新会话按当前解码分辨率重新预留
+    uint32_t poolWidth = m_poolWidth;
+    uint32_t poolHeight = m_poolHeight;
+    ResetPacket();
+    auto decoderFrameBufferFree =
+        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
+    (void) (*decoderFrameBufferFree)(&(m_frame.data.frame));
+    CloseCurrentSession();
+    m_session = std::move(session);
+    m_frameOwner = std::make_shared<FrameOwner>();
+    m_poolWidth = 0;
+    m_poolHeight = 0;
+    ReserveFramePool(poolWidth, poolHeight);
+    m_sessionKey = SessionKey(config);
+    m_startOfStream = 1;
+    m_replayHeaders = true;
     return true;
 }
 
+std::string VideoDecoderNetint::SessionKey(const SessionConfig &config)
+{
+    // 解码分辨率由码流决定，按分辨率档位区分会话，档位决定设备负载的计算
+    uint32_t pixels = config.width * config.height;
+    std::string resolutionClass = (pixels <= PIXELS_720P) ? "720p" : ((pixels <= PIXELS_1080P) ? "1080p" : "4k");
+    return std::string((config.codec == EN_H264) ? "h264_" : "h265_") + resolutionClass + "_" +
+        std::to_string(config.bitDepth) + "bit";
+}
+
+SessionPool<NetintDecoderSession> &VideoDecoderNetint::GetSessionPool()
+{
+    static SessionPool<NetintDecoderSession> pool(CloseSession);
+    return pool;
+}
+
+uint32_t VideoDecoderNetint::GetSessionPoolSize()
+{
+    return static_cast<uint32_t>(GetLongProperty(PROP_SESSION_POOL_SIZE, 0, SESSION_POOL_SIZE_MAX, 0));
+}
+
 int VideoDecoderNetint::InitPacketData(const uint8_t *src, const uint32_t inputSize)
 {
     if (src == nullptr) {
@@ -507,39 +985,42 @@ int VideoDecoderNetint::InitPacketData(const uint8_t *src, const uint32_t inputS
         inPacket->p_data = nullptr;
         inPacket->data_len = inputSize;
 
-        if (inputSize + m_sessionCtx.prev_size > 0) {
-            auto packetBufferAlloc = reinterpret_cast<NiPacketBufferAllocFunc>(g_funcMap[NI_PACKET_BUFFER_ALLOC]);
-            ni_logan_retcode_t ret = (*packetBufferAlloc)(inPacket, inputSize + m_sessionCtx.prev_size);
-            if (ret != NI_LOGAN_RETCODE_SUCCESS) {
+        // 无遗留数据且调用方缓冲满足设备对齐要求时直接发送，否则拷贝到常驻数据包缓冲
+        m_packetZeroCopy = m_session->sessionCtx.prev_size == 0 && IsDeviceAligned(src, inputSize);
+        if (m_packetZeroCopy) {
+            inPacket->p_data = const_cast<uint8_t *>(src);
+        } else if (inputSize + m_session->sessionCtx.prev_size > 0) {
+            if (!ReservePacketBuffer(inputSize + m_session->sessionCtx.prev_size)) {
                 ALOGE("decoder write data: packet buffer alloc failed.");
                 return NI_LOGAN_RETCODE_FAILURE;
             }
+            inPacket->p_data = m_packetBuffer.get();
         }
 
         newPacket = true;
-        sendSize = inputSize + m_sessionCtx.prev_size;
-        saveSize = m_sessionCtx.prev_size;
+        sendSize = inputSize + m_session->sessionCtx.prev_size;
+        saveSize = m_session->sessionCtx.prev_size;
     } else {
         sendSize = static_cast<int>(inPacket->data_len);
     }
 
     inPacket->start_of_stream = m_startOfStream;
     inPacket->end_of_stream = 0;
-    inPacket->video_width = m_writeWidth;
-    inPacket->video_height = m_writeHeight;
+    inPacket->video_width = m_sessionWidth;
+    inPacket->video_height = m_sessionHeight;
 
     auto packetCopy = reinterpret_cast<NiPacketCopyFunc>(g_funcMap[NI_PACKET_COPY]);
     if (sendSize == 0) {
         if (newPacket) {
-            sendSize = (*packetCopy)(inPacket->p_data, src, 0, m_sessionCtx.p_leftover, &m_sessionCtx.prev_size);
+            sendSize = (*packetCopy)(inPacket->p_data, src, 0, m_session->sessionCtx.p_leftover, &m_session->sessionCtx.prev_size);
         }
         inPacket->data_len = static_cast<uint32_t>(sendSize);
         inPacket->end_of_stream = 1;
         ALOGI("decoder write data: sending last packet, size:%d + eos", sendSize);
     } else {
-        if (newPacket) {
+        if (newPacket && !m_packetZeroCopy) {
             sendSize =
-                (*packetCopy)(inPacket->p_data, src, inputSize, m_sessionCtx.p_leftover, &m_sessionCtx.prev_size);
+                (*packetCopy)(inPacket->p_data, src, inputSize, m_session->sessionCtx.p_leftover, &m_session->sessionCtx.prev_size);
             inPacket->data_len += saveSize;
         }
     }
@@ -547,11 +1028,50 @@ int VideoDecoderNetint::InitPacketData(const uint8_t *src, const uint32_t inputS
     return sendSize;
 }
 
-bool VideoDecoderNetint::InitFrameData()
+bool VideoDecoderNetint::ReservePacketBuffer(uint32_t size)
+{
+    uint32_t alignedSize = AlignUp(size, NI_LOGAN_MEM_PAGE_ALIGNMENT);
+    if (alignedSize <= m_packetBufferSize) {
+        return true;
+    }
+    void *buffer = nullptr;
+    if (posix_memalign(&buffer, NI_LOGAN_MEM_PAGE_ALIGNMENT, alignedSize) != 0) {
+        ALOGE("packet buffer alloc failed, size:%u", alignedSize);
+        return false;
+    }
+    ALOGI("packet buffer grow from %u to %u", m_packetBufferSize, alignedSize);
+    m_packetBuffer.reset(static_cast<uint8_t *>(buffer));
+    m_packetBufferSize = alignedSize;
+    return true;
+}
+
+bool VideoDecoderNetint::DetachPacketData()
+{
+    if (!m_packetZeroCopy) {
+        return true;
+    }
+    ni_logan_packet_t *inPacket = &(m_packet.data.packet);
+    if (!ReservePacketBuffer(inPacket->data_len)) {
+        return false;
+    }
+    std::copy_n(static_cast<const uint8_t *>(inPacket->p_data), inPacket->data_len, m_packetBuffer.get());
+    inPacket->p_data = m_packetBuffer.get();
+    m_packetZeroCopy = false;
+    return true;
+}
+
+void VideoDecoderNetint::ResetPacket()
 {
-    uint32_t width = m_sessionCtx.active_video_width > 0 ? m_sessionCtx.active_video_width : m_writeWidth;
-    uint32_t height = m_sessionCtx.active_video_height > 0 ? m_sessionCtx.active_video_height : m_writeHeight;
-    int allocMem = (m_sessionCtx.active_video_width > 0 && m_sessionCtx.active_video_height > 0) ? 1 : 0;
+    m_packet.data.packet.p_data = nullptr;
+    m_packet.data.packet.data_len = 0;
+    m_packetZeroCopy = false;
+}
+
+bool VideoDecoderNetint::InitFrameData(ni_logan_session_data_io_t &frameData)
+{
+    uint32_t width = m_session->sessionCtx.active_video_width > 0 ? m_session->sessionCtx.active_video_width : m_writeWidth;
+    uint32_t height = m_session->sessionCtx.active_video_height > 0 ? m_session->sessionCtx.active_video_height : m_writeHeight;
+    int allocMem = (m_session->sessionCtx.active_video_width > 0 && m_session->sessionCtx.active_video_height > 0) ? 1 : 0;
     auto decoderFrameBufferAlloc =
         reinterpret_cast<NiDecoderFrameBufferAllocFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_ALLOC]);
 
@@ -559,10 +1079,17 @@ bool VideoDecoderNetint::InitFrameData()
         ALOGE("receiving data error, width:%u or height:%u out of range!", width, height);
         return false;
     }
+    ni_logan_frame_t &frame = frameData.data.frame;
+    if (allocMem != 0) {
+        // 上次读取未取到帧或帧已拷贝出去时，同分辨率的buffer直接复用，不经过缓冲池
+        if (frame.p_buffer != nullptr && frame.video_width == width && frame.video_height == height) {
+            return true;
+        }
+        ReserveFramePool(width, height);
+    }
 
-    ni_logan_retcode_t ret = (*decoderFrameBufferAlloc)(m_sessionCtx.dec_fme_buf_pool, &(m_frame.data.frame),
-        allocMem, static_cast<int>(width), static_cast<int>(height),
-        m_sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H264, m_sessionCtx.bit_depth_factor);
+    ni_logan_retcode_t ret = (*decoderFrameBufferAlloc)(m_session->sessionCtx.dec_fme_buf_pool, &frame, allocMem, static_cast<int>(width), static_cast<int>(height),
+        m_session->sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H264, m_session->sessionCtx.bit_depth_factor);
     if (ret != NI_LOGAN_RETCODE_SUCCESS) {
         ALOGE("receiving data error, decoder frame buffer alloc error. ret:%d", ret);
         return false;
@@ -571,9 +1098,55 @@ bool VideoDecoderNetint::InitFrameData()
     return true;
 }
 
+uint32_t VideoDecoderNetint::FramePoolDepth() const
+{
+    if (m_framePoolDepth != 0) {
+        return m_framePoolDepth;
+    }
+    // 异步模式下队列中的帧各占一个缓冲
+    return FRAME_POOL_DEPTH_DEFAULT + (m_asyncMode ? m_queueDepth : 0);
+}
+
+void VideoDecoderNetint::ReserveFramePool(uint32_t width, uint32_t height)
+{
+    ni_logan_buf_pool_t *bufPool = m_session->sessionCtx.dec_fme_buf_pool;
+    if (bufPool == nullptr || width == 0 || height == 0 || width > INT_MAX || height > INT_MAX ||
+        (width == m_poolWidth && height == m_poolHeight)) {
+        return;
+    }
+    auto decoderFrameBufferAlloc =
+        reinterpret_cast<NiDecoderFrameBufferAllocFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_ALLOC]);
+    auto decoderFrameBufferFree =
+        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
+    int alignment = (m_session->sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H264) ? 1 : 0;
+    std::vector<ni_logan_frame_t> frames(FramePoolDepth());
+    uint32_t reserved = 0;
+    for (auto &frame : frames) {
+        frame = {};
+        ni_logan_retcode_t ret = (*decoderFrameBufferAlloc)(bufPool, &frame, 1, static_cast<int>(width),
+            static_cast<int>(height), alignment, m_session->sessionCtx.bit_depth_factor);
+        if (ret != NI_LOGAN_RETCODE_SUCCESS || frame.p_buffer == nullptr) {
+            ALOGW("reserve frame pool, alloc buffer %u failed. ret:%d", reserved, ret);
+            break;
+        }
+        // 新申请的缓冲尚未映射物理页，逐页写入，避免解码后首次写入时缺页
+        auto *data = static_cast<volatile uint8_t *>(frame.p_buffer);
+        for (uint32_t offset = 0; offset < frame.buffer_size; offset += PAGE_SIZE) {
+            data[offset] = 0;
+        }
+        ++reserved;
+    }
+    for (auto &frame : frames) {
+        (void) (*decoderFrameBufferFree)(&frame);
+    }
+    m_poolWidth = width;
+    m_poolHeight = height;
+    ALOGI("reserve frame pool, %u buffers for %ux%u.", reserved, width, height);
+}
+
 DecoderRetCode VideoDecoderNetint::DecoderWriteData(const uint8_t *buffer, const uint32_t filledLen)
 {
-    if (m_sessionCtx.ready_to_close != 0) {
+    if (m_session->sessionCtx.ready_to_close != 0) {
         ALOGE("decoder write data: session ctx ready to close is 1, no send.");
         return VIDEO_DECODER_DECODE_FAIL;
     }
@@ -590,17 +1163,20 @@ DecoderRetCode VideoDecoderNetint::DecoderWriteData(const uint8_t *buffer, const
     int txSize = DeviceDecSessionWrite();
     if (txSize < 0) {
         ALOGE("decoder write data: sending data error. txSize:%d", txSize);
+        m_sessionBroken = true;
         (void) StopDecoder();
         return VIDEO_DECODER_DECODE_FAIL;
     } else if (txSize == 0 && filledLen != 0) {
-        ALOGW("decoder write data: 0 byte sent this time, sleep and will re-try.");
+        // 重发时调用方缓冲可能已失效，直接引用的数据先转存
+        if (!DetachPacketData()) {
+            ALOGE("decoder write data: keep packet for re-try failed, drop it.");
+            ResetPacket();
+            return VIDEO_DECODER_DECODE_FAIL;
+        }
+        ALOGW_LIMITED("decoder write data: 0 byte sent this time, sleep and will re-try.");
         return VIDEO_DECODER_WRITE_OVERFLOW;
     } else {
-        auto packetBufferFree = reinterpret_cast<NiPacketBufferFreeFunc>(g_funcMap[NI_PACKET_BUFFER_FREE]);
-        ni_logan_retcode_t ret = (*packetBufferFree)(&(m_packet.data.packet));
-        if (ret != NI_LOGAN_RETCODE_SUCCESS) {
-            ALOGW("decoder write data: packet buffer free failed, ret:%d", ret);
-        }
+        ResetPacket();
     }
 
     return VIDEO_DECODER_SUCCESS;
@@ -623,33 +1199,39 @@ void VideoDecoderNetint::DecodeFpsStat()
 
 DecoderRetCode VideoDecoderNetint::DecoderReadData(uint8_t *buffer, const uint32_t maxLen, uint32_t *filledLen)
 {
-    if (!InitFrameData()) {
+    DecoderRetCode ret = DecoderReadFrame();
+    if (ret != VIDEO_DECODER_SUCCESS) {
         *filledLen = 0;
-        (void) StopDecoder();
-        return VIDEO_DECODER_DECODE_FAIL;
+        return ret;
     }
+    return DecoderHandleData(buffer, maxLen, filledLen);
+}
 
-    auto deviceSessionRead = reinterpret_cast<NiDeviceSessionReadFunc>(g_funcMap[NI_DEVICE_SESSION_READ]);
-    // 从netint获取解码后数据
-    int rxSize = (*deviceSessionRead)(&m_sessionCtx, &m_frame, NI_LOGAN_DEVICE_TYPE_DECODER);
+DecoderRetCode VideoDecoderNetint::DecoderReadFrame()
+{
+    if (m_framePending) {
+        // 分辨率变化时保留的帧，重新检查配置后交付
+        return VIDEO_DECODER_SUCCESS;
+    }
+    if (m_session == nullptr) {
+        // 尚未收到首包数据时会话未打开；打开失败时返回与写入相同的错误
+        return m_sessionOpenFailed ? VIDEO_DECODER_START_FAIL : VIDEO_DECODER_READ_UNDERFLOW;
+    }
+    if (m_asyncMode) {
+        return PopQueuedFrame();
+    }
 
+    // 从netint获取解码后数据
+    int rxSize = ReadDeviceFrame(m_frame);
     if (rxSize < 0) {
         ALOGE("decoder read data: receiving data error. rxSize:%d", rxSize);
-        auto decoderFrameBufferFree =
-            reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
-        (void) (*decoderFrameBufferFree)(&(m_frame.data.frame));
-        *filledLen = 0;
+        m_sessionBroken = true;
         (void) StopDecoder();
         return VIDEO_DECODER_DECODE_FAIL;
     }
 
     if (rxSize == 0) {
-        ALOGW("decoder read data: no decoded frame is available now. rxSize:%d", rxSize);
-        auto decoderFrameBufferFree =
-            reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
-        (void) (*decoderFrameBufferFree)(&(m_frame.data.frame));
-        *filledLen = 0;
-
+        ALOGW_LIMITED("decoder read data: no decoded frame is available now. rxSize:%d", rxSize);
         if (m_frame.data.frame.end_of_stream == 1) {
             ALOGI("decoder read data: frame end of stream is 1, rxSize is 0.");
             return VIDEO_DECODER_EOS;
@@ -660,37 +1242,244 @@ DecoderRetCode VideoDecoderNetint::DecoderReadData(uint8_t *buffer, const uint32
     // 增加计数位置
     m_frameCount++;
     DecodeFpsStat();
+    return VIDEO_DECODER_SUCCESS;
+}
 
-    return DecoderHandleData(buffer, maxLen, filledLen);
+int VideoDecoderNetint::ReadDeviceFrame(ni_logan_session_data_io_t &frameData)
+{
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    if (!InitFrameData(frameData)) {
+        return NI_LOGAN_RETCODE_FAILURE;
+    }
+
+    auto deviceSessionRead = reinterpret_cast<NiDeviceSessionReadFunc>(g_funcMap[NI_DEVICE_SESSION_READ]);
+    int rxSize = (*deviceSessionRead)(&m_session->sessionCtx, &frameData, NI_LOGAN_DEVICE_TYPE_DECODER);
+    if (rxSize < 0) {
+        auto decoderFrameBufferFree =
+            reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
+        (void) (*decoderFrameBufferFree)(&(frameData.data.frame));
+    }
+    return rxSize;
+}
+
+void VideoDecoderNetint::StartReader()
+{
+    if (m_frameQueue == nullptr || m_frameQueue->Capacity() != m_queueDepth) {
+        m_frameQueue = std::make_unique<SpscQueue<ni_logan_frame_t>>(m_queueDepth);
+    }
+    m_readerEos = false;
+    m_readerError = false;
+    m_readerRunning = true;
+    m_reader = std::thread(&VideoDecoderNetint::ReaderLoop, this);
+    ALOGI("decoder reader started, queue depth %u", m_queueDepth);
+}
+
+void VideoDecoderNetint::StopReader()
+{
+    if (!m_reader.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_readerRunning = false;
+    }
+    m_queueCond.notify_all();
+    m_reader.join();
+
+    auto decoderFrameBufferFree =
+        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
+    ni_logan_frame_t frame {};
+    uint32_t dropped = 0;
+    while (m_frameQueue->TryPop(frame)) {
+        (void) (*decoderFrameBufferFree)(&frame);
+        ++dropped;
+    }
+    ALOGI("decoder reader stopped, %u queued frames dropped", dropped);
+}
+
+void VideoDecoderNetint::ReaderLoop()
+{
+    ni_logan_session_data_io_t frameData {};
+    while (m_readerRunning) {
+        // 队列满时暂停读取，设备侧的解码帧随之积压，写入端收到WRITE_OVERFLOW
+        if (m_frameQueue->Size() >= m_frameQueue->Capacity()) {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            (void) m_queueCond.wait_for(lock, READ_POLL_INTERVAL, [this]() {
+                return !m_readerRunning || m_frameQueue->Size() < m_frameQueue->Capacity();
+            });
+            continue;
+        }
+
+        int rxSize = ReadDeviceFrame(frameData);
+        if (rxSize < 0) {
+            ALOGE("decoder reader: receiving data error. rxSize:%d", rxSize);
+            m_readerError = true;
+            break;
+        }
+        if (rxSize == 0) {
+            if (frameData.data.frame.end_of_stream == 1) {
+                ALOGI("decoder reader: frame end of stream is 1, rxSize is 0.");
+                m_readerEos = true;
+                break;
+            }
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            (void) m_queueCond.wait_for(lock, READ_POLL_INTERVAL, [this]() { return !m_readerRunning; });
+            continue;
+        }
+
+        // 帧缓冲交给队列，frameData下次读取时重新申请
+        (void) m_frameQueue->TryPush(frameData.data.frame);
+        frameData = {};
+        uint32_t queued = m_frameQueue->Size();
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+        }
+        m_queueCond.notify_all();
+        if (m_eventCallBack) {
+            m_eventCallBack(INDEX_FRAME_AVAILABLE, queued, nullptr);
+        }
+    }
+    auto decoderFrameBufferFree =
+        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
+    (void) (*decoderFrameBufferFree)(&(frameData.data.frame));
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+    }
+    m_queueCond.notify_all();
+}
+
+DecoderRetCode VideoDecoderNetint::PopQueuedFrame()
+{
+    ni_logan_frame_t frame {};
+    if (!m_frameQueue->TryPop(frame)) {
+        if (m_readerError) {
+            m_sessionBroken = true;
+            (void) StopDecoder();
+            return VIDEO_DECODER_DECODE_FAIL;
+        }
+        return m_readerEos ? VIDEO_DECODER_EOS : VIDEO_DECODER_READ_UNDERFLOW;
+    }
+    if (m_frameQueue->Size() + 1 >= m_frameQueue->Capacity()) {
+        // 队列由满变为不满，唤醒等待空位的读取线程
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+        }
+        m_queueCond.notify_all();
+    }
+
+    // 上一帧因分辨率变化未取走时先归还其缓冲
+    auto decoderFrameBufferFree =
+        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
+    (void) (*decoderFrameBufferFree)(&(m_frame.data.frame));
+    m_frame.data.frame = frame;
+    m_frameCount++;
+    DecodeFpsStat();
+    return VIDEO_DECODER_SUCCESS;
+}
+
+void VideoDecoderNetint::WaitForFrame(std::chrono::steady_clock::time_point deadline, bool infinite)
+{
+    if (!m_asyncMode || !m_reader.joinable()) {
+        std::this_thread::sleep_for(infinite ? READ_POLL_INTERVAL :
+            std::min<std::chrono::steady_clock::duration>(READ_POLL_INTERVAL,
+                deadline - std::chrono::steady_clock::now()));
+        return;
+    }
+    auto frameReady = [this]() {
+        return m_frameQueue->Size() > 0 || !m_readerRunning || m_readerEos || m_readerError;
+    };
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    if (infinite) {
+        m_queueCond.wait(lock, frameReady);
+    } else {
+        (void) m_queueCond.wait_until(lock, deadline, frameReady);
+    }
+}
+
+bool VideoDecoderNetint::PicSizeMatches() const
+{
+    const ni_logan_frame_t &frame = m_frame.data.frame;
+    return frame.crop_right - frame.crop_left == m_displayWidth && frame.crop_bottom - frame.crop_top == m_displayHeight;
+}
+
+bool VideoDecoderNetint::CheckPicSizeChange()
+{
+    ni_logan_frame_t &frame = m_frame.data.frame;
+    uint32_t planeWidth = AlignUp(frame.video_width, NETINT_WIDTH_ALIGN);
+    uint32_t planeHeight = frame.video_height;
+    if (frame.crop_right <= frame.crop_left || frame.crop_bottom <= frame.crop_top) {
+        // 未提供裁剪区域时按整个平面显示
+        frame.crop_left = 0;
+        frame.crop_top = 0;
+        frame.crop_right = frame.video_width;
+        frame.crop_bottom = frame.video_height;
+    }
+    if (planeWidth != m_planeWidth || planeHeight != m_planeHeight) {
+        ALOGI("decoded plane %ux%u, crop %ux%u", planeWidth, planeHeight, frame.crop_right - frame.crop_left,
+            frame.crop_bottom - frame.crop_top);
+    }
+    m_planeWidth = planeWidth;
+    m_planeHeight = planeHeight;
+
+    if (PicSizeMatches()) {
+        m_framePending = false;
+        m_picChangeNotified = false;
+        return false;
+    }
+    m_framePending = true;
+    if (m_picChangeNotified) {
+        return true;
+    }
+    m_picChangeNotified = true;
+    PicInfoParams decParams = {
+        .width = m_planeWidth,
+        .height = m_planeHeight,
+        .stride = static_cast<int32_t>(m_planeWidth),
+        .scanLines = m_planeHeight,
+        .cropWidth = frame.crop_right - frame.crop_left,
+        .cropHeight = frame.crop_bottom - frame.crop_top,
+        .planeWidth = m_planeWidth,
+        .planeHeight = m_planeHeight
+    };
+    ALOGI("picture size changed to %ux%u, crop %ux%u, hold the frame until reconfigured.",
+        m_planeWidth, m_planeHeight, decParams.cropWidth, decParams.cropHeight);
+    if (m_eventCallBack) {
+        m_eventCallBack(INDEX_PIC_INFO_CHANGE, 0, &decParams);
+    }
+    // 上层在回调中已重新配置时直接交付
+    if (PicSizeMatches()) {
+        m_framePending = false;
+        m_picChangeNotified = false;
+        return false;
+    }
+    return true;
 }
 
 DecoderRetCode VideoDecoderNetint::DecoderHandleData(uint8_t *buffer, const uint32_t maxLen, uint32_t *filledLen)
 {
     uint8_t *dst = reinterpret_cast<uint8_t *>(m_frame.data.frame.p_data);
-    m_planeWidth = AlignUp(m_frame.data.frame.video_width, NETINT_WIDTH_ALIGN);
-    m_planeHeight = m_frame.data.frame.video_height;
-
-    if (m_planeWidth != m_writeWidth || m_planeHeight != m_writeHeight) {
-        PicInfoParams decParams = {
-            .width = m_planeWidth,
-            .height = m_planeHeight,
-            .stride = static_cast<int32_t>(m_planeWidth),
-            .scanLines = m_planeHeight,
-            .cropWidth = m_frame.data.frame.crop_right,
-            .cropHeight = m_frame.data.frame.crop_bottom
-        };
-        ALOGI("decoder handle data, plane width is %u, plane height is %u", m_planeWidth, m_planeHeight);
-        m_eventCallBack(INDEX_PIC_INFO_CHANGE, 0, &decParams);
+    if (CheckPicSizeChange()) {
         return VIDEO_DECODER_BAD_PIC_SIZE;
     }
 
-    PicInfoParams params = {m_writeWidth, m_writeHeight, m_stride, m_writeHeight};
-    auto convertSize = m_copyFrame(dst, buffer, params, maxLen);
+    uint32_t convertSize = 0;
+    if (m_outputFormat == PIXEL_FORMAT_YUV_420P || m_outputFormat == PIXEL_FORMAT_FLEX_YUV_420P) {
+        // 钩子按配置的分辨率拷贝，仅对齐填充不同时解码帧平面的实际尺寸另行提供
+        PicInfoParams params = {m_writeWidth, m_writeHeight, m_stride, m_writeHeight};
+        params.planeWidth = m_planeWidth;
+        params.planeHeight = m_planeHeight;
+        convertSize = m_copyFrame(dst, buffer, params, maxLen);
+    } else {
+        convertSize = ConvertFrame(buffer, maxLen);
+    }
     *filledLen = convertSize;
 
-    auto decoderFrameBufferFree =
-        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
-    (void) (*decoderFrameBufferFree)(&(m_frame.data.frame));
+    // 帧已拷贝出去，buffer保留给下次读取
+    if (convertSize == 0) {
+        ALOGE_LIMITED("decoder handle data: convert to format %u failed, stride:%d, max len:%u",
+            m_outputFormat, m_stride, maxLen);
+        return VIDEO_DECODER_DECODE_FAIL;
+    }
 
     if (m_frame.data.frame.end_of_stream == 1) {
         ALOGI("Receiving data end! frame end of stream is %u", m_frame.data.frame.end_of_stream);
@@ -699,98 +1488,191 @@ DecoderRetCode VideoDecoderNetint::DecoderHandleData(uint8_t *buffer, const uint
     return VIDEO_DECODER_SUCCESS;
 }
 
-void VideoDecoderNetint::DestroyContext()
+FrameConverter::SourceFrame VideoDecoderNetint::GetSourceFrame() const
 {
-    ALOGI("destroy context.");
-
-    auto deviceSessionFlush = reinterpret_cast<NiDeviceSessionFlushFunc>(g_funcMap[NI_DEVICE_SESSION_FLUSH]);
-    auto deviceSessionClose = reinterpret_cast<NiDeviceSessionCloseFunc>(g_funcMap[NI_DEVICE_SESSION_CLOSE]);
-
-    (void) (*deviceSessionFlush)(&m_sessionCtx, NI_LOGAN_DEVICE_TYPE_DECODER);
-    (void) (*deviceSessionClose)(&m_sessionCtx, 1, NI_LOGAN_DEVICE_TYPE_DECODER);
-
-    if (m_devCtx != nullptr) {
-        ALOGI("destroy rsrc start.");
-        auto rsrcReleaseResource = reinterpret_cast<NiRsrcReleaseResourceFunc>(g_funcMap[NI_RSRC_RELEASE_RESOURCE]);
-        auto rsrcFreeDeviceContext =
-            reinterpret_cast<NiRsrcFreeDeviceContextFunc>(g_funcMap[NI_RSRC_FREE_DEVICE_CONTEXT]);
-        (*rsrcReleaseResource)(m_devCtx, m_codec, m_load);
-        (*rsrcFreeDeviceContext)(m_devCtx);
+    // 解码帧为I420，亮度宽度按NETINT_WIDTH_ALIGN对齐，色度平面跨距为亮度的一半
+    FrameConverter::SourceFrame source;
+    uint32_t lumaStride = m_planeWidth * static_cast<uint32_t>(m_session->sessionCtx.bit_depth_factor);
+    for (uint32_t i = 0; i < FrameConverter::PLANE_NUM; ++i) {
+        source.planes[i] = static_cast<const uint8_t *>(m_frame.data.frame.p_data[i]);
+        source.strides[i] = (i == 0) ? lumaStride : lumaStride / 2;    // 2: 色度水平下采样
+    }
+    source.width = m_frame.data.frame.crop_right - m_frame.data.frame.crop_left;
+    source.height = m_frame.data.frame.crop_bottom - m_frame.data.frame.crop_top;
+    return source;
+}
 
-        m_devCtx = nullptr;
-        ALOGI("destroy rsrc done.");
+uint32_t VideoDecoderNetint::ConvertFrame(uint8_t *buffer, uint32_t maxLen)
+{
+    if (m_stride <= 0) {
+        return 0;
     }
+    FrameConverter::SourceFrame source = GetSourceFrame();
+    uint32_t stride = static_cast<uint32_t>(m_stride);
+    switch (m_outputFormat) {
+        case PIXEL_FORMAT_NV12:
+            return FrameConverter::ToSemiPlanar(source, buffer, stride, m_writeHeight, maxLen, false);
+        case PIXEL_FORMAT_NV21:
+            return FrameConverter::ToSemiPlanar(source, buffer, stride, m_writeHeight, maxLen, true);
+        case PIXEL_FORMAT_RGBA_8888:
+            // RGBA的跨距以像素为单位
+            return FrameConverter::ToRgba(source, buffer, stride, maxLen);
+        default:
+            return 0;
+    }
+}
 
-    auto packetBufferFree = reinterpret_cast<NiPacketBufferFreeFunc>(g_funcMap[NI_PACKET_BUFFER_FREE]);
+DecoderRetCode VideoDecoderNetint::DecoderHandoutFrame(DecodedFrame &frame)
+{
     auto decoderFrameBufferFree =
         reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
-    auto deviceClose = reinterpret_cast<NiDeviceCloseFunc>(g_funcMap[NI_DEVICE_CLOSE]);
+    ni_logan_frame_t &decFrame = m_frame.data.frame;
+    auto *handout = new (std::nothrow) ni_logan_frame_t(decFrame);
+    if (handout == nullptr) {
+        ALOGE("handout frame, alloc frame failed.");
+        (void) (*decoderFrameBufferFree)(&decFrame);
+        return VIDEO_DECODER_DECODE_FAIL;
+    }
+    // 帧缓冲改由handout持有，m_frame下次读取时重新申请
+    decFrame.p_buffer = nullptr;
+    decFrame.buffer_size = 0;
+    decFrame.dec_buf = nullptr;
+    std::fill_n(decFrame.p_data, NI_LOGAN_MAX_NUM_DATA_POINTERS, nullptr);
+    std::fill_n(decFrame.data_len, NI_LOGAN_MAX_NUM_DATA_POINTERS, 0);
+
+    // 释放时先将缓冲归还所在缓冲池，再释放FrameOwner引用，必要时关闭会话
+    std::shared_ptr<FrameOwner> owner = m_frameOwner;
+    frame.buffer = std::shared_ptr<void>(handout, [owner, decoderFrameBufferFree](void *data) {
+        auto *heldFrame = static_cast<ni_logan_frame_t *>(data);
+        (void) (*decoderFrameBufferFree)(heldFrame);
+        delete heldFrame;
+    });
+
+    // 解码帧为I420，亮度宽度按NETINT_WIDTH_ALIGN对齐，色度平面跨距为亮度的一半
+    int32_t lumaStride = static_cast<int32_t>(m_planeWidth) * m_session->sessionCtx.bit_depth_factor;
+    for (uint32_t i = 0; i < DecodedFrame::PLANE_NUM; ++i) {
+        frame.planes[i] = static_cast<uint8_t *>(handout->p_data[i]);
+        frame.strides[i] = (i == 0) ? lumaStride : lumaStride / 2;    // 2: 色度水平下采样
+    }
+    frame.width = m_planeWidth;
+    frame.height = m_planeHeight;
+    frame.cropLeft = handout->crop_left;
+    frame.cropTop = handout->crop_top;
+    frame.cropWidth = handout->crop_right - handout->crop_left;
+    frame.cropHeight = handout->crop_bottom - handout->crop_top;
+    frame.bitDepth = static_cast<uint32_t>(m_bitDepth);
+    frame.format = PIXEL_FORMAT_YUV_420P;
+
+    if (handout->end_of_stream == 1) {
+        ALOGI("Receiving data end! frame end of stream is %u", handout->end_of_stream);
+        return VIDEO_DECODER_EOS;
+    }
+    return VIDEO_DECODER_SUCCESS;
+}
 
-    (void) (*packetBufferFree)(&(m_packet.data.packet));
+void VideoDecoderNetint::DestroyContext()
+{
+    ALOGI("destroy context.");
+
+    // 预留的帧缓冲属于会话的缓冲池，先于会话释放
+    auto decoderFrameBufferFree =
+        reinterpret_cast<NiDecoderFrameBufferFreeFunc>(g_funcMap[NI_DECODER_FRAME_BUFFER_FREE]);
     (void) (*decoderFrameBufferFree)(&(m_frame.data.frame));
-    (*deviceClose)(m_sessionCtx.device_handle);
-    (*deviceClose)(m_sessionCtx.blk_io_handle);
+
+    if (m_session != nullptr) {
+        // 正常结束的会话清空解码状态后归还会话池，出错或已收到EOS的会话直接关闭
+        SessionPool<NetintDecoderSession> &pool = GetSessionPool();
+        // 仍有已交出的解码帧时会话不能交给其他解码器
+        bool reusable = !m_sessionBroken && m_session->sessionCtx.ready_to_close == 0 && pool.GetCapacity() > 0 &&
+            m_frameOwner.use_count() <= 1;
+        if (reusable) {
+            auto deviceDecSessionFlush =
+                reinterpret_cast<NiDeviceDecSessionFlushFunc>(g_funcMap[NI_DEVICE_DEC_SESSION_FLUSH]);
+            reusable = (*deviceDecSessionFlush)(&m_session->sessionCtx) == NI_LOGAN_RETCODE_SUCCESS;
+        }
+        if (reusable) {
+            pool.Release(m_sessionKey, std::move(m_session));
+        } else {
+            CloseCurrentSession();
+        }
+        m_session.reset();
+    }
+    m_frameOwner.reset();
+
+    ResetPacket();
+    m_packetBuffer.reset();
+    m_packetBufferSize = 0;
+    m_poolWidth = 0;
+    m_poolHeight = 0;
 
     ALOGI("destroy context done.");
 }
 
 int VideoDecoderNetint::DeviceDecSessionWrite()
 {
-    uint8_t streamHeaders[4 * 1024];   // 4 * 1024：4K足够大的内存存储码流头信息
-    uint8_t *hdr = streamHeaders;
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
     uint8_t *buf = reinterpret_cast<uint8_t *>(m_packet.data.packet.p_data);
     uint32_t dataSize = m_packet.data.packet.data_len;
+    bool h264 = (m_session->sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H264);
     int nalType = -1;
-    int headerSize = 0;
     bool spsFound = false;
     bool ppsFound = false;
     bool vpsFound = false;
-    bool headersFound = false;
+    m_headerScratch.clear();
 
-    // parse the packet and when SPS/PPS/VPS are found, save/update the stream
-    // header info; stop searching as soon as VCL is encountered
-    int nalSize = FindNextNonVclNalu(std::pair<uint8_t*, uint32_t>(buf, dataSize), m_sessionCtx.codec_format, nalType);
+    // parse the packet and collect SPS/PPS/VPS until a complete set is found;
+    // stop searching as soon as VCL is encountered
+    int nalSize = FindNextNonVclNalu(std::pair<uint8_t*, uint32_t>(buf, dataSize), m_session->sessionCtx.codec_format, nalType);
     while (dataSize > NAL_START_CODE_MIN_LEN && nalSize > 0) {
-        if (m_sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H264) {
-            spsFound = (spsFound || (nalType == static_cast<int>(H264NaluType::SPS)));
-            ppsFound = (ppsFound || (nalType == static_cast<int>(H264NaluType::PPS)));
-            headersFound = (headersFound || (spsFound && ppsFound));
-        } else if (m_sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H265) {
-            vpsFound = (vpsFound || (nalType == static_cast<int>(H265NaluType::VPS)));
-            spsFound = (spsFound || (nalType == static_cast<int>(H265NaluType::SPS)));
-            ppsFound = (ppsFound || (nalType == static_cast<int>(H265NaluType::PPS)));
-            headersFound = (headersFound || (vpsFound && spsFound && ppsFound));
-        }
-
-        if ((m_sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H264 &&
-            (nalType == static_cast<int>(H264NaluType::SPS) || nalType == static_cast<int>(H264NaluType::PPS))) ||
-            (m_sessionCtx.codec_format == NI_LOGAN_CODEC_FORMAT_H265 &&
-            (nalType == static_cast<int>(H265NaluType::VPS) || nalType == static_cast<int>(H265NaluType::SPS) ||
-            nalType == static_cast<int>(H265NaluType::PPS)))) {
-            headerSize += nalSize;
-            (void)std::copy_n(buf, nalSize, hdr);
-            hdr += nalSize;
+        bool isSps = nalType == (h264 ? static_cast<int>(H264NaluType::SPS) : static_cast<int>(H265NaluType::SPS));
+        bool isPps = nalType == (h264 ? static_cast<int>(H264NaluType::PPS) : static_cast<int>(H265NaluType::PPS));
+        bool isVps = !h264 && nalType == static_cast<int>(H265NaluType::VPS);
+        spsFound = spsFound || isSps;
+        ppsFound = ppsFound || isPps;
+        vpsFound = vpsFound || isVps;
+        if (isSps || isPps || isVps) {
+            m_headerScratch.insert(m_headerScratch.end(), buf, buf + nalSize);
         }
 
         buf += nalSize;
-        dataSize -= nalSize;
-
-        if (headersFound) {
-            auto deviceDecSessionSaveHdrs =
-                reinterpret_cast<NiDeviceDecSessionSaveHdrsFunc>(g_funcMap[NI_DEVICE_DEC_SESSION_SAVE_HDRS]);
-            ni_logan_retcode_t ret = (*deviceDecSessionSaveHdrs)(&m_sessionCtx, streamHeaders, headerSize);
-            if (ret != NI_LOGAN_RETCODE_SUCCESS) {
-                ALOGE("DeviceDecSessionWrite save hdrs failed: %d", ret);
-            }
+        dataSize -= static_cast<uint32_t>(nalSize);
+
+        if (spsFound && ppsFound && (h264 || vpsFound)) {
+            SaveStreamHeaders();
             break;
         }
-        nalSize = FindNextNonVclNalu(std::pair<uint8_t*, uint32_t>(buf, dataSize), m_sessionCtx.codec_format, nalType);
+        nalSize = FindNextNonVclNalu(std::pair<uint8_t*, uint32_t>(buf, dataSize), m_session->sessionCtx.codec_format, nalType);
     }
     auto deviceSessionWrite = reinterpret_cast<NiDeviceSessionWriteFunc>(g_funcMap[NI_DEVICE_SESSION_WRITE]);
-    int txSize = (*deviceSessionWrite)(&m_sessionCtx, &m_packet, NI_LOGAN_DEVICE_TYPE_DECODER);
+    int txSize = (*deviceSessionWrite)(&m_session->sessionCtx, &m_packet, NI_LOGAN_DEVICE_TYPE_DECODER);
     return txSize;
 }
 
+void VideoDecoderNetint::SaveStreamHeaders()
+{
+    // 编码器通常在每个IDR前重复发送相同的参数集，仅在内容变化时更新
+    if (m_headerScratch != m_streamHeaders) {
+        m_streamHeaders = m_headerScratch;
+    }
+    if (m_headerScratch == m_session->savedHeaders) {
+        return;
+    }
+    m_session->savedHeaders = m_headerScratch;
+    // ni_logan_device_dec_session_save_hdrs的长度参数为uint8_t，更长的参数集只随码流发送
+    if (m_headerScratch.size() > UINT8_MAX) {
+        ALOGW("stream headers size %zu exceeds %u, not saved to session.", m_headerScratch.size(), UINT8_MAX);
+        return;
+    }
+    auto deviceDecSessionSaveHdrs =
+        reinterpret_cast<NiDeviceDecSessionSaveHdrsFunc>(g_funcMap[NI_DEVICE_DEC_SESSION_SAVE_HDRS]);
+    ni_logan_retcode_t ret = (*deviceDecSessionSaveHdrs)(&m_session->sessionCtx, m_headerScratch.data(),
+        static_cast<uint8_t>(m_headerScratch.size()));
+    if (ret != NI_LOGAN_RETCODE_SUCCESS) {
+        ALOGE("DeviceDecSessionWrite save hdrs failed: %d", ret);
+        m_session->savedHeaders.clear();
+    }
+}
+
 int VideoDecoderNetint::FindNextNonVclNalu(std::pair<uint8_t*, uint32_t> inBuf, uint32_t codec, int &nalType)
 {
     uint8_t *inData = inBuf.first;
@@ -811,6 +1693,9 @@ int VideoDecoderNetint::FindNextNonVclNalu(std::pair<uint8_t*, uint32_t> inBuf,
         i++;
     }
     i += NAL_START_CODE_MIN_LEN;
+    if (static_cast<uint32_t>(i) >= inSize) {
+        return 0;
+    }
 
     // get the NAL type
     if (codec == NI_LOGAN_CODEC_FORMAT_H264) {
@@ -820,43 +1705,25 @@ int VideoDecoderNetint::FindNextNonVclNalu(std::pair<uint8_t*, uint32_t> inBuf,
             return 0;
         }
     } else if (codec == NI_LOGAN_CODEC_FORMAT_H265) {
-        nalType = (inData[i] >> 1);
+        nalType = ((inData[i] >> 1) & 0x3f);
+        if (nalType <= static_cast<int>(H265NaluType::RSV_VCL31)) {
+            return 0;
+        }
     } else {
         ALOGE("Codec format is invalid");
         return 0;
     }
 
-    // advance to the end of NAL or stream
-    while ((inData[i + NAL_START_CODE_1ST_BYTE] != 0x00 || inData[i + NAL_START_CODE_2ST_BYTE] != 0x00 ||
-        inData[i + NAL_START_CODE_3ST_BYTE] != 0x00) &&
-        (inData[i + NAL_START_CODE_1ST_BYTE] != 0x00 || inData[i + NAL_START_CODE_2ST_BYTE] != 0x00 ||
-        inData[i + NAL_START_CODE_3ST_BYTE] != 0x01)) {
-        i++;
-        // if reaching/passing the stream end, return the whole data chunk size
-        if (i + NAL_START_CODE_MIN_LEN > inSize) {
-            return inSize;
-        }
-    }
-
-    return i;
+    // advance to the next 0x000000/0x000001, or return the whole data chunk size at the stream end
+    return static_cast<int>(StartCodeScanner::FindNalEnd(inData, inSize, static_cast<size_t>(i)));
 }
 
 int VideoDecoderNetint::FindNalStartCode(std::pair<uint8_t*, uint32_t> &inBuf)
 {
-    uint8_t *inData = inBuf.first;
-    uint32_t inSize = inBuf.second;
-    int i = 0;
     // search for start code 0x000001 or 0x00000001
-    while ((inData[i + NAL_START_CODE_1ST_BYTE] != 0x00 || inData[i + NAL_START_CODE_2ST_BYTE] != 0x00 ||
-        inData[i + NAL_START_CODE_3ST_BYTE] != 0x01) &&
-        (inData[i + NAL_START_CODE_1ST_BYTE] != 0x00 || inData[i + NAL_START_CODE_2ST_BYTE] != 0x00 ||
-        inData[i + NAL_START_CODE_3ST_BYTE] != 0x00 || inData[i + NAL_START_CODE_4ST_BYTE] != 0x01)) {
-        i++;
-        if (i + NAL_START_CODE_MIN_LEN > inSize) {
-            return -1;
-        }
-    }
-    return i;
+    size_t codeLen = 0;
+    size_t pos = StartCodeScanner::FindStartCode(inBuf.first, inBuf.second, 0, codeLen);
+    return (pos >= inBuf.second) ? -1 : static_cast<int>(pos);
 }
 
 } // namespace MediaCore
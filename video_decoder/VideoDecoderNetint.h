@@ -5,11 +5,36 @@
 #define VIDEO_DECODER_NETINT_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "VideoDecoder.h"
+#include "SessionPool.h"
+#include "SpscQueue.h"
+#include "DeviceScheduler.h"
+#include "FrameConverter.h"
 #include "ni_device_api_logan.h"
 #include "ni_rsrc_api_logan.h"
 
 namespace MediaCore {
+// NETINT解码会话：资源上下文、设备句柄与已打开的固件会话，可在会话池中复用
+struct NetintDecoderSession {
+    ni_logan_session_context_t sessionCtx {};
+    ni_logan_encoder_params_t decApiParams {};  // 会话配置，sessionCtx.p_session_config指向该成员
+    ni_logan_device_context_t *devCtx = nullptr;
+    ni_codec_t codec = EN_H264;
+    unsigned long load = 0;
+    int guid = -1;               // 所在设备
+    uint64_t pixelRate = 0;      // 宽 × 高 × 帧率
+    uint32_t loadPercent = 0;    // 打开会话时计入设备负载的值，关闭时扣除
+    std::vector<uint8_t> savedHeaders {};   // 已通过save_hdrs保存到会话的码流头信息
+};
+
 class VideoDecoderNetint : public VideoDecoder {
 public:
     VideoDecoderNetint() = default;
@@ -19,6 +44,10 @@ public:
     DecoderRetCode InitDecoder() override;
     DecoderRetCode SendStreamData(uint8_t *buffer, uint32_t filledLen) override;
     DecoderRetCode RetrieveFrameData(uint8_t *buffer, uint32_t maxLen, uint32_t *filledLen) override;
+    DecoderRetCode RetrieveFrameData(uint8_t *buffer, uint32_t maxLen, uint32_t *filledLen,
+        int32_t timeoutMs) override;
+    DecoderRetCode AcquireFrame(DecodedFrame *frame) override;
+    DecoderRetCode ReleaseFrame(DecodedFrame *frame) override;
     DecoderRetCode SetCallbacks(std::function<void(DecodeEventIndex, uint32_t, void *)> eventCallBack) override;
     DecoderRetCode SetCopyFrameFunc(
         std::function<uint32_t(uint8_t*, uint8_t*, const PicInfoParams &, uint32_t)> copyFrame) override;
@@ -42,19 +71,99 @@ private:
      */
     bool LoadNetintSharedLib() const;
 
+    // 打开会话所需的配置，在会话池预热线程中使用，不引用解码器成员
+    struct SessionConfig {
+        ni_codec_t codec;
+        uint32_t width;
+        uint32_t height;
+        int frameRate;
+        int bitDepth;
+        int guid = -1;   // 指定设备，-1时按调度策略选卡
+    };
+
+    // 已交出解码帧的归属，每个会话一个，解码帧视图持有其引用；会话结束时仍有帧未归还则由其接管会话，
+    // 最后一帧归还后关闭，保证帧缓冲所在的缓冲池有效
+    struct FrameOwner {
+        std::unique_ptr<NetintDecoderSession> session = nullptr;
+        ~FrameOwner();
+    };
+
     /**
-     * @功能描述: 初始化解码器资源
+     * @功能描述: 初始化解码器资源，优先从会话池取出已打开的会话
      * @返回值: true  成功
      *          false 失败
      */
     bool InitContext();
 
     /**
-     * @功能描述: 初始化解码器上下文参数
+     * @功能描述: 首包数据到达时解析其中的参数集，按码流的分辨率、位深与帧率打开会话；码流尺寸与配置不一致时
+     *            在解码前通知上层，首帧无需等待重新配置；首包中没有参数集时按配置的尺寸打开
+     * @参数 [in] buffer: 首包数据
+     * @参数 [in] filledLen: 数据长度
+     * @返回值: VIDEO_DECODER_SUCCESS 成功
+     *          VIDEO_DECODER_START_FAIL 输出格式不支持码流位深或打开会话失败
+     */
+    DecoderRetCode OpenSessionForStream(const uint8_t *buffer, uint32_t filledLen);
+
+    /**
+     * @功能描述: 初始化解码器上下文参数，分配设备资源、打开设备句柄并打开解码会话
+     * @参数 [in] config: 会话配置
+     * @返回值: 已打开的会话，失败时返回nullptr
+     */
+    static std::unique_ptr<NetintDecoderSession> OpenSession(const SessionConfig &config);
+
+    /**
+     * @功能描述: 关闭解码会话、设备句柄并释放设备资源，可用于部分打开的会话
+     * @参数 [in] session: 会话
+     */
+    static void CloseSession(NetintDecoderSession &session);
+
+    /**
+     * @功能描述: 读取本机各解码设备的负载
+     * @返回值: 各卡负载，按guid排列
+     */
+    static std::vector<DeviceLoad> CollectDeviceLoads();
+
+    /**
+     * @功能描述: 为会话分配设备资源：按调度策略选卡，无法选卡或分配失败时回退为自动分配
+     * @参数 [in] session: 会话
+     * @参数 [in] config: 会话配置
      * @返回值: true  成功
      *          false 失败
      */
-    bool InitCtxParams();
+    static bool AllocateDevice(NetintDecoderSession &session, const SessionConfig &config);
+
+    /**
+     * @功能描述: 更新会话所在设备的负载，解码设备不按分辨率统计负载，由此计入帧率 × 分辨率
+     * @参数 [in] session: 会话
+     * @参数 [in] add: true 计入会话负载，false 扣除会话负载
+     */
+    static void PublishDeviceLoad(NetintDecoderSession &session, bool add);
+
+    /**
+     * @功能描述: 重置时检查设备负载是否失衡，失衡超过阈值时在负载最低的设备上重新打开会话，
+     *            下一包数据前补发已保存的码流头信息
+     * @返回值: true  已迁移
+     *          false 无需迁移或迁移失败，继续使用原会话
+     */
+    bool MigrateSession();
+
+    /**
+     * @功能描述: 生成会话池键，按编解码类型、分辨率档位与位深区分
+     * @参数 [in] config: 会话配置
+     */
+    static std::string SessionKey(const SessionConfig &config);
+
+    /**
+     * @功能描述: 获取进程级解码会话池
+     */
+    static SessionPool<NetintDecoderSession> &GetSessionPool();
+
+    /**
+     * @功能描述: 获取会话池空闲会话数量上限配置
+     * @返回值: 空闲会话数量上限，未配置或非法时为0（不缓存会话）
+     */
+    static uint32_t GetSessionPoolSize();
 
     /**
      * @功能描述: 预处理解码前的数据包，将数据写入netint
@@ -66,11 +175,84 @@ private:
     int InitPacketData(const uint8_t *src, const uint32_t inputSize);
 
     /**
-     * @功能描述: 预处理解码后的帧数据，申请帧数据buffer
+     * @功能描述: 确保常驻数据包缓冲不小于指定大小，缓冲按设备要求对齐，只增不减
+     * @参数 [in] size 所需大小
      * @返回值: true  成功
      *          false 失败
      */
-    bool InitFrameData();
+    bool ReservePacketBuffer(uint32_t size);
+
+    /**
+     * @功能描述: 待发送的数据包直接引用调用方缓冲时，将其拷贝到常驻数据包缓冲，以便调用方返回后重发
+     * @返回值: true  成功
+     *          false 失败
+     */
+    bool DetachPacketData();
+
+    /**
+     * @功能描述: 清空待发送的数据包，常驻数据包缓冲保留复用
+     */
+    void ResetPacket();
+
+    /**
+     * @功能描述: 预处理解码后的帧数据，申请帧数据buffer，已持有同分辨率的buffer时直接复用
+     * @参数 [in] frameData 帧数据
+     * @返回值: true  成功
+     *          false 失败
+     */
+    bool InitFrameData(ni_logan_session_data_io_t &frameData);
+
+    /**
+     * @功能描述: 从会话的帧缓冲池预先取出指定深度的缓冲并逐页写入触发缺页，再全部归还缓冲池，
+     *            之后读取解码帧时直接复用池中缓冲；同一分辨率只预留一次，缓冲池尚未创建时跳过
+     * @参数 [in] width: 帧宽度
+     * @参数 [in] height: 帧高度
+     */
+    void ReserveFramePool(uint32_t width, uint32_t height);
+
+    /**
+     * @功能描述: 获取帧缓冲池的预留深度
+     * @返回值: 预留的帧缓冲数
+     */
+    uint32_t FramePoolDepth() const;
+
+    /**
+     * @功能描述: 申请帧数据buffer并从netint读取一帧，未读到帧时保留buffer供下次读取复用，失败时释放buffer
+     * @参数 [in] frameData 帧数据
+     * @返回值: 大于0 读取的数据大小；0 暂无解码帧；小于0 失败
+     */
+    int ReadDeviceFrame(ni_logan_session_data_io_t &frameData);
+
+    /**
+     * @功能描述: 异步模式下启动读取线程
+     */
+    void StartReader();
+
+    /**
+     * @功能描述: 异步模式下停止读取线程，并释放队列中尚未取走的解码帧
+     */
+    void StopReader();
+
+    /**
+     * @功能描述: 读取线程，从netint读取解码帧放入队列，队列满时暂停读取，读到结束标志或出错时退出
+     */
+    void ReaderLoop();
+
+    /**
+     * @功能描述: 异步模式下从队列取出一帧到m_frame
+     * @返回值: VIDEO_DECODER_SUCCESS 成功
+     *          VIDEO_DECODER_DECODE_FAIL 读取线程出错
+     *          VIDEO_DECODER_READ_UNDERFLOW 队列为空
+     *          VIDEO_DECODER_EOS 队列为空且已读到结束标志
+     */
+    DecoderRetCode PopQueuedFrame();
+
+    /**
+     * @功能描述: 等待解码帧，异步模式下由读取线程唤醒，同步模式下按轮询间隔等待
+     * @参数 [in] deadline 最晚等待到的时间点
+     * @参数 [in] infinite true 一直等待到有帧
+     */
+    void WaitForFrame(std::chrono::steady_clock::time_point deadline, bool infinite);
 
     /**
      * @功能描述: 将数据写入netint
@@ -91,6 +273,29 @@ private:
      */
     DecoderRetCode DecoderReadData(uint8_t *buffer, const uint32_t maxLen, uint32_t *filledLen);
 
+    /**
+     * @功能描述: 向netint读取解码后的一帧数据到m_frame
+     * @返回值: VIDEO_DECODER_SUCCESS 成功
+     *          VIDEO_DECODER_DECODE_FAIL 解码一帧失败
+     *          VIDEO_DECODER_READ_UNDERFLOW 暂无解码帧
+     *          VIDEO_DECODER_EOS 已无解码帧且收到结束标志
+     */
+    DecoderRetCode DecoderReadFrame();
+
+    /**
+     * @功能描述: 检查m_frame的分辨率是否与配置一致。显示尺寸变化时为分辨率变化，通知上层新的分辨率
+     *            并保留该帧，上层重新配置后交付；仅对齐填充变化时输出缓冲无需重新协商，直接交付
+     * @返回值: true  分辨率变化，帧等待重新配置
+     *          false 可以交付
+     */
+    bool CheckPicSizeChange();
+
+    /**
+     * @功能描述: 判断m_frame的显示尺寸（裁剪区域大小）是否与配置一致
+     * @返回值: true 一致；false 不一致
+     */
+    bool PicSizeMatches() const;
+
     /**
      * @功能描述: 处理从netint读取的解码后的数据，将数据传给上层
      * @参数 [in] buffer 输出数据缓存
@@ -101,6 +306,34 @@ private:
      */
     DecoderRetCode DecoderHandleData(uint8_t *buffer, const uint32_t maxLen, uint32_t *filledLen);
 
+    /**
+     * @功能描述: 获取m_frame的I420平面信息，用于内置格式转换
+     * @返回值: 源图像
+     */
+    FrameConverter::SourceFrame GetSourceFrame() const;
+
+    /**
+     * @功能描述: 按输出格式将m_frame转换到输出缓存，NV12/NV21/RGBA使用内置转换，其他格式使用CopyFrame钩子
+     * @参数 [in] buffer 输出数据缓存
+     * @参数 [in] maxLen 输出缓冲区最大长度(Byte)
+     * @返回值: 输出数据长度(Byte)，内置转换失败时返回0
+     */
+    uint32_t ConvertFrame(uint8_t *buffer, uint32_t maxLen);
+
+    /**
+     * @功能描述: 将m_frame的帧缓冲交给调用方持有，m_frame不再引用该缓冲
+     * @参数 [out] frame 解码帧视图
+     * @返回值: VIDEO_DECODER_SUCCESS 成功
+     *          VIDEO_DECODER_DECODE_FAIL 失败
+     *          VIDEO_DECODER_EOS 最后一帧
+     */
+    DecoderRetCode DecoderHandoutFrame(DecodedFrame &frame);
+
+    /**
+     * @功能描述: 关闭当前会话，仍有已交出的解码帧未归还时交由FrameOwner延迟关闭
+     */
+    void CloseCurrentSession();
+
     /**
      * @功能描述: 解码统计帧率
      */
@@ -120,6 +353,11 @@ private:
     * 	           NI_LOGAN_RETCODE_ERROR_INVALID_SESSION
     */
     int DeviceDecSessionWrite();
+
+    /**
+    * @功能描述：参数集变化时更新码流头信息并保存到会话上下文，与会话已保存的内容相同时不再调用save_hdrs
+    */
+    void SaveStreamHeaders();
     
     /**
     * @功能描述：扫描输入数据，找到下一个非VCL NAL单元（包含码流头信息）
@@ -140,21 +378,55 @@ private:
     int FindNalStartCode(std::pair<uint8_t*, uint32_t> &inBuf);
     
     ni_codec_t m_codec = EN_H264;
-    ni_logan_encoder_params_t m_decApiParams {};
-    ni_logan_session_context_t m_sessionCtx {};
-    ni_logan_device_context_t *m_devCtx = nullptr;
+    std::unique_ptr<NetintDecoderSession> m_session = nullptr;
+    std::shared_ptr<FrameOwner> m_frameOwner = nullptr;
+    std::string m_sessionKey = "";
+    bool m_sessionBroken = false;
+    // 最近一次保存的码流头信息，迁移到新会话后随下一包数据补发
+    std::vector<uint8_t> m_streamHeaders {};
+    std::vector<uint8_t> m_headerScratch {};    // 当前数据包中的参数集，容量复用
+    bool m_replayHeaders = false;
     ni_logan_session_data_io_t m_packet {};
+    // 常驻数据包缓冲，按NI_LOGAN_MEM_PAGE_ALIGNMENT对齐，容量只增不减
+    std::unique_ptr<uint8_t, void (*)(void *)> m_packetBuffer {nullptr, free};
+    uint32_t m_packetBufferSize = 0;
+    bool m_packetZeroCopy = false;  // 待发送的数据包直接引用调用方缓冲
     ni_logan_session_data_io_t m_frame {};
     uint32_t m_writeWidth = DEFAULT_WIDTH;
     uint32_t m_writeHeight = DEFAULT_HEIGHT;
     int32_t m_stride = DEFAULT_WIDTH;
+    MediaPixelFormat m_outputFormat = PIXEL_FORMAT_FLEX_YUV_420P;
     uint32_t m_planeWidth = 0;
     uint32_t m_planeHeight = 0;
+    uint32_t m_displayWidth = DEFAULT_WIDTH;    // 配置的显示尺寸，即裁剪区域大小
+    uint32_t m_displayHeight = DEFAULT_HEIGHT;
+    bool m_framePending = false;                // m_frame因分辨率变化等待重新配置后交付
+    bool m_picChangeNotified = false;           // 已为当前等待的帧通知分辨率变化
+    // 会话按首包参数集中的分辨率打开，未解析到时为配置的尺寸
+    uint32_t m_sessionWidth = DEFAULT_WIDTH;
+    uint32_t m_sessionHeight = DEFAULT_HEIGHT;
+    bool m_sessionOpenFailed = false;           // 首包打开会话失败，重新启动解码器前读写均返回START_FAIL
     int m_frameRate = DEFAULT_FRAMERATE;
     int m_bitDepth = DEFAULT_BITDEPTH;
-    unsigned long m_load = 0;
     uint32_t m_startOfStream = 0;
 
+    // 异步解码相关，m_deviceMutex保证读取线程与写入线程不同时调用netint会话接口
+    bool m_asyncMode = false;
+    uint32_t m_queueDepth = 0;
+    std::unique_ptr<SpscQueue<ni_logan_frame_t>> m_frameQueue = nullptr;
+    std::thread m_reader;
+    std::atomic<bool> m_readerRunning { false };
+    std::atomic<bool> m_readerEos { false };
+    std::atomic<bool> m_readerError { false };
+    std::mutex m_deviceMutex;
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCond;
+
+    // 帧缓冲池相关，m_poolWidth/m_poolHeight为当前会话已预留的分辨率
+    uint32_t m_framePoolDepth = 0;
+    uint32_t m_poolWidth = 0;
+    uint32_t m_poolHeight = 0;
+
     // 帧率统计相关
     int64_t m_lastTime = 0;
     uint32_t m_frameCount = 0;
@@ -5,7 +5,9 @@
 #ifndef VIDEO_DECODER_H
 #define VIDEO_DECODER_H
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 
 enum DecoderRetCode : uint32_t {
     VIDEO_DECODER_SUCCESS,                // 成功
@@ -49,8 +51,12 @@ enum MediaPixelFormat : uint32_t {
 
 // 解码事件
 enum DecodeEventIndex : uint32_t {
+    // 解码分辨率变化，data为新的PicInfoParams；首包SPS中的尺寸与配置不同时在解码前通知，
+    // 仅对齐填充变化时不通知
     INDEX_PIC_INFO_CHANGE,
-    INDEX_EVENT_NONE
+    INDEX_EVENT_NONE,
+    // 以下为新增事件，排在INDEX_EVENT_NONE之后，已有取值保持不变
+    INDEX_FRAME_AVAILABLE       // 异步模式下有新的解码帧入队，data1为队列中的帧数，在解码器内部线程中回调
 };
 
 // 解码参数
@@ -58,7 +64,10 @@ enum DecodeParamsIndex : uint32_t {
     INDEX_PIC_INFO,
     INDEX_PORT_FORMAT_INFO,
     INDEX_ALIGN_INFO,
-    INDEX_PARAM_NONE
+    INDEX_PARAM_NONE,
+    // 以下为新增参数，排在INDEX_PARAM_NONE之后，已有取值保持不变
+    INDEX_ASYNC_MODE_INFO,      // 仅在StartDecoder前设置
+    INDEX_FRAME_POOL_INFO       // 仅在StartDecoder前设置
 };
 
 struct AlignInfoParams {
@@ -73,6 +82,19 @@ struct PicInfoParams {
     uint32_t scanLines = 0;
     uint32_t cropWidth = 0;
     uint32_t cropHeight = 0;
+    uint32_t planeWidth = 0;    // 解码帧平面的实际宽高，仅对齐填充时可能与width/height不同，由解码器填写
+    uint32_t planeHeight = 0;
+};
+
+// 异步解码模式：解码器内部线程从设备读取解码帧放入队列，RetrieveFrameData/AcquireFrame从队列取帧
+struct AsyncModeParams {
+    bool enable = false;
+    uint32_t queueDepth = 0;    // 解码帧队列深度，0时使用默认深度
+};
+
+// 解码帧缓冲池：打开会话时按码流分辨率预先申请并预触发缺页，读取解码帧时不再临时申请
+struct FramePoolParams {
+    uint32_t depth = 0;         // 预留的解码帧缓冲数，0时使用默认深度（异步模式下另加队列深度）
 };
 
 struct PortFormatParams {
@@ -80,6 +102,24 @@ struct PortFormatParams {
     int32_t format = 0;
 };
 
+// 解码帧视图，平面数据直接引用解码器内部缓冲，不做拷贝；buffer为帧缓冲的引用计数，
+// 视图可拷贝，最后一个引用释放后缓冲归还解码器
+struct DecodedFrame {
+    static constexpr uint32_t PLANE_NUM = 3;
+
+    uint8_t *planes[PLANE_NUM] = {nullptr, nullptr, nullptr};  // Y、U、V平面地址
+    int32_t strides[PLANE_NUM] = {0, 0, 0};                     // 各平面跨距(Byte)
+    uint32_t width = 0;                                         // 亮度平面宽度(像素)
+    uint32_t height = 0;                                        // 亮度平面高度(行)
+    uint32_t cropLeft = 0;
+    uint32_t cropTop = 0;
+    uint32_t cropWidth = 0;
+    uint32_t cropHeight = 0;
+    uint32_t bitDepth = 8;                                      // 大于8时每个采样占2字节，小端
+    MediaPixelFormat format = PIXEL_FORMAT_YUV_420P;
+    std::shared_ptr<void> buffer = nullptr;
+};
+
 class VideoDecoder {
 public:
     VideoDecoder() = default;
@@ -134,7 +174,7 @@ public:
      * @参数 [in] copyFrame,对应参数意义如下:
      *              _1: 解码完成数据地址 src
      *              _2: OMX组件提供的输出buffer地址 dst
-     *              _3: 输出帧分辨率信息
+     *              _3: 输出帧分辨率信息,width/height等为配置的分辨率,planeWidth/planeHeight为解码帧平面的实际尺寸
      *              _4: 输出缓冲区的最大长度
      *              返回值: 成功拷贝数据的长度(Byte)
      * @返回值: VIDEO_DECODER_SUCCESS 成功
@@ -150,6 +190,7 @@ public:
      * @返回值: VIDEO_DECODER_SUCCESS 成功
      *          VIDEO_DECODER_DECODE_FAIL 发送失败
      *          VIDEO_DECODER_WRITE_OVERFLOW 输入buffer速度太快
+     *          VIDEO_DECODER_START_FAIL 首包打开设备会话失败，见StartDecoder
      */
     virtual DecoderRetCode SendStreamData(uint8_t *buffer, uint32_t filledLen) = 0;
 
@@ -161,6 +202,9 @@ public:
      * @返回值: VIDEO_DECODER_SUCCESS 成功
      *          VIDEO_DECODER_DECODE_FAIL 解码一帧失败
      *          VIDEO_DECODER_READ_UNDERFLOW 请求输出速度太快
+     *          VIDEO_DECODER_BAD_PIC_SIZE 解码分辨率变化，该帧由解码器保留，SetDecodeParams(INDEX_PIC_INFO)
+     *                                     重新配置后再次获取时交付
+     *          VIDEO_DECODER_START_FAIL 首包打开设备会话失败，见StartDecoder
      */
     virtual DecoderRetCode RetrieveFrameData(uint8_t *buffer, uint32_t maxLen, uint32_t *filledLen) = 0;
 
@@ -172,9 +216,13 @@ public:
     virtual DecoderRetCode Flush() = 0;
 
     /**
-     * @功能描述: 启动解码器,成功后可以开始解码流程
+     * @功能描述: 启动解码器,成功后可以开始解码流程。启动时加载设备库并确认有可用的设备,设备会话在首包数据
+     *            到达时按其中参数集的分辨率、位深与帧率打开,首包中没有参数集时按配置的分辨率打开。
+     *            码流尺寸与配置不同时在解码前回调INDEX_PIC_INFO_CHANGE。会话打开失败(设备资源不足、
+     *            输出格式不支持码流位深等)时SendStreamData返回VIDEO_DECODER_START_FAIL,此后的读写均返回该错误,
+     *            需StopDecoder后重新启动
      * @返回值: VIDEO_DECODER_SUCCESS 成功
-     *          VIDEO_DECODER_START_FAIL 启动解码器失败
+     *          VIDEO_DECODER_START_FAIL 启动解码器失败,设备库加载失败或没有可用的设备
      */
     virtual DecoderRetCode StartDecoder() = 0;
 
@@ -189,6 +237,40 @@ public:
      * @功能描述: 销毁解码器,通知解码器释放资源
      */
     virtual void DestroyDecoder() = 0;
+
+    // 以下为新增接口，追加在末尾，已有接口的虚函数表位置保持不变
+    /**
+     * @功能描述: 同步接口,获取一帧解码输出,不经过CopyFrame拷贝,直接返回解码器内部缓冲的视图,
+     *            使用完毕后调用ReleaseFrame归还
+     * @参数 [out] frame 解码帧视图
+     * @返回值: VIDEO_DECODER_SUCCESS 成功
+     *          VIDEO_DECODER_DECODE_FAIL 解码一帧失败
+     *          VIDEO_DECODER_READ_UNDERFLOW 请求输出速度太快
+     *          VIDEO_DECODER_BAD_PIC_SIZE 解码分辨率变化，同RetrieveFrameData
+     *          VIDEO_DECODER_START_FAIL 首包打开设备会话失败，见StartDecoder
+     *          VIDEO_DECODER_EOS 最后一帧，frame有效时仍需归还
+     */
+    virtual DecoderRetCode AcquireFrame(DecodedFrame *frame) = 0;
+
+    /**
+     * @功能描述: 归还AcquireFrame获取的解码帧并清空视图,该帧的所有视图拷贝均释放后缓冲归还解码器,
+     *            可在解码器停止或销毁后由视图析构归还
+     * @参数 [in] frame 解码帧视图
+     * @返回值: VIDEO_DECODER_SUCCESS 成功
+     *          VIDEO_DECODER_DECODE_FAIL 参数错误
+     */
+    virtual DecoderRetCode ReleaseFrame(DecodedFrame *frame) = 0;
+
+    /**
+     * @功能描述: 同步接口,获取一帧解码输出,暂无解码帧时最多等待timeoutMs,异步模式下由解码帧入队唤醒
+     * @参数 [in] buffer 输出码流数据缓存
+     * @参数 [in] maxLen 输出缓冲区最大长度(Byte)
+     * @参数 [out] filledLen 输出码流数据长度(Byte)
+     * @参数 [in] timeoutMs 最长等待时间(ms), 0不等待, 小于0一直等待
+     * @返回值: 同RetrieveFrameData, 超时返回VIDEO_DECODER_READ_UNDERFLOW
+     */
+    virtual DecoderRetCode RetrieveFrameData(uint8_t *buffer, uint32_t maxLen, uint32_t *filledLen,
+        int32_t timeoutMs) = 0;
 };
 
 extern "C" {